@@ -0,0 +1,898 @@
+//
+// Benchmark program for the man page to HTML conversion library.
+//
+// Copyright © 2022-2023 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.
+// <https://opensource.org/licenses/Apache-2.0>
+//
+// Usage:
+//
+//    ./benchmantohtml [OPTIONS] [DIRECTORY-OR-MAN-FILE ...]
+//
+// Options:
+//
+//    --baseline FILE          Fail if the fastest MB/s is slower than in FILE
+//    --compact                Write compact HTML
+//    --help                   Show help
+//    --iterations N           Convert each page N times (default 5)
+//    --lines N                Use N lines for the synthetic pages (default 100000)
+//    --no-synthetic           Only convert the named directories and files
+//    --save-baseline FILE     Save the fastest MB/s of each test to FILE
+//    --threads N              Convert the sections of large pages using N threads
+//    --tolerance PCT          Allow PCT percent less than the baseline (default 10)
+//    --verbose                Show conversion warnings and errors
+//
+
+#include "mantohtml.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+
+//
+// Local types...
+//
+
+typedef enum bench_page_e		// Synthetic page types
+{
+  BENCH_PAGE_PLAIN,			// Plain text
+  BENCH_PAGE_ESCAPES,			// Font and special character escapes
+  BENCH_PAGE_URLS,			// Embedded URLs and links
+  BENCH_PAGE_TABLES,			// Tagged and indented paragraphs
+  BENCH_PAGE_HEADINGS,			// Subsection headings, as in generated API pages
+  BENCH_PAGE_MAX
+} bench_page_t;
+
+typedef struct bench_baseline_s		// Baseline throughput
+{
+  char		name[32];		// Name of test
+  double	mbps;			// Expected MB/s
+} bench_baseline_t;
+
+typedef struct bench_s			// Benchmark results
+{
+  const char	*name;			// Name of benchmark
+  size_t	pages,			// Number of pages converted
+		failed,			// Number of pages that failed
+		bytes,			// Number of source bytes converted
+		outbytes,		// Number of HTML bytes written
+		compactbytes;		// Number of compact HTML bytes written
+  double	elapsed;		// Total conversion time in seconds
+  size_t	num_times,		// Number of page times
+		alloc_times;		// Allocated page times
+  double	*times,			// Page times in seconds
+		*ttfbs;			// Page times to first byte in seconds
+} bench_t;
+
+typedef struct bench_output_s		// Benchmark output
+{
+  double	first;			// Time of first output block
+  size_t	bytes;			// Number of bytes written
+} bench_output_t;
+
+
+//
+// Local functions...
+//
+
+static void	bench_add(bench_t *bench, size_t bytes, bool success, double secs, double ttfb);
+static bool	bench_check(const bench_baseline_t *baselines, size_t num_baselines, FILE *savefp, const char *name, size_t bytes, double best, double tolerance);
+static bool	bench_load(const char *filename, bench_baseline_t *baselines, size_t max_baselines, size_t *num_baselines);
+static void	bench_report(bench_t *bench);
+static void	bench_sizes(bench_t *bench, const char *filename, const char *src, size_t srclen, const mantohtml_options_t *options, mantohtml_sink_t *sink, bench_output_t *output);
+static bool	bench_write(bench_output_t *output, const char *data, size_t len);
+static int	compare_times(const double *a, const double *b);
+static double	get_time(void);
+static char	*make_page(bench_page_t type, int lines, size_t *len);
+static bool	scan_corpus(const char *path, char ***files, size_t *num_files, size_t *alloc_files);
+static int	usage(const char *opt);
+
+
+//
+// Local globals...
+//
+
+static const char * const bench_names[] =
+{					// Synthetic page names
+  "plain",
+  "escapes",
+  "urls",
+  "tables",
+  "headings"
+};
+
+
+//
+// 'main()' - Benchmark the man page to HTML conversion library.
+//
+
+int					// O - Exit status
+main(int  argc,				// I - Number of command-line args
+     char *argv[])			// I - Command-line arguments
+{
+  int		i,			// Looping var
+		iter,			// Current iteration
+		iterations = 5,		// Number of iterations
+		lines = 100000;		// Lines in synthetic pages
+  bool		synthetic = true,	// Run synthetic benchmarks?
+		verbose = false,	// Show conversion messages?
+		passed = true;		// Within the baseline?
+  double	best,			// Time of fastest iteration
+		tolerance = 10.0;	// Allowed percentage below baseline
+  bench_baseline_t baselines[BENCH_PAGE_MAX + 1];
+					// Baseline throughputs
+  size_t	num_baselines = 0;	// Number of baseline throughputs
+  FILE		*savefp = NULL;		// Baseline file to save
+  char		**files = NULL;		// Corpus files
+  size_t	f,			// Current corpus file
+		num_files = 0,		// Number of corpus files
+		alloc_files = 0;	// Allocated corpus files
+  mantohtml_options_t options;		// Conversion options
+  mantohtml_sink_t *sink;		// Output sink
+  bench_output_t output;		// Output information
+  bench_page_t	type;			// Synthetic page type
+  struct rusage	usage_info;		// Resource usage
+  long		maxrss;			// Peak RSS in kilobytes
+
+
+  // Parse command-line...
+  memset(&options, 0, sizeof(options));
+
+  for (i = 1; i < argc; i ++)
+  {
+    if (!strcmp(argv[i], "--baseline"))
+    {
+      // --baseline FILE
+      i ++;
+      if (i >= argc)
+      {
+        fputs("benchmantohtml: Missing filename after --baseline.\n", stderr);
+        return (1);
+      }
+
+      if (!bench_load(argv[i], baselines, sizeof(baselines) / sizeof(baselines[0]), &num_baselines))
+        return (1);
+    }
+    else if (!strcmp(argv[i], "--compact"))
+    {
+      // --compact
+      options.compact = true;
+    }
+    else if (!strcmp(argv[i], "--help"))
+    {
+      // --help
+      return (usage(NULL));
+    }
+    else if (!strcmp(argv[i], "--iterations"))
+    {
+      // --iterations N
+      i ++;
+      if (i >= argc || (iterations = atoi(argv[i])) < 1)
+      {
+        fputs("benchmantohtml: Missing number of iterations after --iterations.\n", stderr);
+        return (1);
+      }
+    }
+    else if (!strcmp(argv[i], "--lines"))
+    {
+      // --lines N
+      i ++;
+      if (i >= argc || (lines = atoi(argv[i])) < 1)
+      {
+        fputs("benchmantohtml: Missing number of lines after --lines.\n", stderr);
+        return (1);
+      }
+    }
+    else if (!strcmp(argv[i], "--no-synthetic"))
+    {
+      // --no-synthetic
+      synthetic = false;
+    }
+    else if (!strcmp(argv[i], "--save-baseline"))
+    {
+      // --save-baseline FILE
+      i ++;
+      if (i >= argc)
+      {
+        fputs("benchmantohtml: Missing filename after --save-baseline.\n", stderr);
+        return (1);
+      }
+
+      if (savefp)
+        fclose(savefp);
+
+      if ((savefp = fopen(argv[i], "w")) == NULL)
+      {
+        perror(argv[i]);
+        return (1);
+      }
+
+      fputs("# Baseline MB/s for benchmantohtml --baseline\n", savefp);
+    }
+    else if (!strcmp(argv[i], "--threads"))
+    {
+      // --threads N
+      i ++;
+      if (i >= argc || (options.threads = atoi(argv[i])) < 1)
+      {
+        fputs("benchmantohtml: Missing number of threads after --threads.\n", stderr);
+        return (1);
+      }
+    }
+    else if (!strcmp(argv[i], "--tolerance"))
+    {
+      // --tolerance PERCENT
+      i ++;
+      if (i >= argc || (tolerance = atof(argv[i])) < 0.0 || tolerance >= 100.0)
+      {
+        fputs("benchmantohtml: Missing or bad percentage after --tolerance.\n", stderr);
+        return (1);
+      }
+    }
+    else if (!strcmp(argv[i], "--verbose"))
+    {
+      // --verbose
+      verbose = true;
+    }
+    else if (argv[i][0] == '-')
+    {
+      // Unknown option
+      return (usage(argv[i]));
+    }
+    else if (!scan_corpus(argv[i], &files, &num_files, &alloc_files))
+    {
+      // Unable to add directory or file
+      return (1);
+    }
+  }
+
+  if (!synthetic && num_files == 0)
+  {
+    fputs("benchmantohtml: No man pages to convert.\n", stderr);
+    return (1);
+  }
+
+  // Output is discarded as it is written, recording when the first block
+  // arrives for the time-to-first-byte...
+  if ((sink = mantohtml_sink_new_cb((mantohtml_sink_cb_t)bench_write, &output)) == NULL)
+  {
+    perror("benchmantohtml");
+    return (1);
+  }
+
+  // Conversion warnings are normally not interesting here...
+  if (!verbose)
+  {
+    int	fd;				// /dev/null
+
+    if ((fd = open("/dev/null", O_WRONLY)) >= 0)
+    {
+      dup2(fd, 2);
+      close(fd);
+    }
+  }
+
+  printf("%-10s %7s %9s %9s %9s %9s %9s %9s %9s %9s %9s\n", "Test", "Pages", "MBytes", "Seconds", "MB/s", "Pages/s", "p50 ms", "p99 ms", "TTFB ms", "Out MB", "Compact");
+
+  // Synthetic pages are converted from memory...
+  for (type = BENCH_PAGE_PLAIN; synthetic && type < BENCH_PAGE_MAX; type ++)
+  {
+    char	*src;			// Page source
+    size_t	srclen;			// Length of page source
+    bench_t	bench;			// Results
+
+    if ((src = make_page(type, lines, &srclen)) == NULL)
+    {
+      perror("benchmantohtml");
+      return (1);
+    }
+
+    memset(&bench, 0, sizeof(bench));
+    bench.name = bench_names[type];
+
+    for (iter = 0, best = 0.0; iter < iterations; iter ++)
+    {
+      double	start,			// Start time
+		secs;			// Conversion time
+      bool	success;		// Conversion successful?
+
+      output.first = 0.0;
+      start        = get_time();
+      success      = mantohtml_convert_buffer(src, srclen, &options, sink);
+      secs         = get_time() - start;
+
+      bench_add(&bench, srclen, success, secs, output.first - start);
+
+      if (iter == 0 || secs < best)
+        best = secs;
+    }
+
+    bench_sizes(&bench, NULL, src, srclen, &options, sink, &output);
+
+    bench_report(&bench);
+
+    if (!bench_check(baselines, num_baselines, savefp, bench_names[type], srclen, best, tolerance))
+      passed = false;
+
+    free(src);
+  }
+
+  // Corpus pages are converted from their files...
+  if (num_files > 0)
+  {
+    bench_t	bench;			// Results
+
+    size_t	iterbytes = 0;		// Bytes converted in each iteration
+
+    memset(&bench, 0, sizeof(bench));
+    bench.name = "corpus";
+
+    for (iter = 0, best = 0.0; iter < iterations; iter ++)
+    {
+      double	itersecs = 0.0;		// Time of this iteration
+
+      for (f = 0, iterbytes = 0; f < num_files; f ++)
+      {
+        struct stat	fileinfo;	// File information
+        double		start,		// Start time
+			secs;		// Conversion time
+        bool		success;	// Conversion successful?
+
+        if (stat(files[f], &fileinfo))
+          continue;
+
+        output.first = 0.0;
+        start        = get_time();
+        success      = mantohtml_convert_file(files[f], &options, sink);
+        secs         = get_time() - start;
+
+        bench_add(&bench, (size_t)fileinfo.st_size, success, secs, output.first - start);
+
+        itersecs  += secs;
+        iterbytes += (size_t)fileinfo.st_size;
+      }
+
+      if (iter == 0 || itersecs < best)
+        best = itersecs;
+    }
+
+    for (f = 0; f < num_files; f ++)
+      bench_sizes(&bench, files[f], NULL, 0, &options, sink, &output);
+
+    bench_report(&bench);
+
+    if (!bench_check(baselines, num_baselines, savefp, "corpus", iterbytes, best, tolerance))
+      passed = false;
+
+    for (f = 0; f < num_files; f ++)
+      free(files[f]);
+    free(files);
+  }
+
+  mantohtml_sink_delete(sink);
+
+  // Report the peak memory usage...
+  getrusage(RUSAGE_SELF, &usage_info);
+  maxrss = (long)usage_info.ru_maxrss;
+#ifdef __APPLE__
+  maxrss /= 1024;			// macOS reports bytes
+#endif // __APPLE__
+
+  printf("Peak RSS: %ld KiB\n", maxrss);
+
+  if (savefp)
+    fclose(savefp);
+
+  return (passed ? 0 : 1);
+}
+
+
+//
+// 'bench_add()' - Add a page time to the benchmark results.
+//
+
+static void
+bench_add(bench_t *bench,		// I - Benchmark results
+          size_t  bytes,		// I - Source bytes
+          bool    success,		// I - Was the conversion successful?
+          double  secs,			// I - Conversion time in seconds
+          double  ttfb)			// I - Time to first byte in seconds
+{
+  if (bench->num_times >= bench->alloc_times)
+  {
+    size_t	alloc_times = bench->alloc_times ? 2 * bench->alloc_times : 1024;
+					// New number of page times
+    double	*times,			// New page times
+		*ttfbs;			// New times to first byte
+
+    if ((times = realloc(bench->times, alloc_times * sizeof(double))) == NULL)
+    {
+      perror("benchmantohtml");
+      exit(1);
+    }
+
+    bench->times = times;
+
+    if ((ttfbs = realloc(bench->ttfbs, alloc_times * sizeof(double))) == NULL)
+    {
+      perror("benchmantohtml");
+      exit(1);
+    }
+
+    bench->ttfbs       = ttfbs;
+    bench->alloc_times = alloc_times;
+  }
+
+  // Pages that fail without any output count the whole time...
+  bench->ttfbs[bench->num_times]    = ttfb > 0.0 ? ttfb : secs;
+  bench->times[bench->num_times ++] = secs;
+  bench->pages ++;
+  bench->bytes   += bytes;
+  bench->elapsed += secs;
+
+  if (!success)
+    bench->failed ++;
+}
+
+
+//
+// 'bench_check()' - Check the throughput of a test against its baseline.
+//
+// The throughput is that of the fastest iteration, which is much less
+// sensitive to other activity on the machine than the average.  The
+// throughput is also saved to the baseline file, if any.  Tests without a
+// baseline always pass.
+//
+
+static bool				// O - `true` if within tolerance, `false` if too slow
+bench_check(
+    const bench_baseline_t *baselines,	// I - Baseline throughputs
+    size_t                 num_baselines,
+					// I - Number of baseline throughputs
+    FILE                   *savefp,	// I - Baseline file to save or `NULL`
+    const char             *name,	// I - Name of test
+    size_t                 bytes,	// I - Source bytes in each iteration
+    double                 best,	// I - Time of fastest iteration
+    double                 tolerance)	// I - Allowed percentage below baseline
+{
+  size_t	i;			// Looping var
+  double	mbps = (double)bytes / 1048576.0 / (best > 0.0 ? best : 1e-9);
+					// Throughput in MB/s
+
+
+  if (savefp)
+    fprintf(savefp, "%s %.1f\n", name, mbps);
+
+  for (i = 0; i < num_baselines; i ++)
+  {
+    if (!strcmp(baselines[i].name, name))
+    {
+      if (mbps >= baselines[i].mbps * (100.0 - tolerance) / 100.0)
+        return (true);
+
+      // Conversion messages may be hidden, so report on the standard output...
+      printf("%s: %.1f MB/s is more than %g%% below the baseline of %.1f MB/s\n", name, mbps, tolerance, baselines[i].mbps);
+      return (false);
+    }
+  }
+
+  return (true);
+}
+
+
+//
+// 'bench_load()' - Load a baseline file.
+//
+// Each line contains the name of a test and its MB/s, e.g. "plain 400.0".
+// Blank lines and lines starting with "#" are ignored.
+//
+
+static bool				// O - `true` on success, `false` on error
+bench_load(
+    const char       *filename,		// I - Baseline file
+    bench_baseline_t *baselines,	// I - Baseline throughputs
+    size_t           max_baselines,	// I - Maximum number of baseline throughputs
+    size_t           *num_baselines)	// O - Number of baseline throughputs
+{
+  FILE		*fp;			// Baseline file
+  char		line[256];		// Line from file
+  int		linenum = 0;		// Line number
+  bench_baseline_t *baseline;		// Current baseline
+
+
+  if ((fp = fopen(filename, "r")) == NULL)
+  {
+    perror(filename);
+    return (false);
+  }
+
+  *num_baselines = 0;
+
+  while (fgets(line, sizeof(line), fp))
+  {
+    linenum ++;
+
+    if (line[0] == '#' || line[0] == '\n')
+      continue;
+
+    if (*num_baselines >= max_baselines)
+    {
+      fprintf(stderr, "benchmantohtml: Too many baselines in '%s'.\n", filename);
+      break;
+    }
+
+    baseline = baselines + *num_baselines;
+
+    if (sscanf(line, "%31s%lf", baseline->name, &baseline->mbps) != 2 || baseline->mbps <= 0.0)
+    {
+      fprintf(stderr, "benchmantohtml: Bad baseline on line %d of '%s'.\n", linenum, filename);
+      fclose(fp);
+      return (false);
+    }
+
+    (*num_baselines) ++;
+  }
+
+  fclose(fp);
+
+  return (true);
+}
+
+
+//
+// 'bench_report()' - Show and free the benchmark results.
+//
+
+static void
+bench_report(bench_t *bench)		// I - Benchmark results
+{
+  double	mbytes = (double)bench->bytes / 1048576.0,
+					// Source megabytes
+		elapsed = bench->elapsed > 0.0 ? bench->elapsed : 1e-9,
+					// Elapsed time
+		p50 = 0.0,		// Median page time
+		p99 = 0.0,		// 99th percentile page time
+		ttfb = 0.0;		// Median time to first byte
+
+
+  if (bench->num_times > 0)
+  {
+    qsort(bench->times, bench->num_times, sizeof(double), (int (*)(const void *, const void *))compare_times);
+
+    p50 = bench->times[(bench->num_times - 1) * 50 / 100];
+    p99 = bench->times[(bench->num_times - 1) * 99 / 100];
+
+    qsort(bench->ttfbs, bench->num_times, sizeof(double), (int (*)(const void *, const void *))compare_times);
+
+    ttfb = bench->ttfbs[(bench->num_times - 1) * 50 / 100];
+  }
+
+  printf("%-10s %7lu %9.2f %9.3f %9.1f %9.1f %9.3f %9.3f %9.3f %9.2f %8.1f%%", bench->name, (unsigned long)bench->pages, mbytes, bench->elapsed, mbytes / elapsed, (double)bench->pages / elapsed, 1000.0 * p50, 1000.0 * p99, 1000.0 * ttfb, (double)bench->outbytes / 1048576.0, bench->outbytes ? 100.0 * (double)bench->compactbytes / (double)bench->outbytes : 0.0);
+
+  if (bench->failed)
+    printf(" (%lu failed)", (unsigned long)bench->failed);
+
+  putchar('\n');
+
+  free(bench->times);
+  free(bench->ttfbs);
+}
+
+
+//
+// 'bench_sizes()' - Add the default and compact HTML sizes of a page.
+//
+// The sizes are measured outside of the timed conversions so that the
+// "Compact" column shows the compact HTML size as a percentage of the default
+// HTML size regardless of the `--compact` option.
+//
+
+static void
+bench_sizes(
+    bench_t                   *bench,	// I - Benchmark results
+    const char                *filename,// I - Man file or `NULL` for buffer
+    const char                *src,	// I - Page source
+    size_t                    srclen,	// I - Length of page source
+    const mantohtml_options_t *options,	// I - Conversion options
+    mantohtml_sink_t          *sink,	// I - Output sink
+    bench_output_t            *output)	// I - Output information
+{
+  mantohtml_options_t	sizeoptions = *options;
+					// Conversion options for the sizes
+
+
+  sizeoptions.compact = false;
+  output->bytes       = 0;
+
+  if (filename)
+    mantohtml_convert_file(filename, &sizeoptions, sink);
+  else
+    mantohtml_convert_buffer(src, srclen, &sizeoptions, sink);
+
+  bench->outbytes += output->bytes;
+
+  sizeoptions.compact = true;
+  output->bytes       = 0;
+
+  if (filename)
+    mantohtml_convert_file(filename, &sizeoptions, sink);
+  else
+    mantohtml_convert_buffer(src, srclen, &sizeoptions, sink);
+
+  bench->compactbytes += output->bytes;
+}
+
+
+//
+// 'bench_write()' - Discard output, recording when the first block arrives.
+//
+
+static bool				// O - `true` to continue
+bench_write(bench_output_t *output,	// I - Output information
+            const char     *data,	// I - Output data
+            size_t         len)		// I - Length of output data
+{
+  (void)data;
+
+  if (output->first == 0.0)
+    output->first = get_time();
+
+  output->bytes += len;
+
+  return (true);
+}
+
+
+//
+// 'compare_times()' - Compare two page times.
+//
+
+static int				// O - Result of comparison
+compare_times(const double *a,		// I - First time
+              const double *b)		// I - Second time
+{
+  if (*a < *b)
+    return (-1);
+  else if (*a > *b)
+    return (1);
+  else
+    return (0);
+}
+
+
+//
+// 'get_time()' - Get the current time in seconds.
+//
+
+static double				// O - Time in seconds
+get_time(void)
+{
+  struct timespec	ts;		// Current time
+
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ((double)ts.tv_sec + 0.000000001 * (double)ts.tv_nsec);
+}
+
+
+//
+// 'make_page()' - Make a synthetic man page.
+//
+
+static char *				// O - Page source or `NULL` on error
+make_page(bench_page_t type,		// I - Type of page
+          int          lines,		// I - Number of lines
+          size_t       *len)		// O - Length of page source
+{
+  mantohtml_sink_t *sink;		// Page source
+  int		line;			// Current line
+  const char	*data;			// Page data
+  char		*src = NULL;		// Copy of page data
+
+
+  if ((sink = mantohtml_sink_new_memory()) == NULL)
+    return (NULL);
+
+  mantohtml_sink_printf(sink, ".TH %s 1 \"2023-01-01\" \"benchmantohtml\"\n", bench_names[type]);
+
+  for (line = 0; line < lines; line ++)
+  {
+    if ((line % 1000) == 0)
+    {
+      mantohtml_sink_printf(sink, ".SH \"SECTION %d\"\n", line / 1000);
+      continue;
+    }
+    else if ((line % 100) == 0)
+    {
+      mantohtml_sink_printf(sink, ".SS \"Subsection %d\"\n", line / 100);
+      continue;
+    }
+
+    switch (type)
+    {
+      default :
+          if ((line % 10) == 0)
+            mantohtml_sink_puts(sink, ".PP\n");
+          else
+            mantohtml_sink_printf(sink, "Line %d of plain text that just needs to be copied to the output without any changes.\n", line);
+          break;
+
+      case BENCH_PAGE_ESCAPES :
+          if ((line % 10) == 0)
+            mantohtml_sink_puts(sink, ".PP\n");
+          else
+            mantohtml_sink_printf(sink, "Line %d has \\fBbold\\fR and \\fIitalic\\fP text\\(em\\*(lqquoted\\*(rq \\[co] \\(<= \\-option \\e & <tags>.\n", line);
+          break;
+
+      case BENCH_PAGE_URLS :
+          if ((line % 10) == 0)
+            mantohtml_sink_printf(sink, ".UR https://www.example.org/link/%d\n", line);
+          else if ((line % 10) == 2)
+            mantohtml_sink_puts(sink, ".UE\n");
+          else
+            mantohtml_sink_printf(sink, "See https://www.example.com/path/%d/index.html, or http://www.example.net/%d for details.\n", line, line);
+          break;
+
+      case BENCH_PAGE_TABLES :
+          switch (line % 6)
+          {
+            case 0 :
+                mantohtml_sink_puts(sink, ".TP 5\n");
+                break;
+            case 1 :
+                mantohtml_sink_printf(sink, ".BR \\-\\-option%d \" VALUE\"\n", line);
+                break;
+            case 2 :
+                mantohtml_sink_printf(sink, "Description of option %d.\n", line);
+                break;
+            case 3 :
+                mantohtml_sink_puts(sink, ".IP \\(bu 3\n");
+                break;
+            case 4 :
+                mantohtml_sink_printf(sink, "Item %d in a bulleted list.\n", line);
+                break;
+            default :
+                mantohtml_sink_printf(sink, ".IP \"%d.\" 5\n", line);
+                break;
+          }
+          break;
+
+      case BENCH_PAGE_HEADINGS :
+          switch (line % 3)
+          {
+            case 0 :
+                mantohtml_sink_printf(sink, ".SS \"get the name and value of a %d-byte attribute\"\n", line);
+                break;
+            case 1 :
+                mantohtml_sink_printf(sink, ".SS \"bench_function_%d(3) \\- Set the value\"\n", line);
+                break;
+            default :
+                mantohtml_sink_printf(sink, "Description of function %d.\n", line);
+                break;
+          }
+          break;
+    }
+  }
+
+  if ((data = mantohtml_sink_get_buffer(sink, len)) != NULL)
+    src = strdup(data);
+
+  mantohtml_sink_delete(sink);
+
+  return (src);
+}
+
+
+//
+// 'scan_corpus()' - Add a man page directory or file to the corpus.
+//
+
+static bool				// O - `true` on success, `false` on error
+scan_corpus(const char *path,		// I - Directory or filename
+            char       ***files,	// IO - Corpus files
+            size_t     *num_files,	// IO - Number of corpus files
+            size_t     *alloc_files)	// IO - Allocated corpus files
+{
+  struct stat	fileinfo;		// File information
+
+
+  if (stat(path, &fileinfo))
+  {
+    perror(path);
+    return (false);
+  }
+
+  if (S_ISDIR(fileinfo.st_mode))
+  {
+    // Add the files in the directory...
+    DIR			*dir;		// Directory
+    struct dirent	*dent;		// Directory entry
+    char		filename[1024];	// Filename
+
+    if ((dir = opendir(path)) == NULL)
+    {
+      perror(path);
+      return (false);
+    }
+
+    while ((dent = readdir(dir)) != NULL)
+    {
+      if (dent->d_name[0] == '.')
+        continue;
+
+      snprintf(filename, sizeof(filename), "%s/%s", path, dent->d_name);
+
+      if (!scan_corpus(filename, files, num_files, alloc_files))
+      {
+        closedir(dir);
+        return (false);
+      }
+    }
+
+    closedir(dir);
+  }
+  else if (S_ISREG(fileinfo.st_mode))
+  {
+    // Add the file...
+    if (*num_files >= *alloc_files)
+    {
+      size_t	alloc = *alloc_files ? 2 * *alloc_files : 256;
+					// New number of files
+      char	**temp;			// New files
+
+      if ((temp = realloc(*files, alloc * sizeof(char *))) == NULL)
+      {
+        perror("benchmantohtml");
+        return (false);
+      }
+
+      *files       = temp;
+      *alloc_files = alloc;
+    }
+
+    if (((*files)[*num_files] = strdup(path)) == NULL)
+    {
+      perror("benchmantohtml");
+      return (false);
+    }
+
+    (*num_files) ++;
+  }
+
+  return (true);
+}
+
+
+//
+// 'usage()' - Show program usage.
+//
+
+static int				// O - Exit status
+usage(const char *opt)			// I - Unknown option
+{
+  if (opt)
+    fprintf(stderr, "benchmantohtml: Unknown option '%s'.\n", opt);
+
+  puts("Usage: ./benchmantohtml [OPTIONS] [DIRECTORY-OR-MAN-FILE ...]");
+  puts("Options:");
+  puts("   --baseline FILE          Fail if the fastest MB/s is slower than in FILE");
+  puts("   --compact                Write compact HTML");
+  puts("   --help                   Show help");
+  puts("   --iterations N           Convert each page N times (default 5)");
+  puts("   --lines N                Use N lines for the synthetic pages (default 100000)");
+  puts("   --no-synthetic           Only convert the named directories and files");
+  puts("   --save-baseline FILE     Save the fastest MB/s of each test to FILE");
+  puts("   --threads N              Convert the sections of large pages using N threads");
+  puts("   --tolerance PCT          Allow PCT percent less than the baseline (default 10)");
+  puts("   --verbose                Show conversion warnings and errors");
+
+  return (1);
+}
@@ -0,0 +1,234 @@
+//
+// Fuzzing program for the man page to HTML conversion library.
+//
+// Copyright © 2022-2023 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.
+// <https://opensource.org/licenses/Apache-2.0>
+//
+// Usage:
+//
+//    ./fuzzmantohtml [FILE ...]
+//
+// Each file (or the standard input) is converted once.  When built with
+// "-DMANTOHTML_LIBFUZZER" and "-fsanitize=fuzzer" (`make fuzz`), libFuzzer
+// provides the main program instead.  AFL can use the standalone program,
+// e.g.:
+//
+//    make CC=afl-clang-fast fuzzmantohtml
+//    afl-fuzz -i FUZZ-INPUTS -o FUZZ-OUTPUTS ./fuzzmantohtml
+//
+// The first byte of the input selects the conversion options and how the man
+// page is read, and the rest of the input is the man page source.  Set the
+// "FUZZ_QUIET" environment variable to discard conversion messages.
+//
+
+#include "mantohtml.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+//
+// Local functions...
+//
+
+int		LLVMFuzzerTestOneInput(const unsigned char *data, size_t len);
+static void	fuzz_init(void);
+
+
+//
+// Local globals...
+//
+
+static mantohtml_sink_t	*fuzz_sink = NULL;
+					// Output sink
+
+
+#ifndef MANTOHTML_LIBFUZZER
+//
+// 'main()' - Convert each file or the standard input once.
+//
+
+int					// O - Exit status
+main(int  argc,				// I - Number of command-line args
+     char *argv[])			// I - Command-line arguments
+{
+  int		i;			// Looping var
+  FILE		*fp;			// Input file
+  unsigned char	*data = NULL,		// Input data
+		*temp;			// New input data
+  size_t	len,			// Length of input data
+		alloc = 0,		// Allocated input data
+		bytes;			// Bytes read
+
+
+  for (i = 1; i < argc || i == 1; i ++)
+  {
+    if (i >= argc || !strcmp(argv[i], "-"))
+    {
+      fp = stdin;
+    }
+    else if ((fp = fopen(argv[i], "rb")) == NULL)
+    {
+      perror(argv[i]);
+      return (1);
+    }
+
+    len = 0;
+
+    do
+    {
+      if (len >= alloc)
+      {
+        alloc = alloc ? 2 * alloc : 65536;
+
+        if ((temp = realloc(data, alloc)) == NULL)
+        {
+          perror("fuzzmantohtml");
+          return (1);
+        }
+
+        data = temp;
+      }
+
+      bytes = fread(data + len, 1, alloc - len, fp);
+      len   += bytes;
+    }
+    while (bytes > 0);
+
+    if (fp != stdin)
+      fclose(fp);
+
+    LLVMFuzzerTestOneInput(data, len);
+
+    if (i >= argc)
+      break;
+  }
+
+  free(data);
+
+  return (0);
+}
+#endif // !MANTOHTML_LIBFUZZER
+
+
+//
+// 'LLVMFuzzerTestOneInput()' - Convert one fuzzed man page.
+//
+// The bits of the first byte are:
+//
+//    0x01 - compact HTML
+//    0x02 - table of contents
+//    0x0c - output format (HTML, fragment, JSON, or text)
+//    0x10 - read from a file descriptor instead of memory
+//    0x20 - chapter heading
+//    0x40 - cross-reference index
+//
+
+int					// O - 0 to keep the input
+LLVMFuzzerTestOneInput(
+    const unsigned char *data,		// I - Fuzzed data
+    size_t              len)		// I - Length of fuzzed data
+{
+  mantohtml_options_t	options;	// Conversion options
+  mantohtml_t		*doc;		// HTML document
+  mantohtml_index_t	*index = NULL;	// Cross-reference index
+  unsigned		flags;		// Option bits
+
+
+  if (len < 1)
+    return (0);
+
+  fuzz_init();
+
+  flags = data[0];
+  data ++;
+  len --;
+
+  memset(&options, 0, sizeof(options));
+
+  options.compact = (flags & 0x01) != 0;
+  options.toc     = (flags & 0x02) != 0;
+  options.format  = (mantohtml_format_t)((flags >> 2) & 3);
+
+  if (flags & 0x20)
+    options.chapter = "Fuzzing Chapter";
+
+  if (flags & 0x40)
+  {
+    // Each input gets a fresh index so that one input cannot affect the next...
+    if ((index = mantohtml_index_new()) == NULL)
+      return (0);
+
+    mantohtml_index_add(index, "ls.1", "ls.html");
+    mantohtml_index_add(index, "printf.3", "printf.html");
+
+    options.index = index;
+  }
+
+  if ((doc = mantohtml_new(&options, fuzz_sink)) == NULL)
+  {
+    mantohtml_index_delete(index);
+    return (0);
+  }
+
+  if (flags & 0x10)
+  {
+    // Read through a temporary file to use the streaming input reader...
+    FILE	*fp;			// Temporary file
+
+    if ((fp = tmpfile()) != NULL)
+    {
+      if (fwrite(data, 1, len, fp) == len && !fflush(fp) && !fseek(fp, 0, SEEK_SET))
+        mantohtml_add_fd(doc, "fuzz", fileno(fp));
+
+      fclose(fp);
+    }
+  }
+  else
+  {
+    mantohtml_add_buffer(doc, "fuzz", (const char *)data, len);
+  }
+
+  mantohtml_finish(doc);
+  mantohtml_delete(doc);
+  mantohtml_index_delete(index);
+
+  mantohtml_sink_reset(fuzz_sink);
+
+  return (0);
+}
+
+
+//
+// 'fuzz_init()' - Create the output sink used for every input.
+//
+// Conversion messages are discarded when the "FUZZ_QUIET" environment
+// variable is set.  Sanitizer reports also go to the standard error, so
+// leave it unset when looking for them.
+//
+
+static void
+fuzz_init(void)
+{
+  int	fd;				// /dev/null
+
+
+  if (fuzz_sink)
+    return;
+
+  if ((fuzz_sink = mantohtml_sink_new_memory()) == NULL)
+  {
+    perror("fuzzmantohtml");
+    exit(1);
+  }
+
+  if (getenv("FUZZ_QUIET") && (fd = open("/dev/null", O_WRONLY)) >= 0)
+  {
+    dup2(fd, 2);
+    close(fd);
+  }
+}
@@ -0,0 +1,228 @@
+//
+// Arena allocator functions for the man page to HTML conversion library.
+//
+// Copyright © 2022-2023 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.
+// <https://opensource.org/licenses/Apache-2.0>
+//
+
+#include "mantohtml-private.h"
+#include <stdlib.h>
+#include <string.h>
+
+
+//
+// Constants...
+//
+
+#define MAN_ARENA_ALIGN	sizeof(void *)	// Alignment of allocations
+#define MAN_ARENA_SIZE	65536		// Size of first chunk
+
+
+//
+// Local types...
+//
+
+struct _mantohtml_achunk_s		// Arena chunk
+{
+  struct _mantohtml_achunk_s *next;	// Previous (smaller) chunk
+  size_t		size;		// Size of chunk data
+  void			*data[1];	// Chunk data (aligned)
+};
+
+
+//
+// Local functions...
+//
+
+static void	*arena_alloc(_mantohtml_arena_t *arena, size_t size);
+static bool	arena_chunk(_mantohtml_arena_t *arena, size_t size);
+
+
+//
+// '_mantohtml_arena_alloc()' - Allocate zeroed memory from an arena.
+//
+
+void *					// O - Memory or `NULL` on error
+_mantohtml_arena_alloc(
+    _mantohtml_arena_t *arena,		// I - Arena
+    size_t             size)		// I - Number of bytes
+{
+  void	*ptr;				// Allocated memory
+
+
+  if ((ptr = arena_alloc(arena, size)) != NULL)
+    memset(ptr, 0, size);
+
+  return (ptr);
+}
+
+
+//
+// '_mantohtml_arena_free()' - Free all memory used by an arena.
+//
+
+void
+_mantohtml_arena_free(
+    _mantohtml_arena_t *arena)		// I - Arena
+{
+  struct _mantohtml_achunk_s *chunk,	// Current chunk
+		*next;			// Next chunk
+
+
+  for (chunk = arena->chunks; chunk; chunk = next)
+  {
+    next = chunk->next;
+    free(chunk);
+  }
+
+  memset(arena, 0, sizeof(_mantohtml_arena_t));
+}
+
+
+//
+// '_mantohtml_arena_grow()' - Grow an allocation.
+//
+// The most recent allocation is grown in place when there is room, otherwise
+// the data is copied to a new allocation.  Grown memory is not zeroed.
+//
+
+void *					// O - Memory or `NULL` on error
+_mantohtml_arena_grow(
+    _mantohtml_arena_t *arena,		// I - Arena
+    void               *ptr,		// I - Current allocation
+    size_t             oldsize,		// I - Current size
+    size_t             newsize)		// I - New size
+{
+  void	*newptr;			// New allocation
+
+
+  if (ptr && ptr == arena->last && newsize <= (size_t)(arena->end - (char *)ptr))
+  {
+    arena->ptr = (char *)ptr + newsize;
+    return (ptr);
+  }
+
+  if ((newptr = arena_alloc(arena, newsize)) != NULL && ptr)
+    memcpy(newptr, ptr, oldsize);
+
+  return (newptr);
+}
+
+
+//
+// '_mantohtml_arena_reset()' - Release all allocations in an arena.
+//
+// The largest chunk is kept so that converting a similar man page next does
+// not allocate any memory.
+//
+
+void
+_mantohtml_arena_reset(
+    _mantohtml_arena_t *arena)		// I - Arena
+{
+  struct _mantohtml_achunk_s *chunk,	// Current chunk
+		*next;			// Next chunk
+
+
+  if (!arena->chunks)
+    return;
+
+  for (chunk = arena->chunks->next; chunk; chunk = next)
+  {
+    next = chunk->next;
+    free(chunk);
+  }
+
+  arena->chunks->next = NULL;
+  arena->ptr          = (char *)arena->chunks->data;
+  arena->end          = arena->ptr + arena->chunks->size;
+  arena->last         = NULL;
+}
+
+
+//
+// '_mantohtml_arena_strdup()' - Copy a string into an arena.
+//
+
+char *					// O - Copy of string or `NULL` on error
+_mantohtml_arena_strdup(
+    _mantohtml_arena_t *arena,		// I - Arena
+    const char         *s,		// I - String
+    size_t             len)		// I - Length of string
+{
+  char	*copy;				// Copy of string
+
+
+  if ((copy = _mantohtml_arena_grow(arena, NULL, 0, len + 1)) != NULL)
+  {
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+  }
+
+  return (copy);
+}
+
+
+//
+// 'arena_alloc()' - Allocate memory from an arena.
+//
+
+static void *				// O - Memory or `NULL` on error
+arena_alloc(_mantohtml_arena_t *arena,	// I - Arena
+            size_t             size)	// I - Number of bytes
+{
+  char	*ptr;				// Allocated memory
+
+
+  ptr = arena->ptr + ((MAN_ARENA_ALIGN - ((size_t)arena->ptr % MAN_ARENA_ALIGN)) % MAN_ARENA_ALIGN);
+
+  if (!arena->ptr || size > (size_t)(arena->end - ptr))
+  {
+    if (!arena_chunk(arena, size))
+      return (NULL);
+
+    ptr = arena->ptr;
+  }
+
+  arena->last = ptr;
+  arena->ptr  = ptr + size;
+
+  return (ptr);
+}
+
+
+//
+// 'arena_chunk()' - Add a chunk to an arena.
+//
+// Each chunk is at least twice the size of the previous chunk.
+//
+
+static bool				// O - `true` on success, `false` on error
+arena_chunk(_mantohtml_arena_t *arena,	// I - Arena
+            size_t             size)	// I - Minimum size of chunk
+{
+  struct _mantohtml_achunk_s *chunk;	// New chunk
+  size_t	chunksize;		// Size of chunk
+
+
+  chunksize = arena->chunks ? 2 * arena->chunks->size : MAN_ARENA_SIZE;
+
+  while (chunksize < size)
+    chunksize *= 2;
+
+  if ((chunk = malloc(sizeof(struct _mantohtml_achunk_s) + chunksize)) == NULL)
+    return (false);
+
+  chunk->next   = arena->chunks;
+  chunk->size   = chunksize;
+  arena->chunks = chunk;
+  arena->ptr    = (char *)chunk->data;
+  arena->end    = arena->ptr + chunksize;
+  arena->last   = NULL;
+
+  _MANTOHTML_STATS_ADD(arena->growths, 1);
+
+  return (true);
+}
@@ -0,0 +1,360 @@
+//
+// Include cache functions for the man page to HTML conversion library.
+//
+// Copyright © 2022-2023 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.
+// <https://opensource.org/licenses/Apache-2.0>
+//
+
+#include "mantohtml-private.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#if _WIN32
+#  include <windows.h>
+#  define stat _stat
+#else
+#  include <pthread.h>
+#endif // _WIN32
+
+
+//
+// Constants...
+//
+
+#define MAN_CACHE_SIZE	1024		// Number of hash buckets
+
+
+//
+// Local types...
+//
+
+typedef struct man_centry_s		// Cache entry
+{
+  struct man_centry_s	*next;		// Next entry in bucket
+  char			*key,		// Key string
+			*files;		// Files used for the data
+  size_t		len;		// Length of data
+					// Data follows
+} man_centry_t;
+
+struct mantohtml_cache_s		// Include cache
+{
+#if _WIN32
+  CRITICAL_SECTION	mutex;		// Mutex for cache
+#else
+  pthread_mutex_t	mutex;		// Mutex for cache
+#endif // _WIN32
+  man_centry_t		*buckets[MAN_CACHE_SIZE];
+					// Hash buckets
+};
+
+
+//
+// Local functions...
+//
+
+static bool	cache_current(const char *files);
+static void	cache_free(man_centry_t *entry);
+static size_t	cache_hash(const char *key);
+static void	cache_lock(mantohtml_cache_t *cache);
+static void	cache_unlock(mantohtml_cache_t *cache);
+
+
+//
+// 'mantohtml_cache_delete()' - Free the memory used by an include cache.
+//
+
+void
+mantohtml_cache_delete(
+    mantohtml_cache_t *cache)		// I - Include cache
+{
+  size_t	i;			// Looping var
+  man_centry_t	*entry,			// Current entry
+		*next;			// Next entry
+
+
+  if (!cache)
+    return;
+
+  for (i = 0; i < MAN_CACHE_SIZE; i ++)
+  {
+    for (entry = cache->buckets[i]; entry; entry = next)
+    {
+      next = entry->next;
+
+      cache_free(entry);
+    }
+  }
+
+#if _WIN32
+  DeleteCriticalSection(&cache->mutex);
+#else
+  pthread_mutex_destroy(&cache->mutex);
+#endif // _WIN32
+
+  free(cache);
+}
+
+
+//
+// 'mantohtml_cache_new()' - Create an include cache.
+//
+// An include cache remembers the HTML for man pages included with `.so`, so
+// that many aliases for the same man page only read and convert it once.  The
+// cache can be shared by any number of documents and threads using the
+// "cache" member of @link mantohtml_options_t@.
+//
+
+mantohtml_cache_t *			// O - Include cache or `NULL` on error
+mantohtml_cache_new(void)
+{
+  mantohtml_cache_t	*cache;		// Include cache
+
+
+  if ((cache = calloc(1, sizeof(mantohtml_cache_t))) == NULL)
+    return (NULL);
+
+#if _WIN32
+  InitializeCriticalSection(&cache->mutex);
+#else
+  pthread_mutex_init(&cache->mutex, NULL);
+#endif // _WIN32
+
+  return (cache);
+}
+
+
+//
+// '_mantohtml_cache_add()' - Add data to an include cache.
+//
+// The "files" argument lists the files used to make the data, one per line
+// as "MTIME SIZE FILENAME".  Any existing data for the key is replaced, so
+// each key has at most one entry no matter how often its files change.
+//
+
+bool					// O - `true` on success, `false` on error
+_mantohtml_cache_add(
+    mantohtml_cache_t *cache,		// I - Include cache
+    const char        *key,		// I - Key string
+    const char        *files,		// I - Files used for the data
+    const void        *data,		// I - Data
+    size_t            len)		// I - Length of data
+{
+  size_t	hash = cache_hash(key);	// Hash bucket
+  man_centry_t	*entry,			// New entry
+		**prev;			// Pointer to current entry
+
+
+  if ((entry = calloc(1, sizeof(man_centry_t) + len)) == NULL || (entry->key = strdup(key)) == NULL || (entry->files = strdup(files)) == NULL)
+  {
+    if (entry)
+      cache_free(entry);
+
+    return (false);
+  }
+
+  memcpy(entry + 1, data, len);
+  entry->len = len;
+
+  cache_lock(cache);
+
+  for (prev = cache->buckets + hash; *prev; prev = &(*prev)->next)
+  {
+    if (!strcmp((*prev)->key, key))
+    {
+      // Replace the old entry...
+      man_centry_t *old = *prev;	// Old entry
+
+      entry->next = old->next;
+      *prev       = entry;
+
+      cache_unlock(cache);
+      cache_free(old);
+
+      return (true);
+    }
+  }
+
+  entry->next          = cache->buckets[hash];
+  cache->buckets[hash] = entry;
+
+  cache_unlock(cache);
+
+  return (true);
+}
+
+
+//
+// '_mantohtml_cache_find()' - Find data in an include cache.
+//
+// The data is copied to the arena so that it stays valid when another thread
+// replaces the entry.  Data is only returned when none of its files have
+// changed since it was added, otherwise the outdated entry is freed.  The
+// files are checked without holding the lock, so the entry is looked up a
+// second time and only used or freed if it still has the same files.
+//
+
+void *					// O - Copy of cached data or `NULL` if not found
+_mantohtml_cache_find(
+    mantohtml_cache_t  *cache,		// I - Include cache
+    const char         *key,		// I - Key string
+    _mantohtml_arena_t *arena,		// I - Arena for the copy
+    size_t             *len)		// O - Length of data
+{
+  size_t	hash = cache_hash(key);	// Hash bucket
+  man_centry_t	*entry,			// Current entry
+		**prev;			// Pointer to current entry
+  char		*files = NULL;		// Copy of files for entry
+  bool		current;		// Are the files unchanged?
+  void		*data = NULL;		// Copy of cached data
+
+
+  // Copy the list of files for the entry...
+  cache_lock(cache);
+
+  for (entry = cache->buckets[hash]; entry; entry = entry->next)
+  {
+    if (!strcmp(entry->key, key))
+    {
+      files = _mantohtml_arena_strdup(arena, entry->files, strlen(entry->files));
+      break;
+    }
+  }
+
+  cache_unlock(cache);
+
+  if (!files)
+    return (NULL);
+
+  // Check the files and then copy or free the entry...
+  current = cache_current(files);
+
+  cache_lock(cache);
+
+  for (prev = cache->buckets + hash; (entry = *prev) != NULL; prev = &entry->next)
+  {
+    if (!strcmp(entry->key, key))
+    {
+      // Skip the entry if another thread has replaced it...
+      if (strcmp(entry->files, files))
+        break;
+
+      if (!current)
+      {
+        // Free the outdated entry...
+        *prev = entry->next;
+        cache_free(entry);
+      }
+      else if ((data = _mantohtml_arena_alloc(arena, entry->len ? entry->len : 1)) != NULL)
+      {
+        memcpy(data, entry + 1, entry->len);
+        *len = entry->len;
+      }
+      break;
+    }
+  }
+
+  cache_unlock(cache);
+
+  return (data);
+}
+
+
+//
+// 'cache_current()' - Check whether the files used for cached data are unchanged.
+//
+
+static bool				// O - `true` if unchanged, `false` otherwise
+cache_current(const char *files)	// I - "MTIME SIZE FILENAME" lines
+{
+  const char	*fileptr,		// Pointer into files
+		*fileend;		// End of current line
+  char		*numptr,		// End of number
+		filename[4096];		// Current filename
+  long		mtime,			// Modification time
+		size;			// Size
+  struct stat	info;			// File information
+
+
+  for (fileptr = files; *fileptr; fileptr = fileend + 1)
+  {
+    if ((fileend = strchr(fileptr, '\n')) == NULL)
+      return (false);
+
+    mtime = strtol(fileptr, &numptr, 10);
+    size  = strtol(numptr, &numptr, 10);
+
+    if (*numptr != ' ' || (size_t)(fileend - numptr - 1) >= sizeof(filename))
+      return (false);
+
+    memcpy(filename, numptr + 1, (size_t)(fileend - numptr - 1));
+    filename[fileend - numptr - 1] = '\0';
+
+    if (stat(filename, &info) || (long)info.st_mtime != mtime || (long)info.st_size != size)
+      return (false);
+  }
+
+  return (true);
+}
+
+
+//
+// 'cache_free()' - Free a cache entry.
+//
+
+static void
+cache_free(man_centry_t *entry)		// I - Cache entry
+{
+  free(entry->key);
+  free(entry->files);
+  free(entry);
+}
+
+
+//
+// 'cache_hash()' - Compute the hash bucket for a key.
+//
+
+static size_t				// O - Hash bucket
+cache_hash(const char *key)		// I - Key string
+{
+  unsigned	hash = 2166136261U;	// FNV-1a hash
+
+
+  for (; *key; key ++)
+    hash = (hash ^ (*key & 255)) * 16777619U;
+
+  return (hash % MAN_CACHE_SIZE);
+}
+
+
+//
+// 'cache_lock()' - Lock an include cache.
+//
+
+static void
+cache_lock(mantohtml_cache_t *cache)	// I - Include cache
+{
+#if _WIN32
+  EnterCriticalSection(&cache->mutex);
+#else
+  pthread_mutex_lock(&cache->mutex);
+#endif // _WIN32
+}
+
+
+//
+// 'cache_unlock()' - Unlock an include cache.
+//
+
+static void
+cache_unlock(mantohtml_cache_t *cache)	// I - Include cache
+{
+#if _WIN32
+  LeaveCriticalSection(&cache->mutex);
+#else
+  pthread_mutex_unlock(&cache->mutex);
+#endif // _WIN32
+}
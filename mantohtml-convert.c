@@ -0,0 +1,6709 @@
+//
+// Man page to HTML conversion functions for the mantohtml library.
+//
+// Copyright © 2022-2023 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.
+// <https://opensource.org/licenses/Apache-2.0>
+//
+
+#include "mantohtml-private.h"
+#include "mantohtml-glyphs.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#if _WIN32
+#  include <io.h>
+#  define access _access
+#  define close _close
+#  define fstat _fstat
+#  define open _open
+#  define read _read
+#  define stat _stat
+#  define S_ISREG(m) (((m) & _S_IFMT) == _S_IFREG)
+typedef int ssize_t;
+#else
+#  include <pthread.h>
+#  include <unistd.h>
+#endif // _WIN32
+#include <zlib.h>
+#ifdef HAVE_BZLIB
+#  include <bzlib.h>
+#endif // HAVE_BZLIB
+#ifdef HAVE_LZMA
+#  include <lzma.h>
+#endif // HAVE_LZMA
+#ifdef HAVE_ZSTD
+#  include <zstd.h>
+#endif // HAVE_ZSTD
+#if defined(__AVX2__) || defined(__SSE2__)
+#  include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#  include <arm_neon.h>
+#endif // __AVX2__ || __SSE2__
+
+
+//
+// Constants...
+//
+
+#define MAN_ALPHA(ch)	((unsigned)(((ch) | 0x20) - 'a') < 26)
+					// Is the character an ASCII letter?
+#define MAN_AVAIL(n)	((n) > 0x40000000 ? 0x40000000U : (unsigned)(n))
+					// Clamp a length for the decompressors
+#define MAN_CHAR_ANCHOR	0x08		// Kept in anchors (letters, digits, ".", "-")
+#define MAN_CHAR_ENTITY	0x03		// Index of HTML entity in man_specials ("&", "<", "\"")
+#define MAN_CHAR_MAN	0x04		// Special in man text ("\\" escape, ":" of URL)
+#define MAN_CHAR_NAME	0x10		// Character in a man page name
+#define MAN_CHAR_SPACE	0x20		// Whitespace
+#define MAN_CHAR_URLEND	0x80		// Character after the end of a URL
+#define MAN_CHAR_URLPUNCT 0x40		// Punctuation that can end a URL
+#define MAN_CLASS(ch,c)	(man_chars[(ch) & 255] & (c))
+					// Get the MAN_CHAR_xxx class bits of a character
+#define MAN_FLUSH_NODES	4096		// Number of nodes to parse before writing HTML
+#define MAN_MAX_BUFFER	1048576		// Maximum size of initial source buffer
+#define MAN_MAX_DEPTH	8		// Maximum nesting of .so includes
+#define MAN_PARALLEL_MIN 262144		// Minimum size of man page to convert sections in parallel
+#define MAN_MACRO(a,b)	((((a) & 255) << 8) | ((b) & 255))
+					// Pack a macro name for man_macro()
+
+
+//
+// Local types...
+//
+
+typedef enum man_block_e		// Block kinds
+{
+  MAN_BLOCK_NONE,			// Continuation of a block, no start tag
+  MAN_BLOCK_IMPLICIT,			// Implicit paragraph for text
+  MAN_BLOCK_PARAGRAPH,			// Paragraph (.LP/.P/.PP)
+  MAN_BLOCK_HANGING,			// Hanging or tagged paragraph (.HP/.TP)
+  MAN_BLOCK_SYNOPSIS,			// Synopsis (.SY)
+  MAN_BLOCK_EXAMPLE,			// Example (.EX/.nf)
+  MAN_BLOCK_LIST			// List (.IP)
+} man_block_t;
+
+typedef enum man_compress_e		// Man page compression
+{
+  MAN_COMPRESS_NONE,			// Not compressed
+  MAN_COMPRESS_BZIP2,			// bzip2 compressed
+  MAN_COMPRESS_GZIP,			// gzip compressed
+  MAN_COMPRESS_XZ,			// xz compressed
+  MAN_COMPRESS_ZSTD			// Zstandard compressed
+} man_compress_t;
+
+typedef enum man_font_e			// Man page fonts
+{
+  MAN_FONT_REGULAR,			// Plain/regular font
+  MAN_FONT_BOLD,			// Boldface (<strong>) font
+  MAN_FONT_ITALIC,			// Italic (<em>) font
+  MAN_FONT_SMALL,			// Small (<small>) font
+  MAN_FONT_SMALL_BOLD,			// Small bold (<small><strong>) font
+  MAN_FONT_MONOSPACE			// Monospaced (<pre>) font
+} man_font_t;
+
+typedef enum man_heading_e		// Man page heading levels
+{
+  MAN_HEADING_TOPIC,			// Topic heading (.TH)
+  MAN_HEADING_SECTION,			// Section heading (.SH)
+  MAN_HEADING_SUBSECTION		// Sub-section heading (.SS)
+} man_heading_t;
+
+typedef enum man_link_e			// Link kinds
+{
+  MAN_LINK_AUTO,			// URL or man page reference in text
+  MAN_LINK_MAILTO,			// Email address (.MT)
+  MAN_LINK_MAN,				// Man page (.BR name (section))
+  MAN_LINK_URL				// URL (.UR)
+} man_link_t;
+
+typedef enum man_node_type_e		// Document node types
+{
+  MAN_NODE_ROOT,			// Root of man page
+  MAN_NODE_ANCHOR,			// Heading in cached HTML, children are the heading title
+  MAN_NODE_BLOCK,			// Block, children are inline nodes or list items
+  MAN_NODE_BREAK,			// Line break
+  MAN_NODE_FONT,			// Font change
+  MAN_NODE_HEADER,			// HTML header
+  MAN_NODE_HEADING,			// Heading, children are the heading text
+  MAN_NODE_HTML,			// HTML markup
+  MAN_NODE_INDENT,			// Start of relative inset
+  MAN_NODE_ITEM,			// List item, children are inline nodes
+  MAN_NODE_LINK,			// Start of link
+  MAN_NODE_LINK_END,			// End of link
+  MAN_NODE_SPACE,			// Vertical space
+  MAN_NODE_TEXT,			// Plain text, value is `true` if quoting is needed
+  MAN_NODE_UNINDENT			// End of relative inset
+} man_node_type_t;
+
+typedef enum man_token_e		// Tokens in man text
+{
+  MAN_TOKEN_END,			// End of text
+  MAN_TOKEN_CHAR,			// Special character or string (\(xx, \[name], \*x, \NNN)
+  MAN_TOKEN_ENTITY,			// HTML special character
+  MAN_TOKEN_ESCAPE,			// Other escape (\\, \-, \e, etc.)
+  MAN_TOKEN_FONT,			// Font change (\fx)
+  MAN_TOKEN_TEXT,			// Run of plain text
+  MAN_TOKEN_URL				// URL
+} man_token_t;
+
+typedef struct man_lex_s		// Man text lexer
+{
+  const char		*s,		// Current position
+			*end;		// End of text
+  man_token_t		next;		// Lookahead token or `MAN_TOKEN_END`
+  const char		*next_start,	// Start of lookahead token
+			*next_end;	// End of lookahead token
+} man_lex_t;
+
+typedef struct man_node_s		// Document node
+{
+  man_node_type_t	type;		// Node type
+  int			value;		// Block kind, font, heading level, link kind, or list style
+  man_font_t		from;		// Previous font for font changes, font after HTML markup
+  bool			closed;		// Has the block been closed?
+  const char		*elem;		// HTML element for blocks
+  const char		*text;		// Text, HTML, ID, indentation, title, or URL
+  size_t		textlen;	// Length of text
+  struct man_node_s	*next,		// Next sibling node
+			*child,		// First child node
+			*last_child;	// Last child node
+} man_node_t;
+
+typedef struct man_output_s		// Additional output
+{
+  mantohtml_format_t format;		// Output format
+  mantohtml_sink_t *out;		// Output sink
+  man_font_t	out_font,		// Font in the compact HTML output
+		text_font;		// Font for the next text in the compact HTML or JSON output
+  bool		json_comma;		// Need a comma before the next JSON node?
+  int		text_nl;		// Newlines at the end of the text output or `-1` at the start
+} man_output_t;
+
+typedef struct man_special_s		// HTML entity for a special character
+{
+  const char	*html;			// HTML entity
+  size_t	len;			// Length of entity
+} man_special_t;
+
+typedef struct man_source_s		// Man page source
+{
+  int		fd;			// File descriptor or -1 for a buffer
+  bool		eof;			// At end of file?
+  const char	*error;			// Read error message or `NULL`
+  char		*buffer,		// Source buffer
+		*ptr,			// Current position in buffer
+		*end;			// End of data in buffer
+  size_t	bufsize;		// Size of source buffer
+  int		linenum;		// Number of lines before the buffer
+  man_compress_t compress;		// Compression of source
+  bool		ineof,			// At end of compressed input?
+		stream_end;		// At end of compressed stream?
+  unsigned char	*inbuf,			// Compressed data buffer
+		*inptr,			// Current position in compressed data
+		*inend;			// End of compressed data
+  size_t	inbufsize;		// Size of compressed data buffer
+  z_stream	gz;			// gzip decompressor
+#ifdef HAVE_BZLIB
+  bz_stream	bz;			// bzip2 decompressor
+#endif // HAVE_BZLIB
+#ifdef HAVE_LZMA
+  lzma_stream	xz;			// xz decompressor
+#endif // HAVE_LZMA
+#ifdef HAVE_ZSTD
+  ZSTD_DStream	*zstd;			// Zstandard decompressor
+#endif // HAVE_ZSTD
+#ifdef MANTOHTML_STATS
+  size_t	bytes,			// Bytes read
+		growths;		// Number of times the buffer has grown
+  double	gets_time;		// Time reading lines in seconds
+#endif // MANTOHTML_STATS
+} man_source_t;
+
+typedef struct mantohtml_s		// Current man page state
+{
+  mantohtml_sink_t *out;		// Output sink
+  mantohtml_format_t format;		// Output format
+  mantohtml_options_t options;		// Conversion options
+  bool		wrote_header;		// Did we write the HTML header?
+  const char	*basepath;		// Source base path
+  const char	*in_block;		// Current block element?
+  bool		in_link;		// Are we in a link?
+  size_t	indent;			// Indentation level
+  const char	*atopic,		// Current topic (anchor)
+		*asection;		// Current section (anchor)
+  man_font_t	font;			// Current font
+  man_font_t	out_font,		// Font in the compact HTML output
+		text_font;		// Font for the next text in the compact HTML or JSON output
+  bool		json_comma;		// Need a comma before the next JSON node?
+  int		text_nl;		// Newlines at the end of the text output or `-1` at the start
+  man_output_t	*outputs;		// Additional outputs
+  size_t	num_outputs,		// Number of additional outputs
+		alloc_outputs;		// Allocated additional outputs
+  const char	*filename;		// Current man filename
+  man_source_t	*src;			// Current man page source
+  int		linenum;		// Current line number
+  bool		break_line;		// Break after next line?
+  bool		th_seen,		// Have we seen the TH macro?
+		warning;		// Have we displayed a warning?
+  int		depth;			// Current .so include depth
+  mantohtml_sink_t *includes;		// Included filenames for the include cache or `NULL`
+  mantohtml_sink_t *messages;		// Diagnostic messages or `NULL` for the standard error
+  _mantohtml_arena_t arena;		// Memory for document nodes
+  man_node_t	root,			// Root node for current man page
+		*parent,		// Parent node for new blocks
+		*block,			// Current block node or `NULL`
+		*container;		// Current node for inline content or `NULL`
+  size_t	num_nodes;		// Number of nodes since the last flush
+  bool		nomem;			// Did a node allocation fail?
+#ifdef MANTOHTML_STATS
+  _mantohtml_counts_t counts;		// Conversion statistics for man page
+  size_t	num_mcounts;		// Number of macro names
+  _mantohtml_mcount_t mcounts[_MANTOHTML_MAX_MCOUNTS];
+					// Macro counts by name
+#endif // MANTOHTML_STATS
+} man_state_t;
+
+typedef struct man_cached_s		// Cached .so include
+{
+  bool		wrote_header,		// Did we write the HTML header?
+		in_link,		// Are we in a link?
+		th_seen,		// Have we seen the TH macro?
+		warning;		// Have we displayed a warning?
+  const char	*in_block;		// Current block element?
+  size_t	indent;			// Indentation level
+  man_font_t	font;			// Current font
+  bool		break_line;		// Break after next line?
+  size_t	includes_len,		// Length of included filenames
+		html_len,		// Length of HTML
+		anchors_len,		// Length of anchors
+		atopic_len,		// Length of current topic (anchor)
+		asection_len;		// Length of current section (anchor)
+					// Included filenames, HTML, anchors, topic, and section follow
+} man_cached_t;
+
+#if !_WIN32
+typedef struct man_section_s		// Section(s) of a man page converted by a thread
+{
+  char		*start,			// Start of section source
+		*end;			// End of section source
+  int		linenum;		// Number of lines before the section
+  mantohtml_sink_t *html,		// HTML for the section
+		*messages;		// Diagnostic messages for the section
+  bool		ret,			// Did the conversion succeed?
+		nomem,			// Did a node allocation fail?
+		in_link,		// Are we in a link at the end?
+		break_line;		// Break after next line at the end?
+  const char	*in_block;		// Current block element at the end
+  size_t	indent;			// Indentation level at the end
+  man_font_t	font,			// Font at the end
+		out_font,		// Font in the compact HTML output at the end
+		text_font;		// Font for the next text at the end
+  char		*atopic;		// New topic (anchor) or `NULL` if unchanged
+} man_section_t;
+
+typedef struct man_sections_s		// Sections of a man page converted in parallel
+{
+  man_state_t	*state;			// Man state after the preamble
+  const char	*filename;		// Man filename
+  pthread_mutex_t mutex;		// Mutex for the next section
+  size_t	num_sections,		// Number of sections
+		next_section;		// Next section to convert
+  man_section_t	*sections;		// Sections
+} man_sections_t;
+#endif // !_WIN32
+
+typedef bool (*man_macro_cb_t)(man_state_t *state, const char *macro, const char *args);
+					// Macro function
+
+
+//
+// Local globals...
+//
+
+static const unsigned char man_chars[256] =
+{					// Character classes (MAN_CHAR_xxx), ASCII only so the output does not depend on the locale
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xa0, 0xa0, 0x20, 0x20, 0xa0, 0x00, 0x00,	// 0x00 - 0x0F
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,	// 0x10 - 0x1F
+  0xa0, 0x00, 0x03, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x40, 0x00, 0x10, 0xc0, 0x18, 0xd8, 0x00,	// 0x20 - 0x2F
+  0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x14, 0x00, 0x02, 0x00, 0x00, 0x00,	// 0x30 - 0x3F
+  0x00, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,	// 0x40 - 0x4F
+  0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x04, 0x00, 0x00, 0x10,	// 0x50 - 0x5F
+  0x00, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,	// 0x60 - 0x6F
+  0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00,	// 0x70 - 0x7F
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,	// 0x80 - 0x8F
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,	// 0x90 - 0x9F
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,	// 0xA0 - 0xAF
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,	// 0xB0 - 0xBF
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,	// 0xC0 - 0xCF
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,	// 0xD0 - 0xDF
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,	// 0xE0 - 0xEF
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 	// 0xF0 - 0xFF
+};
+
+static const char * const man_exts[] =	// Compression extensions
+{
+  "",
+  ".gz",
+  ".bz2",
+  ".xz",
+  ".zst"
+};
+
+static const man_special_t man_specials[4] =
+{					// HTML entities for MAN_CHAR_ENTITY
+  { "", 0 },
+  { "&amp;", 5 },
+  { "&lt;", 4 },
+  { "&quot;", 6 }
+};
+
+
+//
+// Local functions...
+//
+
+static bool	convert_lines(man_state_t *state, const char *filename, man_source_t *src);
+static bool	convert_man(man_state_t *state, const char *filename, man_source_t *src);
+#if !_WIN32
+static bool	convert_sections(man_state_t *state, const char *filename, man_source_t *src);
+static void	*convert_worker(man_sections_t *sections);
+#endif // !_WIN32
+static char	*html_anchor(man_state_t *state, const char *s);
+static bool	html_css(man_state_t *state);
+static bool	html_empty(man_node_t *node);
+static void	html_font(man_state_t *state, man_font_t from, man_font_t to);
+static void	html_font_sync(man_state_t *state, man_font_t font);
+static void	html_footer(man_state_t *state);
+static bool	html_header(man_state_t *state, const char *title);
+static bool	html_node(man_state_t *state, man_node_t *node);
+static void	html_printf(man_state_t *state, const char *format, ...) __attribute__((__format__(__printf__, 2, 3)));
+static void	html_putc(man_state_t *state, int ch);
+static bool	html_space(man_node_t *node);
+static size_t	html_title(char *title, man_node_t *node);
+static void	html_toc(man_state_t *state, man_node_t *node);
+static void	html_write(man_state_t *state, const char *s, size_t len);
+static void	json_header(man_state_t *state, const char *title);
+static bool	json_node(man_state_t *state, man_node_t *node, bool *comma);
+static void	json_sep(man_state_t *state, bool *comma);
+static void	json_write(man_state_t *state, const char *s, size_t len);
+static bool	macro_B(man_state_t *state, const char *macro, const char *args);
+static bool	macro_BI(man_state_t *state, const char *macro, const char *args);
+static bool	macro_BR(man_state_t *state, const char *macro, const char *args);
+static bool	macro_EE(man_state_t *state, const char *macro, const char *args);
+static bool	macro_EX(man_state_t *state, const char *macro, const char *args);
+static bool	macro_HP(man_state_t *state, const char *macro, const char *args);
+static bool	macro_I(man_state_t *state, const char *macro, const char *args);
+static bool	macro_IB(man_state_t *state, const char *macro, const char *args);
+static bool	macro_IP(man_state_t *state, const char *macro, const char *args);
+static bool	macro_IR(man_state_t *state, const char *macro, const char *args);
+static bool	macro_LP(man_state_t *state, const char *macro, const char *args);
+static bool	macro_ME(man_state_t *state, const char *macro, const char *args);
+static bool	macro_MT(man_state_t *state, const char *macro, const char *args);
+static bool	macro_RB(man_state_t *state, const char *macro, const char *args);
+static bool	macro_RE(man_state_t *state, const char *macro, const char *args);
+static bool	macro_RS(man_state_t *state, const char *macro, const char *args);
+static bool	macro_SB(man_state_t *state, const char *macro, const char *args);
+static bool	macro_SH(man_state_t *state, const char *macro, const char *args);
+static bool	macro_SM(man_state_t *state, const char *macro, const char *args);
+static bool	macro_SS(man_state_t *state, const char *macro, const char *args);
+static bool	macro_SY(man_state_t *state, const char *macro, const char *args);
+static bool	macro_TH(man_state_t *state, const char *macro, const char *args);
+static bool	macro_TP(man_state_t *state, const char *macro, const char *args);
+static bool	macro_UR(man_state_t *state, const char *macro, const char *args);
+static bool	macro_YS(man_state_t *state, const char *macro, const char *args);
+static bool	macro_br(man_state_t *state, const char *macro, const char *args);
+static bool	macro_in(man_state_t *state, const char *macro, const char *args);
+static bool	macro_so(man_state_t *state, const char *macro, const char *args);
+static bool	macro_sp(man_state_t *state, const char *macro, const char *args);
+static const char *man_args(man_state_t *state, const char *args);
+static void	man_break(man_state_t *state);
+static void	man_close(man_source_t *src);
+static void	man_close_block(man_state_t *state);
+static void	man_close_link(man_state_t *state);
+static ssize_t	man_decompress(man_source_t *src, char *buffer, size_t bufsize);
+static bool	man_depend(mantohtml_sink_t *deps, const char *filename);
+static bool	man_fill(man_source_t *src);
+static char	*man_find(man_state_t *state, const char *name);
+static bool	man_flush(man_state_t *state);
+static void	man_font(man_state_t *state, man_font_t font);
+static void	man_footer(man_state_t *state);
+static char	*man_gets(man_source_t *src, int *linenum);
+static const char *man_glyph(const char *name, size_t namelen);
+static void	man_heading(man_state_t *state, man_heading_t heading, const char *s);
+static void	man_html(man_state_t *state, const char *html);
+static void	man_htmlf(man_state_t *state, const char *format, ...) __attribute__((__format__(__printf__, 2, 3)));
+static bool	man_include(man_state_t *state, const char *filename);
+static void	man_included(man_state_t *state, const char *filename);
+static void	man_index(man_state_t *state, man_node_t *node, const char *filename);
+static man_node_t *man_inline(man_state_t *state);
+static man_node_t *man_insert(man_state_t *state, man_node_t *parent, man_node_t *after, man_node_type_t type);
+static man_token_t man_lex(man_lex_t *lex, const char **start, const char **end);
+static void	man_link(man_state_t *state, man_link_t link, const char *url);
+static man_macro_cb_t man_macro(const char *name);
+static void	man_message(man_state_t *state, const char *format, ...) __attribute__((__format__(__printf__, 2, 3)));
+static man_node_t *man_node(man_state_t *state, man_node_t *parent, man_node_type_t type);
+static void	man_open_block(man_state_t *state, man_block_t block, const char *indent);
+static bool	man_open_buffer(man_source_t *src, const char *data, size_t len);
+static bool	man_open_fd(man_source_t *src, int fd);
+static bool	man_open_file(man_source_t *src, const char *filename);
+static void	man_open_range(man_source_t *src, char *start, char *end, int linenum);
+static bool	man_open_stream(man_source_t *src);
+static void	man_putn(man_state_t *state, const char *s, size_t len);
+static void	man_puts(man_state_t *state, const char *s);
+static ssize_t	man_read(man_source_t *src, char *buffer, size_t bufsize);
+static bool	man_render(man_state_t *state, man_node_t *node, bool flush);
+static const char *man_scheme(const char *start, const char *s, const char *end);
+static man_node_t *man_split(man_state_t *state, man_node_t *parent, man_node_t *node, size_t offset);
+#ifdef MANTOHTML_STATS
+static void	man_stats_macro(man_state_t *state, const char *name, size_t count);
+static void	man_stats_out(man_state_t *state, size_t *bytes, size_t *growths, double *secs);
+#endif // MANTOHTML_STATS
+static void	man_swap(man_state_t *state, man_output_t *output);
+static void	man_text(man_state_t *state, const char *s, size_t len, bool quote);
+static const char *man_title(man_state_t *state, man_node_t *heading);
+static bool	man_write(man_state_t *state, man_node_t *node, bool flush);
+static void	man_xref(man_state_t *state, man_node_t *parent, bool *in_link);
+static void	man_xx(man_state_t *state, man_font_t a, man_font_t b, const char *line);
+static const char *parse_arg(const char **lineptr, size_t *len);
+static char	*parse_measurement(man_state_t *state, const char **lineptr, char defunit);
+static char	*parse_value(man_state_t *state, const char **lineptr);
+static inline const char *scan_chars(const char *s, const char *end, int mask, int c0, int c1, int c2, int c3, int c4);
+static const char *scan_html(const char *s, const char *end);
+static const char *scan_man(const char *s, const char *end);
+static const char *scan_plain(const char *s, const char *end);
+static void	text_html(man_state_t *state, const char *s, size_t len);
+static bool	text_node(man_state_t *state, man_node_t *node);
+static void	text_sep(man_state_t *state, int newlines);
+static void	text_write(man_state_t *state, const char *s, size_t len);
+
+
+//
+// 'mantohtml_add_buffer()' - Convert a man page in memory and add it to a document.
+//
+// The "name" argument is used for diagnostics and for resolving hyperlinks to
+// other man pages; `NULL` may be used for in-memory man pages that have no
+// associated file.
+//
+
+bool					// O - `true` on success, `false` on error
+mantohtml_add_buffer(
+    mantohtml_t *doc,			// I - HTML document
+    const char  *name,			// I - Man page name/filename or `NULL`
+    const char  *src,			// I - Man page source
+    size_t      len)			// I - Length of man page source
+{
+  man_source_t	source;			// Man page source
+  bool		ret;			// Return value
+
+
+  if (!man_open_buffer(&source, src, len))
+  {
+    perror("mantohtml");
+    return (false);
+  }
+
+  ret = convert_man(doc, name ? name : "(buffer)", &source);
+
+  man_close(&source);
+
+  return (ret);
+}
+
+
+//
+// 'mantohtml_add_fd()' - Convert a man page from a file descriptor and add it to a document.
+//
+// The man page is read and converted in blocks, so this can be used with pipes
+// such as the standard input.  The "name" argument is used for diagnostics and
+// for resolving hyperlinks to other man pages.  The file descriptor is not
+// closed.
+//
+
+bool					// O - `true` on success, `false` on error
+mantohtml_add_fd(
+    mantohtml_t *doc,			// I - HTML document
+    const char  *name,			// I - Man page name/filename or `NULL`
+    int         fd)			// I - File descriptor
+{
+  man_source_t	source;			// Man page source
+  bool		ret;			// Return value
+
+
+  if (!name)
+    name = "(fd)";
+
+  if (!man_open_fd(&source, fd))
+  {
+    perror(name);
+    return (false);
+  }
+
+  ret = convert_man(doc, name, &source);
+
+  source.fd = -1;
+  man_close(&source);
+
+  return (ret);
+}
+
+
+//
+// 'mantohtml_add_file()' - Convert a man page file and add it to a document.
+//
+
+bool					// O - `true` on success, `false` on error
+mantohtml_add_file(
+    mantohtml_t *doc,			// I - HTML document
+    const char  *filename)		// I - Man filename
+{
+  man_source_t	source;			// Man page source
+  bool		ret;			// Return value
+
+
+  if (!man_open_file(&source, filename))
+  {
+    perror(filename);
+    return (false);
+  }
+
+  ret = convert_man(doc, filename, &source);
+
+  man_close(&source);
+
+  return (ret);
+}
+
+
+//
+// 'mantohtml_add_output()' - Add another output to a document.
+//
+// Each man page is parsed once and then written to the document's output sink
+// in the format from the conversion options, and to each additional output
+// sink in its own format.  Additional outputs must be added before the first
+// man page, and their sinks are flushed but not deleted by
+// @link mantohtml_finish@.
+//
+
+bool					// O - `true` on success, `false` on error
+mantohtml_add_output(
+    mantohtml_t        *doc,		// I - HTML document
+    mantohtml_format_t format,		// I - Output format
+    mantohtml_sink_t   *sink)		// I - Output sink
+{
+  man_output_t	*output;		// New output
+
+
+  if (!doc || !sink)
+    return (false);
+
+  if (doc->num_outputs >= doc->alloc_outputs)
+  {
+    if ((output = realloc(doc->outputs, (doc->alloc_outputs + 4) * sizeof(man_output_t))) == NULL)
+      return (false);
+
+    doc->outputs       = output;
+    doc->alloc_outputs += 4;
+  }
+
+  output = doc->outputs + doc->num_outputs;
+  doc->num_outputs ++;
+
+  memset(output, 0, sizeof(man_output_t));
+  output->format  = format;
+  output->out     = sink;
+  output->text_nl = -1;
+
+  return (true);
+}
+
+
+//
+// 'mantohtml_convert_buffer()'' - Convert a man page in memory to a HTML document.
+//
+// The complete HTML document, including the header and footer, is written to
+// the output sink.
+//
+
+bool					// O - `true` on success, `false` on error
+mantohtml_convert_buffer(
+    const char                *src,	// I - Man page source
+    size_t                    len,	// I - Length of man page source
+    const mantohtml_options_t *options,	// I - Conversion options or `NULL` for defaults
+    mantohtml_sink_t          *sink)	// I - Output sink
+{
+  mantohtml_t	*doc;			// HTML document
+  bool		ret;			// Return value
+
+
+  if ((doc = mantohtml_new(options, sink)) == NULL)
+    return (false);
+
+  if ((ret = mantohtml_add_buffer(doc, NULL, src, len)) == true)
+    ret = mantohtml_finish(doc);
+
+  mantohtml_delete(doc);
+
+  return (ret);
+}
+
+
+//
+// 'mantohtml_convert_file()' - Convert a man page file to a HTML document.
+//
+// The complete HTML document, including the header and footer, is written to
+// the output sink.
+//
+
+bool					// O - `true` on success, `false` on error
+mantohtml_convert_file(
+    const char                *filename,// I - Man filename
+    const mantohtml_options_t *options,	// I - Conversion options or `NULL` for defaults
+    mantohtml_sink_t          *sink)	// I - Output sink
+{
+  mantohtml_t	*doc;			// HTML document
+  bool		ret;			// Return value
+
+
+  if ((doc = mantohtml_new(options, sink)) == NULL)
+    return (false);
+
+  if ((ret = mantohtml_add_file(doc, filename)) == true)
+    ret = mantohtml_finish(doc);
+
+  mantohtml_delete(doc);
+
+  return (ret);
+}
+
+
+//
+// 'mantohtml_delete()' - Free the memory used by a HTML document.
+//
+// The output sink is not flushed or deleted.
+//
+
+void
+mantohtml_delete(mantohtml_t *doc)	// I - HTML document
+{
+  if (doc)
+  {
+    _mantohtml_arena_free(&doc->arena);
+    free(doc->outputs);
+    free(doc);
+  }
+}
+
+
+//
+// 'mantohtml_finish()' - Write the HTML footer and flush the output sink.
+//
+// The footer is written and flushed for each additional output, too.  The
+// document can then be used for another HTML document, which reuses the memory
+// from the previous one.
+//
+
+bool					// O - `true` on success, `false` on error
+mantohtml_finish(mantohtml_t *doc)	// I - HTML document
+{
+  bool		ret;			// Return value
+  size_t	i;			// Looping var
+  man_output_t	*output;		// Current additional output
+#ifdef MANTOHTML_STATS
+  _mantohtml_counts_t counts;		// Statistics for the footer
+  size_t	bytes_out,		// Initial output bytes
+		growths,		// Initial output buffer growths
+		new_growths;		// Current output buffer growths
+  double	write_time;		// Initial output time
+
+
+  man_stats_out(doc, &bytes_out, &growths, &write_time);
+#endif // MANTOHTML_STATS
+
+  man_footer(doc);
+
+  for (i = doc->num_outputs, output = doc->outputs; i > 0; i --, output ++)
+  {
+    man_swap(doc, output);
+    man_footer(doc);
+    man_swap(doc, output);
+
+    output->out_font   = MAN_FONT_REGULAR;
+    output->text_font  = MAN_FONT_REGULAR;
+    output->json_comma = false;
+    output->text_nl    = -1;
+  }
+
+  doc->wrote_header = false;
+  doc->in_block     = NULL;
+  doc->in_link      = false;
+  doc->indent       = 0;
+  doc->font         = MAN_FONT_REGULAR;
+  doc->out_font     = MAN_FONT_REGULAR;
+  doc->text_font    = MAN_FONT_REGULAR;
+  doc->json_comma   = false;
+  doc->text_nl      = -1;
+  doc->atopic       = "";
+  doc->asection     = "";
+
+  ret = mantohtml_sink_flush(doc->out);
+
+  for (i = doc->num_outputs, output = doc->outputs; i > 0; i --, output ++)
+  {
+    if (!mantohtml_sink_flush(output->out))
+      ret = false;
+  }
+
+#ifdef MANTOHTML_STATS
+  if (doc->options.stats)
+  {
+    // Add the footer and final write to the totals...
+    memset(&counts, 0, sizeof(counts));
+    man_stats_out(doc, &counts.bytes_out, &new_growths, &counts.write_time);
+
+    counts.bytes_out  -= bytes_out;
+    counts.growths    = new_growths - growths;
+    counts.write_time -= write_time;
+
+    _mantohtml_stats_add(doc->options.stats, NULL, 0.0, &counts, 0, NULL);
+  }
+#endif // MANTOHTML_STATS
+
+  return (ret);
+}
+
+
+//
+// 'mantohtml_new()' - Create a new HTML document.
+//
+// Man pages are added using the @link mantohtml_add_buffer@,
+// @link mantohtml_add_fd@, and @link mantohtml_add_file@ functions.  The
+// strings in the options must remain valid until the document is deleted.
+//
+
+mantohtml_t *				// O - HTML document or `NULL` on error
+mantohtml_new(
+    const mantohtml_options_t *options,	// I - Conversion options or `NULL` for defaults
+    mantohtml_sink_t          *sink)	// I - Output sink
+{
+  mantohtml_t	*doc;			// HTML document
+
+
+  if (!sink || (doc = calloc(1, sizeof(mantohtml_t))) == NULL)
+    return (NULL);
+
+  doc->out       = sink;
+  doc->text_nl   = -1;
+  doc->basepath  = ".";
+  doc->atopic    = "";
+  doc->asection  = "";
+  doc->root.type = MAN_NODE_ROOT;
+  doc->parent    = &doc->root;
+
+  mantohtml_set_options(doc, options);
+
+  doc->format = doc->options.format;
+
+  return (doc);
+}
+
+
+//
+// 'mantohtml_set_options()' - Change the conversion options for a document.
+//
+// Options that affect the HTML header have no effect once the first man page
+// has been added, and the output format cannot be changed.
+//
+
+void
+mantohtml_set_options(
+    mantohtml_t               *doc,	// I - HTML document
+    const mantohtml_options_t *options)	// I - Conversion options or `NULL` for defaults
+{
+  if (options)
+    doc->options = *options;
+  else
+    memset(&doc->options, 0, sizeof(doc->options));
+
+  if (!doc->options.suffix)
+    doc->options.suffix = ".html";
+}
+
+
+//
+// '_mantohtml_header()' - Write the HTML header for a document.
+//
+// This is used for HTML pages that are not converted from a man page, such
+// as the index page, which are always HTML documents.
+//
+
+bool					// O - `true` on success, `false` on error
+_mantohtml_header(mantohtml_t *doc,	// I - HTML document
+                  const char  *title)	// I - Default title
+{
+  doc->format       = MANTOHTML_FORMAT_HTML;
+  doc->wrote_header = true;
+
+  return (html_header(doc, title));
+}
+
+
+//
+// 'convert_lines()' - Convert the lines in a man page source.
+//
+
+static bool				// O - `true` on success, `false` on error
+convert_lines(man_state_t  *state,	// I - Current man state
+              const char   *filename,	// I - Man filename
+              man_source_t *src)	// I - Man page source
+{
+  char		*line,			// Line from file
+		*lineptr;		// Pointer into line
+  man_macro_cb_t cb;			// Macro function
+  bool		ret = true;		// Return value
+  const char	*old_filename = state->filename;
+					// Previous man filename
+  man_source_t	*old_src = state->src;	// Previous man page source
+  int		old_linenum = state->linenum;
+					// Previous line number
+
+
+  state->filename = filename;
+  state->src      = src;
+  state->linenum  = src->linenum;
+
+  while ((line = man_gets(src, &state->linenum)) != NULL)
+  {
+//    fprintf(stderr, "%5d: %s\n", state->linenum, line);
+
+    if (line[0] == '.')
+    {
+      // Start of a macro, terminate the name in place...
+      for (lineptr = line + 1; *lineptr && !MAN_CLASS(*lineptr, MAN_CHAR_SPACE); lineptr ++);
+
+      if (lineptr == (line + 1))
+      {
+        // . (blank line)
+        continue;
+      }
+
+      if (*lineptr)
+      {
+        *lineptr++ = '\0';
+
+        while (MAN_CLASS(*lineptr, MAN_CHAR_SPACE))
+          lineptr ++;
+      }
+
+      cb = man_macro(line);
+
+#ifdef MANTOHTML_STATS
+      man_stats_macro(state, line + 1, 1);
+#endif // MANTOHTML_STATS
+
+      if (state->num_nodes >= MAN_FLUSH_NODES && (cb == macro_HP || cb == macro_LP || cb == macro_SH || cb == macro_SS || cb == macro_TP) && !man_flush(state))
+      {
+        // Write the HTML for the nodes before starting a new block...
+        ret = false;
+        break;
+      }
+
+      if (cb != macro_TH && cb != macro_so && !state->th_seen)
+      {
+        if (!state->warning)
+        {
+	  man_message(state, "mantohtml: Need '.TH' before '%s' macro on line %d of '%s'.\n", line, state->linenum, state->filename);
+	  state->warning = true;
+	}
+        continue;
+      }
+      else if (!cb)
+      {
+        // Something else we don't recognize.
+        man_message(state, "mantohtml: Unsupported command/macro '%s' on line %d of '%s'.\n", line, state->linenum, state->filename);
+        _MANTOHTML_STATS_ADD(state->counts.unknown_macros, 1);
+      }
+      else
+      {
+        bool	cbret;			// Return value from macro function
+        _MANTOHTML_STATS_START(start);	// Start time
+
+        cbret = (cb)(state, line, lineptr);
+
+        _MANTOHTML_STATS_END(state->counts.macro_time, start);
+
+        if (!cbret)
+        {
+          ret = false;
+          break;
+        }
+        else if (cb == macro_TH)
+        {
+          state->th_seen = true;
+        }
+      }
+    }
+    else if (state->th_seen)
+    {
+      // Text that needs to be written...
+      size_t	linelen = strlen(line);	// Length of line
+
+      if (!state->in_block)
+        man_open_block(state, MAN_BLOCK_IMPLICIT, NULL);
+
+      if (!state->break_line && scan_plain(line, line + linelen) == (line + linelen))
+      {
+        // Plain text is added as-is, with the newline replacing the nul...
+        _MANTOHTML_STATS_START(start);	// Start time
+
+        line[linelen] = '\n';
+        man_text(state, line, linelen + 1, false);
+
+        _MANTOHTML_STATS_END(state->counts.puts_time, start);
+      }
+      else
+      {
+        man_puts(state, line);
+        man_break(state);
+      }
+    }
+    else if (line[0] && !state->warning)
+    {
+      man_message(state, "mantohtml: Ignoring text before '.TH' on line %d of '%s'.\n", state->linenum, state->filename);
+      state->warning = true;
+    }
+  }
+
+  if (ret && src->error)
+  {
+    man_message(state, "mantohtml: Unable to read '%s': %s.\n", filename, src->error);
+    ret = false;
+  }
+
+  _MANTOHTML_STATS_ADD(state->counts.bytes_in, src->bytes);
+  _MANTOHTML_STATS_ADD(state->counts.growths, src->growths);
+  _MANTOHTML_STATS_ADD(state->counts.gets_time, src->gets_time);
+  _MANTOHTML_STATS_ADD(state->counts.lines, (size_t)(state->linenum - src->linenum));
+
+  state->filename = old_filename;
+  state->src      = old_src;
+  state->linenum  = old_linenum;
+
+  return (ret);
+}
+
+
+//
+// 'convert_man()' - Convert a man page.
+//
+
+static bool				// O - `true` on success, `false` on error
+convert_man(man_state_t  *state,	// I - Current man state
+            const char   *filename,	// I - Man filename
+            man_source_t *src)		// I - Man page source
+{
+  bool		ret;			// Return value
+  const char	*baseptr;		// Pointer to end of base path
+#ifdef MANTOHTML_STATS
+  double	start_time = _mantohtml_stats_time(),
+					// Start time
+		write_time;		// Initial output time
+  size_t	bytes_out,		// Initial output bytes
+		growths,		// Initial output buffer growths
+		arena_growths = state->arena.growths;
+					// Initial arena growths
+
+
+  memset(&state->counts, 0, sizeof(state->counts));
+  state->num_mcounts = 0;
+
+  man_stats_out(state, &bytes_out, &growths, &write_time);
+#endif // MANTOHTML_STATS
+
+
+  if ((baseptr = strrchr(filename, '/')) != NULL)
+  {
+    // Base path for man source is the directory containing it...
+    if ((state->basepath = _mantohtml_arena_strdup(&state->arena, filename, (size_t)(baseptr - filename))) == NULL)
+    {
+      state->basepath = ".";
+      state->nomem    = true;
+    }
+  }
+  else
+  {
+    // Assume the man source is in the current directory...
+    state->basepath = ".";
+  }
+
+  state->break_line = false;
+  state->th_seen    = false;
+  state->warning    = false;
+
+  // Parse the man page into nodes, link and index them as needed, and then
+  // write them to each output...
+#if !_WIN32
+  if (state->options.threads > 1 && !state->options.toc && !state->options.index && !state->options.include_cb && !state->depth && state->format <= MANTOHTML_FORMAT_FRAGMENT && !state->num_outputs)
+    ret = convert_sections(state, filename, src);
+  else
+#endif // !_WIN32
+  ret = convert_lines(state, filename, src);
+
+  if (!state->nomem && state->options.index)
+    man_index(state, state->root.child, filename);
+
+  if (!state->nomem && !man_write(state, state->root.child, false))
+    ret = false;
+
+  if (state->nomem)
+  {
+    man_message(state, "mantohtml: Unable to convert '%s': %s\n", filename, strerror(ENOMEM));
+    ret = false;
+  }
+
+#ifdef MANTOHTML_STATS
+  if (state->options.stats)
+  {
+    // Add the statistics for this man page...
+    size_t	new_bytes_out,		// Current output bytes
+		new_growths;		// Current output buffer growths
+    double	new_write_time;		// Current output time
+
+    man_stats_out(state, &new_bytes_out, &new_growths, &new_write_time);
+
+    state->counts.bytes_out  += new_bytes_out - bytes_out;
+    state->counts.growths    += new_growths - growths + state->arena.growths - arena_growths;
+    state->counts.write_time += new_write_time - write_time;
+
+    _mantohtml_stats_add(state->options.stats, filename, _mantohtml_stats_time() - start_time, &state->counts, state->num_mcounts, state->mcounts);
+  }
+#endif // MANTOHTML_STATS
+
+  // Free the nodes for the next man page...
+  _mantohtml_arena_reset(&state->arena);
+
+  state->root.child = state->root.last_child = NULL;
+  state->block      = state->container = NULL;
+  state->num_nodes  = 0;
+  state->nomem      = false;
+  state->basepath   = ".";
+  state->atopic     = "";
+  state->asection   = "";
+
+  if (!ret)
+    return (false);
+
+  if (!state->th_seen)
+  {
+    // No man page in this file...
+    if (!state->warning)
+      man_message(state, "mantohtml: No '.TH' macro in '%s'.\n", filename);
+
+    return (false);
+  }
+
+  return (true);
+}
+
+#if !_WIN32
+//
+// 'convert_sections()' - Convert the sections of a large man page in parallel.
+//
+// The preamble up to the first `.SH` line is converted first, then groups of
+// sections are converted by worker threads starting with the state at the end
+// of the preamble.  The HTML and messages for each group are then written in
+// order.  Since
+// `.SH` closes the current block and link, only the font, indentation, line
+// break, and topic can carry over from one section to the next - a group that
+// follows one ending with a different state is converted again in order so
+// that the HTML is the same as for a sequential conversion.
+//
+
+static bool				// O - `true` on success, `false` on error
+convert_sections(man_state_t  *state,	// I - Current man state
+                 const char   *filename,// I - Man filename
+                 man_source_t *src)	// I - Man page source
+{
+  bool		ret = true;		// Return value
+  man_sections_t sections;		// Sections of the man page
+  man_section_t	*sec;			// Current section
+  size_t	i,			// Looping var
+		alloc_sections = 0,	// Allocated sections
+		chunk,			// Minimum size of a group of sections
+		num_threads;		// Number of threads
+  pthread_t	*threads;		// Worker threads
+  char		*line,			// Start of current line
+		*next,			// Start of next line
+		*prev = NULL;		// Start of previous line
+  int		linenum = 0;		// Number of lines before current line
+  man_source_t	range;			// Part of the man page source
+  man_font_t	font;			// Font after the preamble
+  size_t	indent;			// Indentation level after the preamble
+  bool		break_line;		// Break after next line after the preamble?
+  char		*atopic;		// Topic (anchor) after the preamble
+
+
+  // Read the rest of the man page...
+  while (man_fill(src));
+
+  if (src->error || (size_t)(src->end - src->ptr) < MAN_PARALLEL_MIN)
+    return (convert_lines(state, filename, src));
+
+  // Find the .SH lines, grouping the sections so that each thread gets several
+  // groups of about the same size...
+  memset(&sections, 0, sizeof(sections));
+
+  chunk = (size_t)(src->end - src->ptr) / (4 * (size_t)state->options.threads);
+
+  for (line = src->ptr; line < src->end; prev = line, line = next)
+  {
+    if ((next = memchr(line, '\n', (size_t)(src->end - line))) != NULL)
+      next ++;
+    else
+      next = src->end;
+
+    // Don't split after a continuation or a macro without arguments, which
+    // might use the .SH line...
+    if ((src->end - line) > 3 && !memcmp(line, ".SH", 3) && isspace(line[3] & 255) && prev && ((line - prev) < 2 || line[-2] != '\\') && (prev[0] != '.' || memchr(prev, ' ', (size_t)(line - prev)) || memchr(prev, '\t', (size_t)(line - prev))) && (!sections.num_sections || (size_t)(line - sections.sections[sections.num_sections - 1].start) >= chunk))
+    {
+      if (sections.num_sections >= alloc_sections)
+      {
+        if ((sec = realloc(sections.sections, (alloc_sections + 16) * sizeof(man_section_t))) == NULL)
+        {
+          man_message(state, "mantohtml: Unable to convert '%s': %s\n", filename, strerror(errno));
+          free(sections.sections);
+          return (false);
+        }
+
+        sections.sections = sec;
+        alloc_sections    += 16;
+      }
+
+      sec = sections.sections + sections.num_sections;
+      sections.num_sections ++;
+
+      memset(sec, 0, sizeof(man_section_t));
+      sec->start   = line;
+      sec->linenum = linenum;
+
+      if (sections.num_sections > 1)
+        sec[-1].end = line;
+    }
+
+    if (next > line && next[-1] == '\n')
+      linenum ++;
+  }
+
+  if (sections.num_sections < 2)
+  {
+    // Not enough sections to convert in parallel...
+    free(sections.sections);
+    return (convert_lines(state, filename, src));
+  }
+
+  sections.sections[sections.num_sections - 1].end = src->end;
+
+  // Convert the preamble and write its HTML...
+  man_open_range(&range, src->ptr, sections.sections[0].start, 0);
+
+  if (!convert_lines(state, filename, &range))
+  {
+    ret = false;
+    goto done;
+  }
+
+  if (!state->th_seen || state->nomem)
+  {
+    // Convert the rest of the man page in order...
+    man_open_range(&range, sections.sections[0].start, src->end, sections.sections[0].linenum);
+
+    ret = convert_lines(state, filename, &range);
+    goto done;
+  }
+
+  if (!man_flush(state))
+  {
+    ret = false;
+    goto done;
+  }
+
+  font       = state->font;
+  indent     = state->indent;
+  break_line = state->break_line;
+
+  if ((atopic = strdup(state->atopic)) == NULL)
+  {
+    state->nomem = true;
+    goto done;
+  }
+
+  // Convert the sections using the worker threads and this thread...
+  sections.state    = state;
+  sections.filename = filename;
+
+  pthread_mutex_init(&sections.mutex, NULL);
+
+  if ((num_threads = (size_t)state->options.threads) > sections.num_sections)
+    num_threads = sections.num_sections;
+
+  if ((threads = calloc(num_threads - 1, sizeof(pthread_t))) != NULL)
+  {
+    for (i = 0; i < (num_threads - 1); i ++)
+    {
+      if (pthread_create(threads + i, NULL, (void *(*)(void *))convert_worker, &sections))
+        break;
+    }
+
+    num_threads = i;
+  }
+  else
+  {
+    num_threads = 0;
+  }
+
+  convert_worker(&sections);
+
+  for (i = 0; i < num_threads; i ++)
+    pthread_join(threads[i], NULL);
+
+  free(threads);
+  pthread_mutex_destroy(&sections.mutex);
+
+  // Write the HTML for each group of sections...
+  for (i = 0, sec = sections.sections; i < sections.num_sections && ret; i ++, sec ++)
+  {
+    if (state->font != font || state->indent != indent || state->break_line != break_line || strcmp(state->atopic, atopic))
+    {
+      // The previous section changed the state, so convert this one again...
+      man_open_range(&range, sec->start, sec->end, sec->linenum);
+
+      if (!convert_lines(state, filename, &range) || ((i + 1) < sections.num_sections && !man_flush(state)))
+        ret = false;
+    }
+    else
+    {
+      const char	*html;		// HTML or messages for the section
+      size_t	htmllen;		// Length of HTML or messages
+
+      if ((html = mantohtml_sink_get_buffer(sec->messages, &htmllen)) != NULL)
+        fwrite(html, 1, htmllen, stderr);
+
+      if ((html = mantohtml_sink_get_buffer(sec->html, &htmllen)) != NULL)
+        mantohtml_sink_write(state->out, html, htmllen);
+
+      if (!sec->ret)
+        ret = false;
+
+      if (sec->nomem)
+        state->nomem = true;
+
+      state->in_block   = sec->in_block;
+      state->in_link    = sec->in_link;
+      state->indent     = sec->indent;
+      state->font       = sec->font;
+      state->out_font   = sec->out_font;
+      state->text_font  = sec->text_font;
+      state->break_line = sec->break_line;
+
+      if (sec->atopic && (state->atopic = _mantohtml_arena_strdup(&state->arena, sec->atopic, strlen(sec->atopic))) == NULL)
+      {
+        state->atopic = "";
+        state->nomem  = true;
+      }
+    }
+  }
+
+  free(atopic);
+
+  done:
+
+  for (i = 0, sec = sections.sections; i < sections.num_sections; i ++, sec ++)
+  {
+    mantohtml_sink_delete(sec->html);
+    mantohtml_sink_delete(sec->messages);
+    free(sec->atopic);
+  }
+
+  free(sections.sections);
+
+  _MANTOHTML_STATS_ADD(state->counts.bytes_in, src->bytes);
+  _MANTOHTML_STATS_ADD(state->counts.growths, src->growths);
+
+  src->ptr = src->end;
+
+  return (ret);
+}
+
+
+//
+// 'convert_worker()' - Convert sections of a man page.
+//
+
+static void *				// O - Thread exit status (not used)
+convert_worker(
+    man_sections_t *sections)		// I - Sections of the man page
+{
+  man_state_t	*state = sections->state,
+					// Man state after the preamble
+		*wstate = NULL;		// Man state for sections
+  man_section_t	*sec;			// Current section
+  man_source_t	range;			// Copy of section source
+  char		*copy;			// Copy of section source
+  size_t	len;			// Length of section source
+
+
+  for (;;)
+  {
+    // Get the next section to convert...
+    pthread_mutex_lock(&sections->mutex);
+
+    if (sections->next_section < sections->num_sections)
+      sec = sections->sections + sections->next_section ++;
+    else
+      sec = NULL;
+
+    pthread_mutex_unlock(&sections->mutex);
+
+    if (!sec)
+      break;
+
+    // Copy the source so that the original is available if the section has to
+    // be converted again...
+    len = (size_t)(sec->end - sec->start);
+
+    if ((sec->html = mantohtml_sink_new_memory()) == NULL || (sec->messages = mantohtml_sink_new_memory()) == NULL || (copy = malloc(len + 1)) == NULL)
+    {
+      sec->nomem = true;
+      continue;
+    }
+
+    if (!wstate && (wstate = mantohtml_new(&state->options, sec->html)) == NULL)
+    {
+      sec->nomem = true;
+      free(copy);
+      continue;
+    }
+
+    memcpy(copy, sec->start, len);
+
+    // Start with the state after the preamble...
+    wstate->out          = sec->html;
+    wstate->messages     = sec->messages;
+    wstate->wrote_header = state->wrote_header;
+    wstate->basepath     = state->basepath;
+    wstate->in_block     = NULL;
+    wstate->in_link      = false;
+    wstate->indent       = state->indent;
+    wstate->atopic       = state->atopic;
+    wstate->asection     = state->asection;
+    wstate->font         = state->font;
+    wstate->out_font     = state->out_font;
+    wstate->text_font    = state->text_font;
+    wstate->break_line   = state->break_line;
+    wstate->th_seen      = state->th_seen;
+    wstate->warning      = state->warning;
+
+    man_open_range(&range, copy, copy + len, sec->linenum);
+
+    sec->ret = convert_lines(wstate, sections->filename, &range);
+
+    if (sec < (sections->sections + sections->num_sections - 1))
+    {
+      // Close the block and link like the .SH that follows...
+      man_close_link(wstate);
+      man_close_block(wstate);
+    }
+
+    if (!wstate->nomem && !html_node(wstate, wstate->root.child))
+      sec->ret = false;
+
+    if (wstate->options.compact && sec < (sections->sections + sections->num_sections - 1))
+      html_font_sync(wstate, MAN_FONT_REGULAR);
+
+    // Save the state at the end of the section...
+    sec->nomem      = wstate->nomem;
+    sec->in_block   = wstate->in_block;
+    sec->in_link    = wstate->in_link;
+    sec->indent     = wstate->indent;
+    sec->font       = wstate->font;
+    sec->out_font   = wstate->out_font;
+    sec->text_font  = wstate->text_font;
+    sec->break_line = wstate->break_line;
+
+    if (strcmp(wstate->atopic, state->atopic) && (sec->atopic = strdup(wstate->atopic)) == NULL)
+      sec->nomem = true;
+
+    // Free the nodes for the next section...
+    _mantohtml_arena_reset(&wstate->arena);
+
+    wstate->root.child = wstate->root.last_child = NULL;
+    wstate->block      = wstate->container = NULL;
+    wstate->num_nodes  = 0;
+    wstate->nomem      = false;
+
+    free(copy);
+  }
+
+  if (wstate)
+  {
+#ifdef MANTOHTML_STATS
+    size_t		i;		// Looping var
+    _mantohtml_mcount_t	*mcount;	// Current macro count
+
+    // Add the statistics for the sections...
+    pthread_mutex_lock(&sections->mutex);
+
+    state->counts.gets_time       += wstate->counts.gets_time;
+    state->counts.macro_time      += wstate->counts.macro_time;
+    state->counts.puts_time       += wstate->counts.puts_time;
+    state->counts.lines           += wstate->counts.lines;
+    state->counts.unknown_escapes += wstate->counts.unknown_escapes;
+    state->counts.unknown_macros  += wstate->counts.unknown_macros;
+    state->counts.growths         += wstate->counts.growths + wstate->arena.growths;
+
+    for (i = wstate->num_mcounts, mcount = wstate->mcounts; i > 0; i --, mcount ++)
+      man_stats_macro(state, mcount->name, mcount->count);
+
+    pthread_mutex_unlock(&sections->mutex);
+#endif // MANTOHTML_STATS
+
+    mantohtml_delete(wstate);
+  }
+
+  return (NULL);
+}
+#endif // !_WIN32
+
+
+//
+// 'html_anchor()' - Convert a string to a HTML anchor.
+//
+// The anchor is allocated from the document's arena and is never longer than
+// the string.
+//
+
+static char *				// O - Anchor or `NULL` on error
+html_anchor(man_state_t *state,		// I - Current man state
+            const char  *s)		// I - String
+{
+  char	*anchor,			// Anchor
+	*ptr;				// Pointer into anchor
+
+
+  if ((anchor = _mantohtml_arena_grow(&state->arena, NULL, 0, strlen(s) + 1)) == NULL)
+  {
+    state->nomem = true;
+    return (NULL);
+  }
+
+  for (ptr = anchor; *s; s ++)
+  {
+    // Setting bit 5 makes letters lowercase and leaves digits, ".", and "-"
+    // alone...
+    if (MAN_CLASS(*s, MAN_CHAR_ANCHOR))
+      *ptr++ = *s | 0x20;
+    else if ((*s == '(' || *s == ' ' || *s == '\t') && s[1] && ptr > anchor && ptr[-1] != '-')
+      *ptr++ = '-';
+  }
+
+  *ptr++ = '\0';
+
+  // Release the unused memory...
+  return (_mantohtml_arena_grow(&state->arena, anchor, (size_t)(ptr - anchor), (size_t)(ptr - anchor)));
+}
+
+
+//
+// 'html_css()' - Write the contents of the stylesheet file.
+//
+// When an include cache is used, the stylesheet is only read again when its
+// modification time or size changes.
+//
+
+static bool				// O - `true` on success, `false` on error
+html_css(man_state_t *state)		// I - Current man state
+{
+  FILE		*fp;			// CSS file
+  char		line[1024],		// Line from file
+		key[1100],		// Include cache key
+		files[1100];		// File used for the cache
+  struct stat	info;			// CSS file information
+  const char	*data;			// Cached stylesheet
+  size_t	len;			// Length of stylesheet
+  mantohtml_sink_t *css = NULL;		// Stylesheet for the cache
+
+
+  if (state->options.cache && !stat(state->options.css, &info) && snprintf(key, sizeof(key), "css\n%s", state->options.css) < (int)sizeof(key) && snprintf(files, sizeof(files), "%ld %ld %s\n", (long)info.st_mtime, (long)info.st_size, state->options.css) < (int)sizeof(files))
+  {
+    if ((data = _mantohtml_cache_find(state->options.cache, key, &state->arena, &len)) != NULL)
+    {
+      mantohtml_sink_write(state->out, data, len);
+      return (true);
+    }
+
+    css = mantohtml_sink_new_memory();
+  }
+
+  if ((fp = fopen(state->options.css, "r")) == NULL)
+  {
+    perror(state->options.css);
+    mantohtml_sink_delete(css);
+    return (false);
+  }
+
+  while (fgets(line, sizeof(line), fp))
+    mantohtml_sink_puts(css ? css : state->out, line);
+
+  fclose(fp);
+
+  if (css)
+  {
+    // Add the stylesheet to the cache...
+    if ((data = mantohtml_sink_get_buffer(css, &len)) != NULL)
+    {
+      _mantohtml_cache_add(state->options.cache, key, files, data, len);
+      mantohtml_sink_write(state->out, data, len);
+    }
+
+    mantohtml_sink_delete(css);
+  }
+
+  return (true);
+}
+
+
+//
+// 'html_empty()' - Determine whether a block only contains whitespace.
+//
+
+static bool				// O - `true` if empty, `false` otherwise
+html_empty(man_node_t *node)		// I - Block node
+{
+  for (node = node->child; node; node = node->next)
+  {
+    if (node->type != MAN_NODE_FONT && !html_space(node))
+      return (false);
+  }
+
+  return (true);
+}
+
+
+//
+// 'html_font()' - Write a font change.
+//
+
+static void
+html_font(man_state_t *state,		// I - Current man state
+          man_font_t  from,		// I - Previous font
+          man_font_t  to)		// I - New font
+{
+  static const char * const fonts[] =	// Font tags/elements
+  {
+    NULL,
+    "strong",
+    "em",
+    "small",
+    "small",
+    "pre"
+  };
+
+
+  // Close prior font as needed, open new font as needed.
+  if (from)
+    mantohtml_sink_printf(state->out, "</%s>", fonts[from]);
+
+  if (to == MAN_FONT_SMALL_BOLD)
+    mantohtml_sink_puts(state->out, state->options.compact ? "<small style=\"font-weight:bold\">" : "<small style=\"font-weight: bold;\">");
+  else if (to)
+    mantohtml_sink_printf(state->out, "<%s>", fonts[to]);
+}
+
+
+//
+// 'html_font_sync()' - Write a delayed font change in compact HTML.
+//
+// Compact HTML delays font changes until the next text that isn't whitespace,
+// so that adjacent runs of the same font are merged and runs that only contain
+// whitespace are dropped.  Fonts are closed before the start and end of
+// blocks, headings, list items, and links so that the elements nest properly,
+// and reopened for the next text.
+//
+
+static void
+html_font_sync(man_state_t *state,	// I - Current man state
+               man_font_t  font)	// I - Font to use
+{
+  if (state->out_font != font)
+  {
+    html_font(state, state->out_font, font);
+    state->out_font = font;
+  }
+}
+
+
+//
+// 'html_footer()' - Write the HTML footer.
+//
+
+static void
+html_footer(man_state_t *state)		// I - Current man state
+{
+  // Close the last font in compact HTML...
+  if (state->options.compact)
+    html_font_sync(state, MAN_FONT_REGULAR);
+
+  if (state->wrote_header && state->format == MANTOHTML_FORMAT_HTML)
+  {
+    mantohtml_sink_puts(state->out, state->options.compact ? "</body>" : "  </body>\n");
+    mantohtml_sink_puts(state->out, "</html>\n");
+  }
+}
+
+
+//
+// 'html_header()' - Write the HTML header.
+//
+
+static bool				// O - `true` on success, `false` on error
+html_header(man_state_t *state,		// I - Current man state
+            const char  *title)		// I - Title
+{
+  const char	*indent = state->options.compact ? "" : "    ",
+					// Indentation for head elements
+		*nl = state->options.compact ? "" : "\n";
+					// Newline after head elements
+
+
+  mantohtml_sink_puts(state->out, "<!DOCTYPE html>\n");
+  mantohtml_sink_printf(state->out, "<html>%s", nl);
+  mantohtml_sink_puts(state->out, state->options.compact ? "<head>" : "  <head>\n");
+  if (state->options.css)
+  {
+    if (state->options.css_link || !strncmp(state->options.css, "http://", 7) || !strncmp(state->options.css, "https://", 8))
+    {
+      // Reference the stylesheet...
+      html_printf(state, "%s<link rel=\"stylesheet\" type=\"text/css\" href=\"%s\">%s", indent, state->options.css, nl);
+    }
+    else
+    {
+      // Embed the stylesheet...
+      mantohtml_sink_printf(state->out, "%s<style><!--\n", indent);
+
+      if (!html_css(state))
+        return (false);
+
+      mantohtml_sink_printf(state->out, "--></style>%s", nl);
+    }
+  }
+
+  if (state->options.author)
+    html_printf(state, "%s<meta name=\"author\" content=\"%s\">%s", indent, state->options.author, nl);
+  if (state->options.copyright)
+    html_printf(state, "%s<meta name=\"copyright\" content=\"%s\">%s", indent, state->options.copyright, nl);
+  mantohtml_sink_printf(state->out, "%s<meta name=\"creator\" content=\"mantohtml v" VERSION "\">%s", indent, nl);
+  if (state->options.subject)
+    html_printf(state, "%s<meta name=\"subject\" content=\"%s\">%s", indent, state->options.subject, nl);
+  html_printf(state, "%s<title>%s</title>%s", indent, state->options.title ? state->options.title : title ? title : "Documentation", nl);
+  mantohtml_sink_puts(state->out, state->options.compact ? "</head>" : "  </head>\n");
+  mantohtml_sink_puts(state->out, state->options.compact ? "<body>" : "  <body>\n");
+  if (state->options.chapter)
+  {
+    const char	*anchor;		// Anchor for chapter
+
+    if ((anchor = html_anchor(state, state->options.chapter)) == NULL)
+      return (false);
+
+    html_printf(state, "%s<h1 id=\"%s\">%s</h1>%s", indent, anchor, state->options.chapter, nl);
+  }
+
+  return (true);
+}
+
+
+//
+// 'html_node()' - Write the HTML for a list of nodes.
+//
+
+static bool				// O - `true` on success, `false` on error
+html_node(man_state_t *state,		// I - Current man state
+          man_node_t  *node)		// I - First node
+{
+  int	hlevel;				// HTML heading level
+  bool	compact = state->options.compact;
+					// Write compact HTML?
+  const char *indent = compact ? "" : "    ",
+					// Indentation for headings
+	*nl = compact ? "" : "\n";	// Newline after blocks and headings
+
+
+  for (; node; node = node->next)
+  {
+    // Compact HTML changes fonts just before the next content that isn't
+    // whitespace...
+    if (compact)
+    {
+      switch (node->type)
+      {
+        case MAN_NODE_BLOCK :
+        case MAN_NODE_HEADING :
+        case MAN_NODE_INDENT :
+        case MAN_NODE_ITEM :
+        case MAN_NODE_LINK :
+        case MAN_NODE_LINK_END :
+        case MAN_NODE_UNINDENT :
+            html_font_sync(state, MAN_FONT_REGULAR);
+            break;
+
+        case MAN_NODE_FONT :
+            break;
+
+        default :
+            if (!html_space(node))
+              html_font_sync(state, state->text_font);
+            break;
+      }
+    }
+
+    switch (node->type)
+    {
+      case MAN_NODE_ROOT :
+      case MAN_NODE_ANCHOR :
+          break;
+
+      case MAN_NODE_BLOCK :
+          if (compact && node->elem && !strcmp(node->elem, "p") && html_empty(node))
+          {
+            // Drop empty paragraphs...
+            if (!html_node(state, node->child))
+              return (false);
+            break;
+          }
+
+          switch ((man_block_t)node->value)
+          {
+            case MAN_BLOCK_NONE :
+                break;
+            case MAN_BLOCK_IMPLICIT :
+                mantohtml_sink_puts(state->out, "<p>");
+                break;
+            case MAN_BLOCK_PARAGRAPH :
+                mantohtml_sink_puts(state->out, compact ? "<p>" : "    <p>");
+                break;
+            case MAN_BLOCK_HANGING :
+                if (compact)
+                  mantohtml_sink_printf(state->out, "<p style=\"margin-left:%s;text-indent:-%s\">", node->text, node->text);
+                else
+                  mantohtml_sink_printf(state->out, "    <p style=\"margin-left: %s; text-indent: -%s;\">", node->text, node->text);
+                break;
+            case MAN_BLOCK_SYNOPSIS :
+                mantohtml_sink_puts(state->out, compact ? "<p style=\"font-family:monospace\">" : "    <p style=\"font-family: monospace;\">");
+                break;
+            case MAN_BLOCK_EXAMPLE :
+                mantohtml_sink_puts(state->out, compact ? "<pre>" : "    <pre>");
+                break;
+            case MAN_BLOCK_LIST :
+                mantohtml_sink_puts(state->out, compact ? "<ul>" : "    <ul>\n");
+                break;
+          }
+
+          if (!html_node(state, node->child))
+            return (false);
+
+          if (node->closed)
+          {
+            if (compact)
+              html_font_sync(state, MAN_FONT_REGULAR);
+
+            mantohtml_sink_printf(state->out, "</%s>%s", node->elem, nl);
+          }
+          break;
+
+      case MAN_NODE_BREAK :
+          mantohtml_sink_puts(state->out, "<br>\n");
+          break;
+
+      case MAN_NODE_FONT :
+          if (compact)
+            state->text_font = (man_font_t)node->value;
+          else
+            html_font(state, node->from, (man_font_t)node->value);
+          break;
+
+      case MAN_NODE_HEADER :
+          if (state->format == MANTOHTML_FORMAT_HTML && !html_header(state, node->text))
+            return (false);
+          break;
+
+      case MAN_NODE_HEADING :
+          // Convert heading level enum to HTML
+          if (state->options.chapter)
+            hlevel = node->value + 2;
+          else
+            hlevel = node->value + 1;
+
+          html_printf(state, "%s<h%d id=\"%s\">", indent, hlevel, node->text);
+
+          if (!html_node(state, node->child))
+            return (false);
+
+          if (compact)
+            html_font_sync(state, MAN_FONT_REGULAR);
+
+          html_printf(state, "</h%d>%s", hlevel, nl);
+
+          if (node->value == MAN_HEADING_TOPIC && state->options.toc)
+            html_toc(state, node->next);
+          break;
+
+      case MAN_NODE_HTML :
+          mantohtml_sink_write(state->out, node->text, node->textlen);
+
+          if (compact)
+            state->out_font = state->text_font = node->from;
+          break;
+
+      case MAN_NODE_INDENT :
+          if (compact)
+            mantohtml_sink_printf(state->out, "<div style=\"margin-left:%s\">", node->text);
+          else
+            mantohtml_sink_printf(state->out, "    <div style=\"margin-left: %s;\">\n", node->text);
+          break;
+
+      case MAN_NODE_ITEM :
+          if (compact)
+            html_printf(state, "<li style=\"%smargin-left:%s\">", node->value ? "list-style-type:none;" : "", node->text);
+          else
+            html_printf(state, "    <li style=\"%smargin-left: %s;\">", node->value ? "list-style-type: none; " : "", node->text);
+
+          if (!html_node(state, node->child))
+            return (false);
+          break;
+
+      case MAN_NODE_LINK :
+          if (node->value == MAN_LINK_MAILTO)
+            html_printf(state, "<a href=\"mailto:%s\">", node->text);
+          else if (node->value == MAN_LINK_MAN)
+            html_printf(state, "<a href=\"%s%s\">", node->text, state->options.suffix);
+          else
+            html_printf(state, "<a href=\"%s\">", node->text);
+          break;
+
+      case MAN_NODE_LINK_END :
+          mantohtml_sink_puts(state->out, node->value == MAN_LINK_URL ? "</a>\n" : "</a>");
+          break;
+
+      case MAN_NODE_SPACE :
+          mantohtml_sink_puts(state->out, "<br>&nbsp;<br>\n");
+          break;
+
+      case MAN_NODE_TEXT :
+          if (node->value)
+            html_write(state, node->text, node->textlen);
+          else
+            mantohtml_sink_write(state->out, node->text, node->textlen);
+          break;
+
+      case MAN_NODE_UNINDENT :
+          mantohtml_sink_puts(state->out, compact ? "</div>" : "    </div>\n");
+          break;
+    }
+  }
+
+  return (true);
+}
+
+
+//
+// 'html_printf()' - Output a formatted string, quoting HTML entities as needed.
+//
+// Note: Currently only supports "%d", "%s", and "%%" format sequences.
+//
+
+static void
+html_printf(man_state_t *state,	// I - Current man state
+            const char  *format,	// I - Format string
+            ...)			// I - Additional arguments as needed
+{
+  const char	*start = format;	// Start of current fragment
+  va_list	ap;			// Pointer into arguments
+  int		ivalue;			// Integer value
+  const char	*svalue;		// String value
+
+
+  // Prep additional arguments...
+  va_start(ap, format);
+
+  // Loop through the format string, escaping as needed...
+  while (*format)
+  {
+    if (*format == '%')
+    {
+      // Format character
+      if (format > start)
+        mantohtml_sink_write(state->out, start, (size_t)(format - start));
+
+      format ++;
+      if (*format == 'd')
+      {
+        // Insert integer
+        format ++;
+	start = format;
+
+        ivalue = va_arg(ap, int);
+
+        mantohtml_sink_printf(state->out, "%d", ivalue);
+      }
+      else if (*format == 's')
+      {
+        // Insert string
+        format ++;
+	start = format;
+
+        svalue = va_arg(ap, const char *);
+
+        if (svalue)
+          html_write(state, svalue, strlen(svalue));
+      }
+      else if (*format == '%')
+      {
+        // Insert literal %
+        start = format;
+        format ++;
+      }
+      else
+      {
+        // Something else we don't understand...
+        fprintf(stderr, "mantohtml: Fatal error - unsupported format sequence '%%%c' used.\n", *format);
+        abort();
+      }
+    }
+    else
+    {
+      // Literal character...
+      format ++;
+    }
+  }
+
+  // Done with additional arguments...
+  va_end(ap);
+
+  // Finish off the rest...
+  if (format > start)
+    mantohtml_sink_write(state->out, start, (size_t)(format - start));
+}
+
+
+//
+// 'html_putc()' - Put a single character, using entities as needed.
+//
+
+static void
+html_putc(man_state_t *state,		// I - Current man state
+          int         ch)		// I - Character
+{
+  const man_special_t *special = man_specials + MAN_CLASS(ch, MAN_CHAR_ENTITY);
+					// HTML entity, if any
+
+
+  if (special->len)
+    mantohtml_sink_write(state->out, special->html, special->len);
+  else
+    mantohtml_sink_putc(state->out, ch);
+}
+
+
+//
+// 'html_space()' - Determine whether a node is text that only contains whitespace.
+//
+
+static bool				// O - `true` if whitespace, `false` otherwise
+html_space(man_node_t *node)		// I - Node
+{
+  const char	*text,			// Pointer into text
+		*end;			// End of text
+
+
+  if (node->type != MAN_NODE_TEXT)
+    return (false);
+
+  for (text = node->text, end = text + node->textlen; text < end; text ++)
+  {
+    if (*text != ' ' && *text != '\t' && *text != '\n')
+      return (false);
+  }
+
+  return (true);
+}
+
+
+//
+// 'html_title()' - Copy the title of a heading as HTML.
+//
+// Text is quoted and HTML is copied, font changes and links are not part of
+// the title.  Pass `NULL` for the title to just get its length.
+//
+
+static size_t				// O - Length of title
+html_title(char       *title,		// I - Title buffer or `NULL`
+           man_node_t *node)		// I - First child node of heading
+{
+  size_t	len = 0;		// Length of title
+  const char	*s,			// Pointer into text
+		*end;			// End of text
+  const man_special_t *special;		// HTML entity for character
+
+
+  for (; node; node = node->next)
+  {
+    if (node->type == MAN_NODE_BLOCK)
+    {
+      // Text following a font change in the heading...
+      len += html_title(title ? title + len : NULL, node->child);
+    }
+    else if (node->type == MAN_NODE_HTML)
+    {
+      if (title)
+        memcpy(title + len, node->text, node->textlen);
+
+      len += node->textlen;
+    }
+    else if (node->type == MAN_NODE_TEXT)
+    {
+      for (s = node->text, end = s + node->textlen; s < end; s ++)
+      {
+        special = man_specials + MAN_CLASS(*s, MAN_CHAR_ENTITY);
+
+        if (!special->len)
+        {
+          if (title)
+            title[len] = *s;
+
+          len ++;
+        }
+        else
+        {
+          if (title)
+            memcpy(title + len, special->html, special->len);
+
+          len += special->len;
+        }
+      }
+    }
+  }
+
+  return (len);
+}
+
+
+//
+// 'html_toc()' - Write the table of contents for a man page.
+//
+// The table of contents lists the sections and sub-sections that follow the
+// topic heading, up to the next topic heading.
+//
+
+static void
+html_toc(man_state_t *state,		// I - Current man state
+         man_node_t  *node)		// I - First node after the topic heading
+{
+  const char	*title;			// Heading title
+  bool		in_toc = false,		// Have we started the table of contents?
+		in_item = false,	// Is a section item open?
+		in_sub = false;		// Is a sub-section list open?
+
+
+  for (; node; node = node->next)
+  {
+    if (node->type != MAN_NODE_HEADING)
+      continue;
+    else if (node->value == MAN_HEADING_TOPIC || (title = man_title(state, node)) == NULL)
+      break;
+
+    if (!in_toc)
+    {
+      mantohtml_sink_puts(state->out, "    <nav>\n");
+      mantohtml_sink_puts(state->out, "      <ul>\n");
+      in_toc = true;
+    }
+
+    if (node->value == MAN_HEADING_SUBSECTION && in_item)
+    {
+      // Sub-sections are listed under their section...
+      if (!in_sub)
+      {
+        mantohtml_sink_puts(state->out, "<ul>\n");
+        in_sub = true;
+      }
+
+      html_printf(state, "          <li><a href=\"#%s\">", node->text);
+      mantohtml_sink_puts(state->out, title);
+      mantohtml_sink_puts(state->out, "</a></li>\n");
+    }
+    else
+    {
+      if (in_sub)
+        mantohtml_sink_puts(state->out, "        </ul></li>\n");
+      else if (in_item)
+        mantohtml_sink_puts(state->out, "</li>\n");
+
+      html_printf(state, "        <li><a href=\"#%s\">", node->text);
+      mantohtml_sink_puts(state->out, title);
+      mantohtml_sink_puts(state->out, "</a>");
+
+      in_item = true;
+      in_sub  = false;
+    }
+  }
+
+  if (in_sub)
+    mantohtml_sink_puts(state->out, "        </ul></li>\n");
+  else if (in_item)
+    mantohtml_sink_puts(state->out, "</li>\n");
+
+  if (in_toc)
+  {
+    mantohtml_sink_puts(state->out, "      </ul>\n");
+    mantohtml_sink_puts(state->out, "    </nav>\n");
+  }
+}
+
+
+//
+// 'html_write()' - Output a literal string, quoting HTML entities as needed.
+//
+
+static void
+html_write(man_state_t *state,		// I - Current man state
+           const char  *s,		// I - String
+           size_t      len)		// I - Length of string
+{
+  const char	*start = s,		// Start of current fragment
+		*end = s + len;		// End of string
+
+
+  // Loop through the string, escaping as needed...
+  while ((s = scan_html(s, end)) < end)
+  {
+    // Character that needs quoting...
+    if (s > start)
+      mantohtml_sink_write(state->out, start, (size_t)(s - start));
+
+    html_putc(state, *s ++);
+    start = s;
+  }
+
+  // Finish off the rest...
+  if (s > start)
+    mantohtml_sink_write(state->out, start, (size_t)(s - start));
+}
+
+
+//
+// 'json_header()' - Write the JSON header.
+//
+// The JSON document is an object with the metadata and a "nodes" array with
+// the document nodes of each man page.
+//
+
+static void
+json_header(man_state_t *state,		// I - Current man state
+            const char  *title)		// I - Title
+{
+  if (state->options.title)
+    title = state->options.title;
+  else if (!title)
+    title = "Documentation";
+
+  mantohtml_sink_puts(state->out, "{\"title\":");
+  _mantohtml_sink_puts_json(state->out, title, strlen(title));
+
+  if (state->options.author)
+  {
+    mantohtml_sink_puts(state->out, ",\"author\":");
+    _mantohtml_sink_puts_json(state->out, state->options.author, strlen(state->options.author));
+  }
+
+  if (state->options.chapter)
+  {
+    mantohtml_sink_puts(state->out, ",\"chapter\":");
+    _mantohtml_sink_puts_json(state->out, state->options.chapter, strlen(state->options.chapter));
+  }
+
+  if (state->options.copyright)
+  {
+    mantohtml_sink_puts(state->out, ",\"copyright\":");
+    _mantohtml_sink_puts_json(state->out, state->options.copyright, strlen(state->options.copyright));
+  }
+
+  if (state->options.subject)
+  {
+    mantohtml_sink_puts(state->out, ",\"subject\":");
+    _mantohtml_sink_puts_json(state->out, state->options.subject, strlen(state->options.subject));
+  }
+
+  mantohtml_sink_puts(state->out, ",\"nodes\":[\n");
+}
+
+
+//
+// 'json_node()' - Write the JSON for a list of nodes.
+//
+// Each node is written as an object with a "type" and a "children" array for
+// nodes with children.  Adjacent text and HTML markup is written as a single
+// "text" node with the font, if any, and links include the nodes up to the end
+// of the link or the end of the list.
+//
+
+static bool				// O - `true` on success, `false` on error
+json_node(man_state_t *state,		// I - Current man state
+          man_node_t  *node,		// I - First node
+          bool        *comma)		// IO - Need a comma before the next node?
+{
+  bool		in_link = false,	// Are we in a link?
+		link_comma = false,	// Need a comma before the next node in the link?
+		child_comma;		// Need a comma before the next child node?
+  bool		*next_comma = comma;	// Comma for the next node
+  static const char * const blocks[] =	// Block kinds
+  {
+    "continued",
+    "implicit",
+    "paragraph",
+    "hanging",
+    "synopsis",
+    "example",
+    "list"
+  };
+  static const char * const fonts[] =	// Fonts
+  {
+    "regular",
+    "bold",
+    "italic",
+    "small",
+    "small-bold",
+    "monospace"
+  };
+  static const char * const headings[] =// Heading levels
+  {
+    "topic",
+    "section",
+    "subsection"
+  };
+  static const char * const links[] =	// Link kinds
+  {
+    "auto",
+    "mailto",
+    "man",
+    "url"
+  };
+
+
+  for (; node; node = node->next)
+  {
+    child_comma = false;
+
+    switch (node->type)
+    {
+      case MAN_NODE_ROOT :
+      case MAN_NODE_ANCHOR :
+          break;
+
+      case MAN_NODE_BLOCK :
+          json_sep(state, next_comma);
+          mantohtml_sink_printf(state->out, "{\"type\":\"block\",\"kind\":\"%s\"", blocks[node->value]);
+          if (node->text)
+          {
+            mantohtml_sink_puts(state->out, ",\"indent\":");
+            _mantohtml_sink_puts_json(state->out, node->text, strlen(node->text));
+          }
+          mantohtml_sink_puts(state->out, ",\"children\":[");
+
+          if (!json_node(state, node->child, &child_comma))
+            return (false);
+
+          mantohtml_sink_puts(state->out, "]}");
+          break;
+
+      case MAN_NODE_BREAK :
+          json_sep(state, next_comma);
+          mantohtml_sink_puts(state->out, "{\"type\":\"break\"}");
+          break;
+
+      case MAN_NODE_FONT :
+          state->text_font = (man_font_t)node->value;
+          break;
+
+      case MAN_NODE_HEADER :
+          json_header(state, node->text);
+          break;
+
+      case MAN_NODE_HEADING :
+          json_sep(state, next_comma);
+          mantohtml_sink_printf(state->out, "{\"type\":\"heading\",\"level\":\"%s\",\"id\":", headings[node->value]);
+          _mantohtml_sink_puts_json(state->out, node->text, strlen(node->text));
+          mantohtml_sink_puts(state->out, ",\"children\":[");
+
+          if (!json_node(state, node->child, &child_comma))
+            return (false);
+
+          mantohtml_sink_puts(state->out, "]}");
+          break;
+
+      case MAN_NODE_HTML :
+      case MAN_NODE_TEXT :
+          json_sep(state, next_comma);
+          mantohtml_sink_puts(state->out, "{\"type\":\"text\",");
+          if (state->text_font != MAN_FONT_REGULAR)
+            mantohtml_sink_printf(state->out, "\"font\":\"%s\",", fonts[state->text_font]);
+          mantohtml_sink_puts(state->out, "\"text\":\"");
+
+          for (;;)
+          {
+            if (node->type == MAN_NODE_HTML)
+              text_html(state, node->text, node->textlen);
+            else
+              json_write(state, node->text, node->textlen);
+
+            if (!node->next || (node->next->type != MAN_NODE_HTML && node->next->type != MAN_NODE_TEXT))
+              break;
+
+            node = node->next;
+          }
+
+          mantohtml_sink_puts(state->out, "\"}");
+          break;
+
+      case MAN_NODE_INDENT :
+          json_sep(state, next_comma);
+          mantohtml_sink_puts(state->out, "{\"type\":\"indent\",\"indent\":");
+          _mantohtml_sink_puts_json(state->out, node->text, strlen(node->text));
+          mantohtml_sink_putc(state->out, '}');
+          break;
+
+      case MAN_NODE_ITEM :
+          json_sep(state, next_comma);
+          mantohtml_sink_printf(state->out, "{\"type\":\"item\",\"bullet\":%s,\"indent\":", node->value ? "false" : "true");
+          _mantohtml_sink_puts_json(state->out, node->text, strlen(node->text));
+          mantohtml_sink_puts(state->out, ",\"children\":[");
+
+          if (!json_node(state, node->child, &child_comma))
+            return (false);
+
+          mantohtml_sink_puts(state->out, "]}");
+          break;
+
+      case MAN_NODE_LINK :
+          if (in_link)
+            mantohtml_sink_puts(state->out, "]}");
+
+          json_sep(state, comma);
+          mantohtml_sink_printf(state->out, "{\"type\":\"link\",\"kind\":\"%s\",\"href\":\"%s", links[node->value], node->value == MAN_LINK_MAILTO ? "mailto:" : "");
+          json_write(state, node->text, strlen(node->text));
+          if (node->value == MAN_LINK_MAN)
+            json_write(state, state->options.suffix, strlen(state->options.suffix));
+          mantohtml_sink_puts(state->out, "\",\"children\":[");
+
+          in_link    = true;
+          link_comma = false;
+          next_comma = &link_comma;
+          break;
+
+      case MAN_NODE_LINK_END :
+          if (in_link)
+          {
+            mantohtml_sink_puts(state->out, "]}");
+
+            in_link    = false;
+            next_comma = comma;
+          }
+          break;
+
+      case MAN_NODE_SPACE :
+          json_sep(state, next_comma);
+          mantohtml_sink_puts(state->out, "{\"type\":\"space\"}");
+          break;
+
+      case MAN_NODE_UNINDENT :
+          json_sep(state, next_comma);
+          mantohtml_sink_puts(state->out, "{\"type\":\"unindent\"}");
+          break;
+    }
+  }
+
+  if (in_link)
+  {
+    // Links that continue in the next block end with this one...
+    mantohtml_sink_puts(state->out, "]}");
+  }
+
+  return (true);
+}
+
+
+//
+// 'json_sep()' - Write the separator before a JSON node.
+//
+// Nodes in the top-level "nodes" array are written on separate lines.
+//
+
+static void
+json_sep(man_state_t *state,		// I - Current man state
+         bool        *comma)		// IO - Need a comma before the next node?
+{
+  if (*comma)
+    mantohtml_sink_puts(state->out, comma == &state->json_comma ? ",\n" : ",");
+
+  *comma = true;
+}
+
+
+//
+// 'json_write()' - Output a literal string, quoting JSON characters as needed.
+//
+
+static void
+json_write(man_state_t *state,		// I - Current man state
+           const char  *s,		// I - String
+           size_t      len)		// I - Length of string
+{
+  const char	*start,			// Start of current fragment
+		*end = s + len;		// End of string
+
+
+  for (start = s; s < end; s ++)
+  {
+    if (*s == '\"' || *s == '\\' || (*s & 255) < ' ')
+    {
+      if (s > start)
+        mantohtml_sink_write(state->out, start, (size_t)(s - start));
+
+      if (*s == '\"' || *s == '\\')
+        mantohtml_sink_printf(state->out, "\\%c", *s);
+      else
+        mantohtml_sink_printf(state->out, "\\u%04x", *s & 255);
+
+      start = s + 1;
+    }
+  }
+
+  if (s > start)
+    mantohtml_sink_write(state->out, start, (size_t)(s - start));
+}
+
+
+//
+// 'macro_B()' - Bold text (.B [text]).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_B(man_state_t *state,		// I - Current man state
+        const char  *macro,		// I - Macro name
+        const char  *args)		// I - Macro arguments
+{
+  man_font_t	font = state->font;	// Current font
+
+
+  (void)macro;
+
+  args = man_args(state, args);
+
+  man_font(state, MAN_FONT_BOLD);
+  man_puts(state, args);
+  man_font(state, font);
+
+  man_break(state);
+
+  return (true);
+}
+
+
+//
+// 'macro_BI()' - Alternating bold and italic text (.BI bold italic ...).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_BI(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  (void)macro;
+
+  man_xx(state, MAN_FONT_BOLD, MAN_FONT_ITALIC, man_args(state, args));
+  man_break(state);
+
+  return (true);
+}
+
+
+//
+// 'macro_BR()' - Alternating bold and regular text (.BR bold regular ...).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_BR(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  (void)macro;
+
+  man_xx(state, MAN_FONT_BOLD, MAN_FONT_REGULAR, man_args(state, args));
+  man_break(state);
+
+  return (true);
+}
+
+
+//
+// 'macro_EE()' - End an example (.EE) or resume filling (.fi).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_EE(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  (void)args;
+
+  if (!state->in_block || strcmp(state->in_block, "pre"))
+  {
+    man_message(state, "mantohtml: '%s' with no '.EX' or '.nf' on line %d of '%s'.\n", macro, state->linenum, state->filename);
+  }
+  else
+  {
+    man_close_block(state);
+  }
+
+  return (true);
+}
+
+
+//
+// 'macro_EX()' - Start an example (.EX) or stop filling (.nf).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_EX(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  (void)macro;
+  (void)args;
+
+  man_close_link(state);
+
+  man_close_block(state);
+  man_open_block(state, MAN_BLOCK_EXAMPLE, NULL);
+
+  return (true);
+}
+
+
+//
+// 'macro_HP()' - Start a hanging paragraph (.HP [indent]).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_HP(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  const char	*indent;		// Indentation
+
+
+  (void)macro;
+
+  if ((indent = parse_measurement(state, &args, 'n')) == NULL)
+    indent = "2.5em";
+
+  man_close_link(state);
+
+  man_close_block(state);
+  man_open_block(state, MAN_BLOCK_HANGING, indent);
+
+  return (true);
+}
+
+
+//
+// 'macro_I()' - Italic text (.I [text]).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_I(man_state_t *state,		// I - Current man state
+        const char  *macro,		// I - Macro name
+        const char  *args)		// I - Macro arguments
+{
+  man_font_t	font = state->font;	// Current font
+
+
+  (void)macro;
+
+  args = man_args(state, args);
+
+  man_font(state, MAN_FONT_ITALIC);
+  man_puts(state, args);
+  man_font(state, font);
+
+  man_break(state);
+
+  return (true);
+}
+
+
+//
+// 'macro_IB()' - Alternating italic and bold text (.IB italic bold ...).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_IB(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  (void)macro;
+
+  man_xx(state, MAN_FONT_ITALIC, MAN_FONT_BOLD, man_args(state, args));
+  man_break(state);
+
+  return (true);
+}
+
+
+//
+// 'macro_IP()' - Start an indented paragraph (.IP [tag] [indent]).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_IP(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  const char	*tag,			// Tag text
+		*indent = NULL;		// Indentation
+  man_node_t	*item;			// List item
+
+
+  (void)macro;
+
+  if ((tag = parse_value(state, &args)) != NULL)
+    indent = parse_measurement(state, &args, 'n');
+  if (!indent || !*indent)
+    indent = "2.5em";
+
+  man_close_link(state);
+
+  if (state->in_block && strcmp(state->in_block, "ul"))
+    man_close_block(state);
+
+  if (!state->in_block)
+    man_open_block(state, MAN_BLOCK_LIST, NULL);
+  else
+    man_inline(state);
+
+  if ((item = man_node(state, state->block, MAN_NODE_ITEM)) != NULL)
+  {
+    // Only bullet lists show the list marker...
+    item->value = !tag || (strcmp(tag, "\\(bu") && strcmp(tag, "-") && strcmp(tag, "*"));
+    item->text  = indent;
+  }
+
+  state->container  = item;
+  state->break_line = false;
+
+  return (true);
+}
+
+
+//
+// 'macro_IR()' - Alternating italic and regular text (.IR italic regular ...).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_IR(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  (void)macro;
+
+  man_xx(state, MAN_FONT_ITALIC, MAN_FONT_REGULAR, man_args(state, args));
+  man_break(state);
+
+  return (true);
+}
+
+
+//
+// 'macro_LP()' - Start a paragraph (.LP, .P, .PP).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_LP(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  (void)macro;
+  (void)args;
+
+  man_close_link(state);
+
+  man_close_block(state);
+  man_open_block(state, MAN_BLOCK_PARAGRAPH, NULL);
+
+  return (true);
+}
+
+
+//
+// 'macro_ME()' - End a mailto link (.ME) or URL (.UE).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_ME(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  (void)macro;
+  (void)args;
+
+  if (state->in_link)
+    man_link(state, MAN_LINK_URL, NULL);
+
+  return (true);
+}
+
+
+//
+// 'macro_MT()' - Start a mailto link (.MT email-address).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_MT(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  const char	*email;			// Email address
+
+
+  (void)macro;
+
+  if ((email = parse_value(state, &args)) != NULL && *email)
+  {
+    man_link(state, MAN_LINK_MAILTO, email);
+    state->in_link = true;
+  }
+
+  return (true);
+}
+
+
+//
+// 'macro_RB()' - Alternating regular and bold text (.RB regular bold ...).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_RB(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  (void)macro;
+
+  man_xx(state, MAN_FONT_REGULAR, MAN_FONT_BOLD, man_args(state, args));
+  man_break(state);
+
+  return (true);
+}
+
+
+//
+// 'macro_RE()' - End a relative inset (.RE).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_RE(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  (void)macro;
+  (void)args;
+
+  if (state->indent)
+  {
+    man_node(state, man_inline(state), MAN_NODE_UNINDENT);
+    state->indent --;
+  }
+  else
+  {
+    man_message(state, "mantohtml: Unbalanced '.RE' on line %d of '%s'.\n", state->linenum, state->filename);
+  }
+
+  return (true);
+}
+
+
+//
+// 'macro_RS()' - Start a relative inset (.RS [indent]).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_RS(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  const char	*indent;		// Indentation
+  man_node_t	*node;			// Indent node
+
+
+  (void)macro;
+
+  if ((indent = parse_measurement(state, &args, 'n')) == NULL)
+    indent = "0.5in";
+
+  if ((node = man_node(state, man_inline(state), MAN_NODE_INDENT)) != NULL)
+    node->text = indent;
+
+  state->indent ++;
+
+  return (true);
+}
+
+
+//
+// 'macro_SB()' - Small bold text (.SB [text]).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_SB(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  man_font_t	font = state->font;	// Current font
+
+
+  (void)macro;
+
+  args = man_args(state, args);
+
+  man_font(state, MAN_FONT_SMALL_BOLD);
+  man_puts(state, args);
+  man_font(state, font);
+
+  man_break(state);
+
+  return (true);
+}
+
+
+//
+// 'macro_SH()' - Start a section (.SH section-heading).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_SH(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  (void)macro;
+
+  man_close_link(state);
+
+  man_close_block(state);
+
+  man_heading(state, MAN_HEADING_SECTION, args);
+
+  return (true);
+}
+
+
+//
+// 'macro_SM()' - Small text (.SM [text]).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_SM(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  man_font_t	font = state->font;	// Current font
+
+
+  (void)macro;
+
+  args = man_args(state, args);
+
+  man_font(state, MAN_FONT_SMALL);
+  man_puts(state, args);
+  man_font(state, font);
+
+  man_break(state);
+
+  return (true);
+}
+
+
+//
+// 'macro_SS()' - Start a subsection (.SS subsection-heading).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_SS(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  (void)macro;
+
+  man_close_link(state);
+
+  man_close_block(state);
+
+  man_heading(state, MAN_HEADING_SUBSECTION, args);
+
+  return (true);
+}
+
+
+//
+// 'macro_SY()' - Start a synopsis (.SY).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_SY(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  (void)macro;
+  (void)args;
+
+  man_close_block(state);
+  man_open_block(state, MAN_BLOCK_SYNOPSIS, NULL);
+
+  return (true);
+}
+
+
+//
+// 'macro_TH()' - Start a man page (.TH title section [footer-middle [footer-inside [header-middle]]]).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_TH(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  const char	*title,			// Man title
+		*section;		// Man section
+  char		*topic;			// title(section)
+  size_t	topiclen;		// Length of title(section)
+
+
+  (void)macro;
+
+  if ((title = parse_value(state, &args)) == NULL || !title[0])
+  {
+    man_message(state, "mantohtml: Missing title in '.TH' on line %d of '%s'.\n", state->linenum, state->filename);
+    return (false);
+  }
+
+  if ((section = parse_value(state, &args)) == NULL || !isdigit(section[0] & 255))
+  {
+    man_message(state, "mantohtml: Missing section in '.TH' on line %d of '%s'.\n", state->linenum, state->filename);
+    return (false);
+  }
+
+  topiclen = strlen(title) + strlen(section) + 3;
+
+  if ((topic = _mantohtml_arena_grow(&state->arena, NULL, 0, topiclen)) == NULL)
+  {
+    state->nomem = true;
+    return (true);
+  }
+
+  snprintf(topic, topiclen, "%s(%s)", title, section);
+
+  if (!state->wrote_header)
+  {
+    // The HTML header uses the first man page's title...
+    man_node_t	*header;		// Header node
+
+    if ((header = man_node(state, state->parent, MAN_NODE_HEADER)) != NULL)
+      header->text = topic;
+
+    state->wrote_header = true;
+  }
+  else
+  {
+    man_close_link(state);
+
+    man_close_block(state);
+  }
+
+  man_heading(state, MAN_HEADING_TOPIC, topic);
+
+  return (true);
+}
+
+
+//
+// 'macro_TP()' - Start a tagged paragraph (.TP [indent]).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_TP(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  const char	*indent;		// Indentation
+
+
+  (void)macro;
+
+  if ((indent = parse_measurement(state, &args, 'n')) == NULL)
+    indent = "2.5em";
+
+  man_close_link(state);
+
+  man_close_block(state);
+  man_open_block(state, MAN_BLOCK_HANGING, indent);
+
+  state->break_line = true;
+
+  return (true);
+}
+
+
+//
+// 'macro_UR()' - Start a URL link (.UR url).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_UR(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  const char	*url;			// URL value
+
+
+  (void)macro;
+
+  if ((url = parse_value(state, &args)) != NULL && *url)
+  {
+    man_link(state, MAN_LINK_URL, url);
+    state->in_link = true;
+  }
+
+  return (true);
+}
+
+
+//
+// 'macro_YS()' - End a synopsis (.YS).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_YS(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  (void)macro;
+  (void)args;
+
+  if (!state->in_block || strcmp(state->in_block, "p"))
+  {
+    man_message(state, "mantohtml: '.YS' seen without prior '.SY' on line %d of '%s'.\n", state->linenum, state->filename);
+  }
+  else
+  {
+    man_close_block(state);
+  }
+
+  return (true);
+}
+
+
+//
+// 'macro_br()' - Break the current line (.br).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_br(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  (void)macro;
+  (void)args;
+
+  man_node(state, man_inline(state), MAN_NODE_BREAK);
+
+  return (true);
+}
+
+
+//
+// 'macro_in()' - Indent or unindent (.in [indent]).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_in(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  const char	*indent;		// Indentation value
+
+
+  (void)macro;
+
+  if ((indent = parse_measurement(state, &args, 'm')) != NULL)
+  {
+    // Indent...
+    man_node_t	*node;			// Indent node
+
+    if ((node = man_node(state, man_inline(state), MAN_NODE_INDENT)) != NULL)
+      node->text = indent;
+
+    state->indent ++;
+  }
+  else if (state->indent > 0)
+  {
+    // Unindent...
+    man_node(state, man_inline(state), MAN_NODE_UNINDENT);
+    state->indent --;
+  }
+  else
+  {
+    man_message(state, "mantohtml: '.in' seen without prior '.in INDENT' on line %d of '%s'.\n", state->linenum, state->filename);
+  }
+
+  return (true);
+}
+
+
+//
+// 'macro_so()' - Include another man page source (.so filename).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_so(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  const char	*name,			// Name of included file
+		*filename;		// Filename of included file
+
+
+  (void)macro;
+
+  if ((name = parse_value(state, &args)) == NULL || !name[0])
+  {
+    man_message(state, "mantohtml: Missing filename in '.so' on line %d of '%s'.\n", state->linenum, state->filename);
+    return (true);
+  }
+
+  if (state->depth >= MAN_MAX_DEPTH)
+  {
+    man_message(state, "mantohtml: Too many nested '.so' includes on line %d of '%s'.\n", state->linenum, state->filename);
+    return (false);
+  }
+
+  if ((filename = man_find(state, name)) == NULL)
+  {
+    man_message(state, "mantohtml: Unable to find '%s' for '.so' on line %d of '%s'.\n", name, state->linenum, state->filename);
+    return (true);
+  }
+
+  return (man_include(state, filename));
+}
+
+
+//
+// 'macro_sp()' - Add vertical space (.sp [N]).
+//
+
+static bool				// O - `true` to continue, `false` on error
+macro_sp(man_state_t *state,		// I - Current man state
+         const char  *macro,		// I - Macro name
+         const char  *args)		// I - Macro arguments
+{
+  (void)macro;
+  (void)args;
+
+  man_node(state, man_inline(state), MAN_NODE_SPACE);
+
+  return (true);
+}
+
+
+//
+// 'man_args()' - Get the text arguments for a font macro.
+//
+// Font macros with no arguments apply to the next input line.
+//
+
+static const char *			// O - Text arguments
+man_args(man_state_t *state,		// I - Current man state
+         const char  *args)		// I - Macro arguments
+{
+  const char	*line;			// Next line
+
+
+  if (*args)
+    return (args);
+  else if ((line = man_gets(state->src, &state->linenum)) == NULL)
+    return ("");
+  else
+    return (line);
+}
+
+
+//
+// 'man_break()' - Add the break after a line of text.
+//
+
+static void
+man_break(man_state_t *state)		// I - Current man state
+{
+  if (state->break_line)
+    man_node(state, man_inline(state), MAN_NODE_BREAK);
+  else
+    man_text(state, "\n", 1, false);
+
+  state->break_line = false;
+}
+
+
+//
+// 'man_close()' - Close a man page source.
+//
+
+static void
+man_close(man_source_t *src)		// I - Man page source
+{
+  switch (src->compress)
+  {
+    default :
+        break;
+
+    case MAN_COMPRESS_GZIP :
+        inflateEnd(&src->gz);
+        break;
+
+#ifdef HAVE_BZLIB
+    case MAN_COMPRESS_BZIP2 :
+        BZ2_bzDecompressEnd(&src->bz);
+        break;
+#endif // HAVE_BZLIB
+
+#ifdef HAVE_LZMA
+    case MAN_COMPRESS_XZ :
+        lzma_end(&src->xz);
+        break;
+#endif // HAVE_LZMA
+
+#ifdef HAVE_ZSTD
+    case MAN_COMPRESS_ZSTD :
+        ZSTD_freeDStream(src->zstd);
+        break;
+#endif // HAVE_ZSTD
+  }
+
+  if (src->fd >= 0)
+    close(src->fd);
+
+  free(src->buffer);
+  free(src->inbuf);
+}
+
+
+//
+// 'man_close_block()' - Close the current block, if any.
+//
+
+static void
+man_close_block(man_state_t *state)	// I - Current man state
+{
+  if (state->in_block)
+  {
+    if (man_inline(state))
+      state->block->closed = true;
+
+    state->in_block = NULL;
+  }
+
+  state->block     = NULL;
+  state->container = NULL;
+}
+
+
+//
+// 'man_close_link()' - Close the current link, if any.
+//
+
+static void
+man_close_link(man_state_t *state)	// I - Current man state
+{
+  if (state->in_link)
+  {
+    man_link(state, MAN_LINK_URL, NULL);
+    state->in_link = false;
+  }
+}
+
+
+//
+// 'man_decompress()' - Read decompressed data from a man page source.
+//
+
+static ssize_t				// O - Number of bytes or 0 on end of file, -1 on error
+man_decompress(man_source_t *src,	// I - Man page source
+               char         *buffer,	// I - Buffer
+               size_t       bufsize)	// I - Size of buffer
+{
+  size_t	bytes;			// Bytes decompressed
+
+
+  for (;;)
+  {
+    // Read more compressed data as needed...
+    if (src->inptr >= src->inend && !src->ineof)
+    {
+      ssize_t	inbytes;		// Bytes read
+
+      if ((inbytes = man_read(src, (char *)src->inbuf, src->inbufsize)) < 0)
+        return (-1);
+
+      src->inptr = src->inbuf;
+      src->inend = src->inbuf + inbytes;
+      src->ineof = inbytes == 0;
+    }
+
+    if (src->stream_end)
+    {
+      // At the end of a stream, stop or start the next concatenated one...
+      if (src->inptr >= src->inend)
+        return (0);
+
+      src->stream_end = false;
+
+      if (src->compress == MAN_COMPRESS_GZIP)
+      {
+        inflateReset(&src->gz);
+      }
+#ifdef HAVE_BZLIB
+      else if (src->compress == MAN_COMPRESS_BZIP2)
+      {
+        BZ2_bzDecompressEnd(&src->bz);
+        if (BZ2_bzDecompressInit(&src->bz, 0, 0) != BZ_OK)
+        {
+          src->compress = MAN_COMPRESS_NONE;
+          src->error    = "Unable to initialize bzip2 decompressor";
+          return (-1);
+        }
+      }
+#endif // HAVE_BZLIB
+    }
+
+    // Decompress...
+    switch (src->compress)
+    {
+      default :
+          return (-1);
+
+      case MAN_COMPRESS_GZIP :
+          {
+            int	status;			// Status of decompression
+
+            src->gz.next_in   = src->inptr;
+            src->gz.avail_in  = MAN_AVAIL(src->inend - src->inptr);
+            src->gz.next_out  = (Bytef *)buffer;
+            src->gz.avail_out = MAN_AVAIL(bufsize);
+
+            status = inflate(&src->gz, Z_NO_FLUSH);
+
+            src->inptr = src->gz.next_in;
+            bytes      = (size_t)((char *)src->gz.next_out - buffer);
+
+            if (status == Z_STREAM_END)
+            {
+              src->stream_end = true;
+            }
+            else if (status != Z_OK && status != Z_BUF_ERROR)
+            {
+              src->error = src->gz.msg ? src->gz.msg : "Bad gzip data";
+              return (-1);
+            }
+          }
+          break;
+
+#ifdef HAVE_BZLIB
+      case MAN_COMPRESS_BZIP2 :
+          {
+            int	status;			// Status of decompression
+
+            src->bz.next_in   = (char *)src->inptr;
+            src->bz.avail_in  = MAN_AVAIL(src->inend - src->inptr);
+            src->bz.next_out  = buffer;
+            src->bz.avail_out = MAN_AVAIL(bufsize);
+
+            status = BZ2_bzDecompress(&src->bz);
+
+            src->inptr = (unsigned char *)src->bz.next_in;
+            bytes      = (size_t)(src->bz.next_out - buffer);
+
+            if (status == BZ_STREAM_END)
+            {
+              src->stream_end = true;
+            }
+            else if (status != BZ_OK)
+            {
+              src->error = "Bad bzip2 data";
+              return (-1);
+            }
+          }
+          break;
+#endif // HAVE_BZLIB
+
+#ifdef HAVE_LZMA
+      case MAN_COMPRESS_XZ :
+          {
+            lzma_ret	status;		// Status of decompression
+
+            src->xz.next_in   = src->inptr;
+            src->xz.avail_in  = (size_t)(src->inend - src->inptr);
+            src->xz.next_out  = (uint8_t *)buffer;
+            src->xz.avail_out = bufsize;
+
+            status = lzma_code(&src->xz, src->ineof ? LZMA_FINISH : LZMA_RUN);
+
+            src->inptr = (unsigned char *)src->xz.next_in;
+            bytes      = (size_t)((char *)src->xz.next_out - buffer);
+
+            if (status == LZMA_STREAM_END)
+            {
+              src->stream_end = true;
+            }
+            else if (status != LZMA_OK && status != LZMA_BUF_ERROR)
+            {
+              src->error = "Bad xz data";
+              return (-1);
+            }
+          }
+          break;
+#endif // HAVE_LZMA
+
+#ifdef HAVE_ZSTD
+      case MAN_COMPRESS_ZSTD :
+          {
+            ZSTD_inBuffer  in;		// Input buffer
+            ZSTD_outBuffer out;		// Output buffer
+            size_t	status;		// Status of decompression
+
+            in.src   = src->inptr;
+            in.size  = (size_t)(src->inend - src->inptr);
+            in.pos   = 0;
+            out.dst  = buffer;
+            out.size = bufsize;
+            out.pos  = 0;
+
+            status = ZSTD_decompressStream(src->zstd, &out, &in);
+
+            src->inptr += in.pos;
+            bytes      = out.pos;
+
+            if (ZSTD_isError(status))
+            {
+              src->error = ZSTD_getErrorName(status);
+              return (-1);
+            }
+
+            // A status of 0 means the current frame is complete...
+            if (in.pos > 0 || out.pos > 0)
+              src->stream_end = status == 0;
+          }
+          break;
+#endif // HAVE_ZSTD
+    }
+
+    if (bytes > 0)
+      return ((ssize_t)bytes);
+
+    if (!src->stream_end && src->inptr >= src->inend && src->ineof)
+    {
+      src->error = "Truncated compressed data";
+      return (-1);
+    }
+  }
+}
+
+
+//
+// 'man_depend()' - Add a file used for a cache entry.
+//
+// The file is added as a "MTIME SIZE FILENAME" line for
+// @link _mantohtml_cache_add@.
+//
+
+static bool				// O - `true` on success, `false` if the file is missing
+man_depend(mantohtml_sink_t *deps,	// I - Files used for the cache entry
+           const char       *filename)	// I - Filename
+{
+  struct stat	info;			// File information
+
+
+  if (stat(filename, &info))
+    return (false);
+
+  mantohtml_sink_printf(deps, "%ld %ld %s\n", (long)info.st_mtime, (long)info.st_size, filename);
+
+  return (true);
+}
+
+
+//
+// 'man_fill()' - Read more data into a man page source buffer.
+//
+// Any unread data is moved to the start of the buffer, which grows as needed
+// to hold long lines.
+//
+
+static bool				// O - `true` if more data was read, `false` on EOF
+man_fill(man_source_t *src)		// I - Man page source
+{
+  size_t	used;			// Unread bytes in buffer
+  ssize_t	bytes;			// Bytes read
+
+
+  if (src->eof)
+    return (false);
+
+  // Move unread data to the start of the buffer...
+  used = (size_t)(src->end - src->ptr);
+
+  if (src->ptr > src->buffer)
+  {
+    memmove(src->buffer, src->ptr, used);
+    src->ptr = src->buffer;
+    src->end = src->buffer + used;
+  }
+
+  // Grow the buffer as needed, always leaving room for a nul terminator...
+  if ((used + 1) >= src->bufsize)
+  {
+    char	*buffer;		// New buffer
+
+    if ((buffer = realloc(src->buffer, 2 * src->bufsize)) == NULL)
+    {
+      src->eof = true;
+      return (false);
+    }
+
+    src->buffer  = buffer;
+    src->bufsize *= 2;
+    src->ptr     = buffer;
+    src->end     = buffer + used;
+
+    _MANTOHTML_STATS_ADD(src->growths, 1);
+  }
+
+  // Read more data...
+  if (src->compress == MAN_COMPRESS_NONE)
+    bytes = man_read(src, src->end, src->bufsize - used - 1);
+  else
+    bytes = man_decompress(src, src->end, src->bufsize - used - 1);
+
+  if (bytes <= 0)
+  {
+    src->eof = true;
+    return (false);
+  }
+
+  src->end += bytes;
+
+  return (true);
+}
+
+
+//
+// 'man_find()' - Find a man page source for a .so include.
+//
+// Names are looked up relative to the directory of the current man page and
+// then its parent directory, the usual root for names like "man3/foo.3".
+// Compressed man pages are also found.  The filename is allocated from the
+// document's arena.
+//
+
+static char *				// O - Filename or `NULL` if not found
+man_find(man_state_t *state,		// I - Current man state
+         const char  *name)		// I - Name from .so
+{
+  size_t	i,			// Looping var
+		j;			// Looping var
+  const char	*dirs[2];		// Directories to search
+  size_t	num_dirs;		// Number of directories
+  char		*buffer;		// Filename buffer
+  size_t	bufsize;		// Size of filename buffer
+
+
+  // Room for "BASEPATH/../NAME.EXT"...
+  bufsize = strlen(state->basepath) + strlen(name) + 9;
+
+  if ((buffer = _mantohtml_arena_grow(&state->arena, NULL, 0, bufsize)) == NULL)
+  {
+    state->nomem = true;
+    return (NULL);
+  }
+
+  if (*name == '/')
+  {
+    dirs[0]  = NULL;
+    num_dirs = 1;
+  }
+  else
+  {
+    dirs[0]  = ".";
+    dirs[1]  = "..";
+    num_dirs = 2;
+  }
+
+  for (i = 0; i < num_dirs; i ++)
+  {
+    for (j = 0; j < (sizeof(man_exts) / sizeof(man_exts[0])); j ++)
+    {
+      if (!dirs[i])
+        snprintf(buffer, bufsize, "%s%s", name, man_exts[j]);
+      else if (!strcmp(dirs[i], "."))
+        snprintf(buffer, bufsize, "%s/%s%s", state->basepath, name, man_exts[j]);
+      else
+        snprintf(buffer, bufsize, "%s/../%s%s", state->basepath, name, man_exts[j]);
+
+      if (!access(buffer, 0))
+        return (_mantohtml_arena_grow(&state->arena, buffer, bufsize, strlen(buffer) + 1));
+    }
+  }
+
+  // Release the filename buffer...
+  _mantohtml_arena_grow(&state->arena, buffer, bufsize, 0);
+
+  return (NULL);
+}
+
+
+//
+// 'man_flush()' - Write the HTML for the nodes parsed so far.
+//
+// This is called before starting a new block so that large man pages are
+// written as they are parsed, reusing the arena for the rest of the page.
+// Nothing is written while including a file or when the table of contents
+// needs the whole page.
+//
+
+static bool				// O - `true` on success, `false` on error
+man_flush(man_state_t *state)		// I - Current man state
+{
+  size_t	baselen,		// Length of base path
+		topiclen,		// Length of current topic
+		sectionlen;		// Length of current section
+  char		*saved;			// Saved strings
+
+
+  if (state->depth || state->options.toc || state->nomem)
+    return (true);
+
+  // Close the current block and write the nodes...
+  man_close_link(state);
+  man_close_block(state);
+
+  if (state->nomem)
+    return (true);
+
+  if (state->options.index)
+    man_index(state, state->root.child, state->filename);
+
+  if (!state->nomem && !man_write(state, state->root.child, true))
+    return (false);
+
+  // Save the strings that are still needed and free the nodes...
+  baselen    = strlen(state->basepath);
+  topiclen   = strlen(state->atopic);
+  sectionlen = strlen(state->asection);
+
+  if ((saved = malloc(baselen + topiclen + sectionlen + 3)) == NULL)
+  {
+    state->nomem = true;
+    return (true);
+  }
+
+  memcpy(saved, state->basepath, baselen + 1);
+  memcpy(saved + baselen + 1, state->atopic, topiclen + 1);
+  memcpy(saved + baselen + topiclen + 2, state->asection, sectionlen + 1);
+
+  _mantohtml_arena_reset(&state->arena);
+
+  state->root.child = state->root.last_child = NULL;
+  state->block      = state->container = NULL;
+  state->num_nodes  = 0;
+
+  if ((state->basepath = _mantohtml_arena_strdup(&state->arena, saved, baselen)) == NULL || (state->atopic = _mantohtml_arena_strdup(&state->arena, saved + baselen + 1, topiclen)) == NULL || (state->asection = _mantohtml_arena_strdup(&state->arena, saved + baselen + topiclen + 2, sectionlen)) == NULL)
+  {
+    state->basepath = ".";
+    state->atopic   = "";
+    state->asection = "";
+    state->nomem    = true;
+  }
+
+  free(saved);
+
+  return (true);
+}
+
+
+//
+// 'man_font()' - Change the current font.
+//
+
+static void
+man_font(man_state_t *state,		// I - Current man state
+         man_font_t  font)		// I - New font
+{
+  man_node_t	*node;			// Font node
+  man_font_t	from = state->font;	// Previous font
+
+
+  // No-op if the fonts are the same...
+  if (state->font == font && state->in_block)
+    return;
+
+  if (!state->in_block)
+  {
+    // Close prior font before starting a new paragraph...
+    if (from && (node = man_node(state, man_inline(state), MAN_NODE_FONT)) != NULL)
+      node->from = from;
+
+    man_open_block(state, MAN_BLOCK_IMPLICIT, NULL);
+    from = MAN_FONT_REGULAR;
+  }
+
+  if ((from || font) && (node = man_node(state, man_inline(state), MAN_NODE_FONT)) != NULL)
+  {
+    node->from  = from;
+    node->value = font;
+  }
+
+  // Save the new font...
+  state->font = font;
+}
+
+
+//
+// 'man_footer()' - Write the footer for the current output.
+//
+
+static void
+man_footer(man_state_t *state)		// I - Current man state
+{
+  switch (state->format)
+  {
+    case MANTOHTML_FORMAT_HTML :
+    case MANTOHTML_FORMAT_FRAGMENT :
+        html_footer(state);
+        break;
+
+    case MANTOHTML_FORMAT_JSON :
+        if (state->wrote_header)
+          mantohtml_sink_puts(state->out, "\n]}\n");
+        break;
+
+    case MANTOHTML_FORMAT_TEXT :
+        text_sep(state, 1);
+        break;
+  }
+}
+
+
+//
+// 'man_gets()' - Get a line from a man page source.
+//
+// Lines are returned in place in the source buffer.  Continuation lines and
+// comments are spliced out by moving the rest of the line down, so most lines
+// are neither copied nor scanned one character at a time.
+//
+
+static char *				// O  - Line or `NULL` on EOF
+man_gets(man_source_t *src,		// I  - Man page source
+         int          *linenum)		// IO - Line number
+{
+  char	*line,				// Start of line
+	*lineend,			// End of current physical line
+	*start,				// Start of current fragment
+	*find,				// Where to look for the next backslash
+	*bs,				// Backslash in line
+	*out;				// End of (spliced) line
+  _MANTOHTML_STATS_START(start_time);	// Start time
+
+
+  if (src->ptr >= src->end && !man_fill(src))
+  {
+    _MANTOHTML_STATS_END(src->gets_time, start_time);
+    return (NULL);
+  }
+
+  line = start = out = src->ptr;
+
+  for (;;)
+  {
+    // Find the end of the current physical line...
+    while ((lineend = memchr(start, '\n', (size_t)(src->end - start))) == NULL)
+    {
+      size_t	startoff = (size_t)(start - line),
+					// Offset of current fragment
+		outoff = (size_t)(out - line);
+					// Offset of end of line
+
+      bool	filled = man_fill(src);	// Was more data read?
+
+      // The line may have moved even when there is no more data...
+      line  = src->ptr;
+      start = line + startoff;
+      out   = line + outoff;
+
+      if (!filled)
+      {
+        // Last line has no newline...
+        lineend = src->end;
+        break;
+      }
+    }
+
+    // Look for \" (comment) and \LF (continuation)...
+    for (find = start; (bs = memchr(find, '\\', (size_t)(lineend - find))) != NULL; find = bs + 2)
+    {
+      if ((bs + 1) >= lineend || bs[1] == '\"')
+        break;
+    }
+
+    if (!bs)
+      bs = lineend;
+
+    // Add the current fragment to the line...
+    if (out != start)
+      memmove(out, start, (size_t)(bs - start));
+
+    out += bs - start;
+
+    if (bs < lineend && bs[1] == '\"')
+    {
+      // Comment, skip the rest of the physical line...
+      break;
+    }
+    else if (bs < lineend && lineend < src->end)
+    {
+      // Continuation, append the next physical line...
+      *linenum += 1;
+      start = lineend + 1;
+      continue;
+    }
+
+    break;
+  }
+
+  // Terminate the line and advance to the next one...
+  if (lineend < src->end)
+  {
+    *linenum += 1;
+    src->ptr = lineend + 1;
+  }
+  else
+  {
+    src->ptr = lineend;
+  }
+
+  *out = '\0';
+
+  _MANTOHTML_STATS_END(src->gets_time, start_time);
+
+  return (line);
+}
+
+
+//
+// 'man_glyph()' - Look up the HTML text for a special character.
+//
+
+static const char *			// O - HTML text or `NULL` if unknown
+man_glyph(const char *name,		// I - Name of special character
+          size_t     namelen)		// I - Length of name
+{
+  if (namelen == 2)
+  {
+    // Two character names are looked up in the hash table...
+    unsigned	key = MAN_GLYPH(name[0], name[1]),
+					// Packed name
+		hash;			// Current slot
+
+    for (hash = MAN_GLYPH_HASH(key); man_glyphs[hash].key; hash = (hash + 1) & (MAN_GLYPH_SIZE - 1))
+    {
+      if (man_glyphs[hash].key == key)
+        return (man_glyphs[hash].html);
+    }
+  }
+  else if (namelen > 2)
+  {
+    // Longer names are looked up with a binary search...
+    size_t	left = 0,		// Left side of search
+		right = sizeof(man_lglyphs) / sizeof(man_lglyphs[0]),
+					// Right side of search
+		current;		// Current entry
+    int		result;			// Result of comparison
+
+    while (left < right)
+    {
+      current = (left + right) / 2;
+
+      if ((result = strncmp(name, man_lglyphs[current].name, namelen)) == 0 && man_lglyphs[current].name[namelen])
+        result = -1;
+
+      if (result == 0)
+        return (man_lglyphs[current].html);
+      else if (result < 0)
+        right = current;
+      else
+        left = current + 1;
+    }
+  }
+
+  return (NULL);
+}
+
+
+//
+// 'man_heading()' - Add a heading.
+//
+// The capitalized title and the heading ID are made in a single pass over the
+// heading text.
+//
+
+static void
+man_heading(man_state_t   *state,	// I - Current man state
+            man_heading_t heading,	// I - Heading level
+            const char    *s)		// I - Heading text
+{
+  char		*title,			// Heading title string
+		*titleptr,		// Pointer into heading title
+		*id,			// Heading ID
+		*anchor,		// Heading anchor in ID
+		*ptr;			// Pointer into anchor
+  const char	*start = s,		// Start of heading text
+		*word = NULL,		// Start of current word
+		*escend = s;		// End of current escape
+  size_t	len = strlen(s),	// Length of heading text
+		topiclen = 0,		// Length of topic anchor
+		sectionlen = 0,		// Length of section anchor
+		prefixlen = 0;		// Length of ID before the anchor
+  int		ch,			// Current character
+		special = 0;		// Character classes in heading text
+  bool		capitalize = heading > MAN_HEADING_TOPIC;
+					// Capitalize the words in the title?
+  man_node_t	*node;			// Heading node
+
+
+  // The heading ID is "TOPIC", "TOPIC.SECTION", or "TOPIC.SECTION.SUBSECTION"
+  // and follows the title in the same arena allocation...
+  if (heading > MAN_HEADING_TOPIC)
+  {
+    topiclen  = strlen(state->atopic);
+    prefixlen = topiclen + 1;
+  }
+
+  if (heading > MAN_HEADING_SECTION)
+  {
+    sectionlen = strlen(state->asection);
+    prefixlen  += sectionlen + 1;
+  }
+
+  if ((title = _mantohtml_arena_grow(&state->arena, NULL, 0, 2 * len + prefixlen + 2)) == NULL)
+  {
+    state->nomem = true;
+    return;
+  }
+
+  id = title + len + 1;
+
+  if (heading > MAN_HEADING_TOPIC)
+  {
+    memcpy(id, state->atopic, topiclen);
+    id[topiclen] = '.';
+  }
+
+  if (heading > MAN_HEADING_SECTION)
+  {
+    memcpy(id + topiclen + 1, state->asection, sectionlen);
+    id[topiclen + sectionlen + 1] = '.';
+  }
+
+  anchor = id + prefixlen;
+
+  for (titleptr = title, ptr = anchor;; s ++, titleptr ++)
+  {
+    ch      = *s;
+    special |= MAN_CLASS(ch, MAN_CHAR_ENTITY | MAN_CHAR_MAN);
+
+    if (word && !MAN_ALPHA(ch))
+    {
+      // End of a word, which is capitalized unless it is "a", "and", "or", or
+      // "the" after the first word...
+      size_t wordlen = (size_t)(s - word);
+					// Length of word
+
+      if (word > start && ch == ' ' && ((wordlen == 1 && *word == 'a') || (wordlen == 2 && !memcmp(word, "or", 2)) || (wordlen == 3 && (!memcmp(word, "and", 3) || !memcmp(word, "the", 3)))))
+        title[word - start] = *word;
+
+      word = NULL;
+    }
+
+    if (!ch)
+      break;
+
+    // Add the character to the anchor, with a "-" for "(" and whitespace...
+    if (MAN_CLASS(ch, MAN_CHAR_ANCHOR))
+      *ptr++ = (char)(ch | 0x20);
+    else if ((ch == '(' || ch == ' ' || ch == '\t') && s[1] && ptr > anchor && ptr[-1] != '-')
+      *ptr++ = '-';
+
+    // Then to the title, keeping the case of escapes such as "\(lq" so that
+    // they are still recognized...
+    if (capitalize && ch == '\\' && s >= escend)
+    {
+      man_lex_t		lex;		// Lexer
+      const char	*escstart;	// Start of escape
+
+      lex.s          = s;
+      lex.end        = start + len;
+      lex.next       = MAN_TOKEN_END;
+      lex.next_start = NULL;
+      lex.next_end   = NULL;
+
+      man_lex(&lex, &escstart, &escend);
+    }
+
+    if (capitalize && s >= escend && MAN_ALPHA(ch))
+    {
+      if (word)
+      {
+        *titleptr = (char)(ch | 0x20);
+      }
+      else
+      {
+        *titleptr = (char)(ch & ~0x20);
+        word      = s;
+      }
+    }
+    else
+    {
+      *titleptr = (char)ch;
+    }
+  }
+
+  *titleptr = '\0';
+  *ptr++    = '\0';
+
+  // Release the unused memory...
+  _mantohtml_arena_grow(&state->arena, title, 2 * len + prefixlen + 2, (size_t)(ptr - title));
+
+  switch (heading)
+  {
+    case MAN_HEADING_TOPIC :
+        state->atopic = id;
+        break;
+
+    case MAN_HEADING_SECTION :
+        state->asection = anchor;
+        break;
+
+    default :
+        break;
+  }
+
+  // Close current elements...
+  man_close_link(state);
+  man_close_block(state);
+
+  if ((node = man_node(state, state->parent, MAN_NODE_HEADING)) == NULL)
+    return;
+
+  node->value = heading;
+  node->text  = id;
+
+  // The heading text is a child of the heading.  Font changes in the heading
+  // stay inside it instead of starting a paragraph, and end with it...
+  state->parent   = state->container = node;
+  state->in_block = "";
+  state->font     = MAN_FONT_REGULAR;
+
+  if (special)
+    man_putn(state, title, len);
+  else
+    man_text(state, title, len, false);
+
+  man_font(state, MAN_FONT_REGULAR);
+
+  state->parent    = &state->root;
+  state->in_block  = NULL;
+  state->block     = NULL;
+  state->container = NULL;
+}
+
+
+//
+// 'man_html()' - Add HTML markup.
+//
+// The markup string is not copied and must be a constant.
+//
+
+static void
+man_html(man_state_t *state,		// I - Current man state
+         const char  *html)		// I - HTML markup
+{
+  man_node_t	*node;			// HTML node
+
+
+  if ((node = man_node(state, man_inline(state), MAN_NODE_HTML)) != NULL)
+  {
+    node->text    = html;
+    node->textlen = strlen(html);
+  }
+}
+
+
+//
+// 'man_htmlf()' - Add formatted HTML markup.
+//
+
+static void
+man_htmlf(man_state_t *state,		// I - Current man state
+          const char  *format,		// I - Printf-style format string
+          ...)				// I - Additional arguments as needed
+{
+  va_list	ap;			// Pointer to additional arguments
+  char		html[256];		// HTML markup
+  int		len;			// Length of HTML markup
+  man_node_t	*node;			// HTML node
+
+
+  va_start(ap, format);
+  len = vsnprintf(html, sizeof(html), format, ap);
+  va_end(ap);
+
+  if (len < 0 || (size_t)len >= sizeof(html))
+    return;
+
+  if ((node = man_node(state, man_inline(state), MAN_NODE_HTML)) != NULL)
+  {
+    if ((node->text = _mantohtml_arena_strdup(&state->arena, html, (size_t)len)) == NULL)
+      state->nomem = true;
+    else
+      node->textlen = (size_t)len;
+  }
+}
+
+
+//
+// 'man_include()' - Convert an included man page source.
+//
+// When an include cache is used and nothing has been written for the
+// current man page yet, which is the case for the usual ".so man3/foo.3"
+// alias pages, the HTML for the new nodes and the resulting state are cached
+// so that other aliases (in any document using the cache) need not read and
+// convert it again.
+//
+
+static bool				// O - `true` on success, `false` on error
+man_include(man_state_t *state,		// I - Current man state
+            const char  *filename)	// I - Filename of included file
+{
+  man_source_t	src;			// Included source
+  bool		ret;			// Return value
+  char		key[4096],		// Include cache key
+		files[4096];		// Included file for the cache
+  const man_cached_t *cached;		// Cached include
+  size_t	cachedlen;		// Length of cached include
+  mantohtml_sink_t *includes = NULL;	// Original included filenames
+  man_node_t	*last = NULL,		// Last node before include
+		*node;			// Cached HTML node
+  bool		had_header = state->wrote_header;
+					// Was the HTML header written before the include?
+
+
+  if (state->options.cache && !state->th_seen && !state->in_block && !state->in_link && !state->indent && state->font == MAN_FONT_REGULAR && state->format <= MANTOHTML_FORMAT_FRAGMENT && !state->num_outputs)
+  {
+    // Build the key for the include cache, and save the file's modification
+    // time and size so that changes are seen by long-running programs...
+    const char	*nil = "\1";		// Marker for NULL options
+    struct stat	info;			// Include file information
+
+    if (stat(filename, &info) || snprintf(files, sizeof(files), "%ld %ld %s\n", (long)info.st_mtime, (long)info.st_size, filename) >= (int)sizeof(files))
+      key[0] = '\0';
+    else if (snprintf(key, sizeof(key), "%d\n%d\n%s\n%s\n%s\n%s\n%s\n%s\n%d\n%s\n%s\n%s\n%p\n%s\n%d\n%d", state->format, state->wrote_header, filename, state->basepath, state->options.author ? state->options.author : nil, state->options.chapter ? state->options.chapter : nil, state->options.copyright ? state->options.copyright : nil, state->options.css ? state->options.css : nil, state->options.css_link, state->options.subject ? state->options.subject : nil, state->options.suffix, state->options.title ? state->options.title : nil, (void *)state->options.index, state->options.index_prefix ? state->options.index_prefix : nil, state->options.toc, state->options.compact) >= (int)sizeof(key))
+      key[0] = '\0';
+  }
+  else
+  {
+    key[0] = '\0';
+  }
+
+  if (key[0] && (cached = _mantohtml_cache_find(state->options.cache, key, &state->arena, &cachedlen)) != NULL)
+  {
+    // Use the cached HTML and state...
+    const char	*data = (const char *)(cached + 1);
+					// Included filenames and HTML
+    const char	*dataptr,		// Pointer into included filenames
+		*dataend,		// End of current included filename
+		*id,			// Anchor ID
+		*title;			// Anchor title
+    char	*temp;			// Included filename
+    man_node_t	*child;			// Anchor title node
+
+    state->wrote_header = cached->wrote_header;
+    state->in_link      = cached->in_link;
+    state->th_seen      = cached->th_seen;
+    state->warning      = cached->warning;
+    state->in_block     = cached->in_block;
+    state->indent       = cached->indent;
+    state->font         = cached->font;
+    state->break_line   = cached->break_line;
+    state->atopic       = data + cached->includes_len + cached->html_len + cached->anchors_len;
+    state->asection     = state->atopic + cached->atopic_len + 1;
+
+    man_included(state, filename);
+
+    for (dataptr = data; dataptr < (data + cached->includes_len); dataptr = dataend + 1)
+    {
+      dataend = memchr(dataptr, '\n', (size_t)(data + cached->includes_len - dataptr));
+
+      if ((temp = _mantohtml_arena_strdup(&state->arena, dataptr, (size_t)(dataend - dataptr))) == NULL)
+      {
+        state->nomem = true;
+        return (true);
+      }
+
+      man_included(state, temp);
+    }
+
+    // The cached HTML is added as a single node, with any following content in
+    // a new block...
+    state->block     = NULL;
+    state->container = NULL;
+
+    if ((node = man_node(state, state->parent, MAN_NODE_HTML)) != NULL)
+    {
+      node->text    = data + cached->includes_len;
+      node->textlen = cached->html_len;
+    }
+
+    // Followed by the headings for the index...
+    for (dataptr = data + cached->includes_len + cached->html_len, dataend = dataptr + cached->anchors_len; dataptr < dataend; dataptr = title + strlen(title) + 1)
+    {
+      id    = dataptr + 1;
+      title = id + strlen(id) + 1;
+
+      if ((node = man_node(state, state->parent, MAN_NODE_ANCHOR)) != NULL && (child = man_node(state, node, MAN_NODE_HTML)) != NULL)
+      {
+        node->value    = *dataptr - '0';
+        node->text     = id;
+        node->textlen  = strlen(id);
+        child->text    = title;
+        child->textlen = strlen(title);
+      }
+    }
+
+    return (true);
+  }
+
+  if (!man_open_file(&src, filename))
+  {
+    man_message(state, "mantohtml: Unable to open '%s': %s\n", filename, strerror(errno));
+    return (false);
+  }
+
+  man_included(state, filename);
+
+  if (key[0])
+  {
+    // Capture the new nodes and included filenames for the cache...
+    includes = state->includes;
+
+    if ((state->includes = mantohtml_sink_new_memory()) == NULL)
+    {
+      state->includes = includes;
+      key[0]          = '\0';
+    }
+    else
+    {
+      last             = state->root.last_child;
+      state->block     = NULL;
+      state->container = NULL;
+    }
+  }
+
+  state->depth ++;
+  ret = convert_lines(state, filename, &src);
+  state->depth --;
+
+  man_close(&src);
+
+  if (key[0])
+  {
+    // Write the HTML for the new nodes and add it to the cache...
+    const char	*html = NULL,		// HTML output
+		*names,			// Included filenames
+		*anchors = "",		// Anchors for the index
+		*title;			// Anchor title
+    size_t	htmllen,		// Length of HTML output
+		nameslen,		// Length of included filenames
+		anchorslen = 0,		// Length of anchors
+		atopiclen,		// Length of current topic
+		asectionlen,		// Length of current section
+		entrylen;		// Length of cache entry
+    man_cached_t *entry;		// New cache entry
+    mantohtml_sink_t *out = state->out,	// Original output sink
+		*asink = NULL,		// Anchors for the index
+		*deps = NULL;		// Files used for the cache entry
+    man_node_t	*first = last ? last->next : state->root.child;
+					// First new node
+
+    names = mantohtml_sink_get_buffer(state->includes, &nameslen);
+
+    if (names && includes)
+      mantohtml_sink_write(includes, names, nameslen);
+
+    if (ret && !state->nomem && state->options.index)
+      man_index(state, first, NULL);
+
+    if (ret && !state->nomem && (state->out = mantohtml_sink_new_memory()) != NULL)
+    {
+      // Compact HTML for the cache starts and ends with all font changes
+      // written...
+      man_font_t out_font = state->out_font,
+					// Current font in the HTML output
+		text_font = state->text_font;
+					// Font for the next text
+
+      state->out_font = state->text_font = MAN_FONT_REGULAR;
+
+      if (html_node(state, first))
+      {
+        if (state->options.compact)
+          html_font_sync(state, state->text_font);
+
+        html = mantohtml_sink_get_buffer(state->out, &htmllen);
+      }
+
+      state->out_font  = out_font;
+      state->text_font = text_font;
+    }
+
+    if (html && state->options.index)
+    {
+      // Save the headings as "LEVEL ID nul TITLE nul" for the index...
+      if ((asink = mantohtml_sink_new_memory()) != NULL)
+      {
+        for (node = first; node; node = node->next)
+        {
+          if ((node->type == MAN_NODE_HEADING || node->type == MAN_NODE_ANCHOR) && (title = man_title(state, node)) != NULL)
+          {
+            mantohtml_sink_printf(asink, "%d%s", node->value, node->text);
+            mantohtml_sink_putc(asink, '\0');
+            mantohtml_sink_puts(asink, title);
+            mantohtml_sink_putc(asink, '\0');
+          }
+        }
+      }
+
+      if (state->nomem || (anchors = asink ? mantohtml_sink_get_buffer(asink, &anchorslen) : NULL) == NULL)
+        html = NULL;
+    }
+
+    if (html && names && (deps = mantohtml_sink_new_memory()) != NULL)
+    {
+      // The HTML also depends on the files it includes and the stylesheet in
+      // the header, so check those for changes too...
+      const char	*nameptr,	// Pointer into included filenames
+			*nameend;	// End of current filename
+      char		depname[4096];	// Current filename
+
+      mantohtml_sink_puts(deps, files);
+
+      for (nameptr = names; html && nameptr < (names + nameslen); nameptr = nameend + 1)
+      {
+        if ((nameend = memchr(nameptr, '\n', (size_t)(names + nameslen - nameptr))) == NULL || (size_t)(nameend - nameptr) >= sizeof(depname))
+        {
+          html = NULL;
+          break;
+        }
+
+        memcpy(depname, nameptr, (size_t)(nameend - nameptr));
+        depname[nameend - nameptr] = '\0';
+
+        if (!man_depend(deps, depname))
+          html = NULL;
+      }
+
+      if (html && !had_header && state->wrote_header && state->options.css && !state->options.css_link && strncmp(state->options.css, "http://", 7) && strncmp(state->options.css, "https://", 8) && !man_depend(deps, state->options.css))
+        html = NULL;
+
+      mantohtml_sink_putc(deps, '\0');
+    }
+
+    atopiclen   = strlen(state->atopic);
+    asectionlen = strlen(state->asection);
+    entrylen    = sizeof(man_cached_t) + nameslen + htmllen + anchorslen + atopiclen + asectionlen + 2;
+
+    if (html && names && deps && mantohtml_sink_get_buffer(deps, NULL) && (entry = calloc(1, entrylen)) != NULL)
+    {
+      entry->wrote_header = state->wrote_header;
+      entry->in_link      = state->in_link;
+      entry->th_seen      = state->th_seen;
+      entry->warning      = state->warning;
+      entry->in_block     = state->in_block;
+      entry->indent       = state->indent;
+      entry->font         = state->font;
+      entry->break_line   = state->break_line;
+      entry->includes_len = nameslen;
+      entry->html_len     = htmllen;
+      entry->anchors_len  = anchorslen;
+      entry->atopic_len   = atopiclen;
+      entry->asection_len = asectionlen;
+
+      memcpy(entry + 1, names, nameslen);
+      memcpy((char *)(entry + 1) + nameslen, html, htmllen);
+      memcpy((char *)(entry + 1) + nameslen + htmllen, anchors, anchorslen);
+      memcpy((char *)(entry + 1) + nameslen + htmllen + anchorslen, state->atopic, atopiclen + 1);
+      memcpy((char *)(entry + 1) + nameslen + htmllen + anchorslen + atopiclen + 1, state->asection, asectionlen + 1);
+
+      _mantohtml_cache_add(state->options.cache, key, mantohtml_sink_get_buffer(deps, NULL), entry, entrylen);
+      free(entry);
+    }
+
+    mantohtml_sink_delete(deps);
+
+    if (state->out != out)
+      mantohtml_sink_delete(state->out);
+
+    mantohtml_sink_delete(asink);
+
+    mantohtml_sink_delete(state->includes);
+
+    state->out      = out;
+    state->includes = includes;
+  }
+
+  return (ret);
+}
+
+
+//
+// 'man_included()' - Report a file used by the current man page.
+//
+
+static void
+man_included(man_state_t *state,	// I - Current man state
+             const char  *filename)	// I - Filename of included file
+{
+  if (state->options.include_cb)
+    (state->options.include_cb)(state->options.include_cbdata, filename);
+
+  if (state->includes)
+    mantohtml_sink_printf(state->includes, "%s\n", filename);
+}
+
+
+//
+// 'man_index()' - Link references to other man pages and add anchors to the index.
+//
+// Anchors are only added when a filename is provided.
+//
+
+static void
+man_index(man_state_t *state,		// I - Current man state
+          man_node_t  *node,		// I - First node
+          const char  *filename)	// I - Man filename or `NULL` for links only
+{
+  bool		in_link = false;	// Are we in a link?
+  const char	*title;			// Heading title
+
+
+  for (; node && !state->nomem; node = node->next)
+  {
+    if (node->type == MAN_NODE_BLOCK)
+    {
+      man_xref(state, node, &in_link);
+    }
+    else if ((node->type == MAN_NODE_HEADING || node->type == MAN_NODE_ANCHOR) && filename)
+    {
+      if ((title = man_title(state, node)) != NULL && !_mantohtml_index_add_anchor(state->options.index, filename, node->value, node->text, title))
+        state->nomem = true;
+    }
+  }
+}
+
+
+//
+// 'man_inline()' - Get the node for inline content.
+//
+// When there is no current block, e.g., after a heading or a cached include,
+// a continuation block is started so the open block (if any) is closed
+// correctly.
+//
+
+static man_node_t *			// O - Node or `NULL` on error
+man_inline(man_state_t *state)		// I - Current man state
+{
+  if (!state->container && (state->container = man_node(state, state->parent, MAN_NODE_BLOCK)) != NULL)
+  {
+    state->container->elem = state->in_block;
+    state->block           = state->container;
+  }
+
+  return (state->container);
+}
+
+
+//
+// 'man_insert()' - Insert a node after another node.
+//
+// Pass `NULL` for the previous node to insert the node as the first child.
+//
+
+static man_node_t *			// O - New node or `NULL` on error
+man_insert(man_state_t     *state,	// I - Current man state
+           man_node_t      *parent,	// I - Parent node
+           man_node_t      *after,	// I - Previous node or `NULL`
+           man_node_type_t type)	// I - Node type
+{
+  man_node_t	*node;			// New node
+
+
+  if ((node = _mantohtml_arena_alloc(&state->arena, sizeof(man_node_t))) == NULL)
+  {
+    state->nomem = true;
+    return (NULL);
+  }
+
+  node->type = type;
+
+  if (after)
+  {
+    node->next  = after->next;
+    after->next = node;
+  }
+  else
+  {
+    node->next    = parent->child;
+    parent->child = node;
+  }
+
+  if (parent->last_child == after)
+    parent->last_child = node;
+
+  return (node);
+}
+
+
+//
+// 'man_lex()' - Get the next token in man text.
+//
+// The text is scanned once from start to end.  A URL is found at the ":"
+// after its scheme, so the text before the URL is returned first and the URL
+// is kept as the lookahead token.
+//
+
+static man_token_t			// O - Token or `MAN_TOKEN_END` at the end of the text
+man_lex(man_lex_t  *lex,		// I - Lexer
+        const char **start,		// O - Start of token
+        const char **end)		// O - End of token
+{
+  const char	*s = lex->s,		// Pointer into text
+		*lexend = lex->end,	// End of text
+		*url;			// Start of URL
+  man_token_t	token;			// Token
+
+
+  if (lex->next != MAN_TOKEN_END)
+  {
+    // Return the lookahead token...
+    token     = lex->next;
+    *start    = lex->next_start;
+    *end      = lex->s = lex->next_end;
+    lex->next = MAN_TOKEN_END;
+
+    return (token);
+  }
+
+  *start = s;
+
+  if (s >= lexend)
+  {
+    *end = s;
+    return (MAN_TOKEN_END);
+  }
+  else if (*s == '\\' && (s + 1) < lexend)
+  {
+    // Escape, find the end of the sequence...
+    const char	*name = s + 2,		// Name of font, string, or character
+		*nameend;		// End of name
+
+    token = MAN_TOKEN_CHAR;
+
+    if (s[1] == 'f' && name < lexend)
+    {
+      token = MAN_TOKEN_FONT;
+      s     = name + 1;
+    }
+    else if (s[1] == '*' && name < lexend)
+    {
+      if (*name == '(')
+        s = (lexend - name) >= 3 ? name + 3 : name + 1;
+      else if (*name == 'R' || (name + 1) >= lexend)
+        s = name + 1;
+      else
+        s = name + 2;
+    }
+    else if (s[1] == '(' && (lexend - s) >= 4)
+    {
+      s += 4;
+    }
+    else if (s[1] == '[' && (nameend = memchr(name, ']', (size_t)(lexend - name))) != NULL)
+    {
+      s = nameend + 1;
+    }
+    else if ((lexend - s) >= 4 && isdigit(s[1] & 255) && isdigit(s[2] & 255) && isdigit(s[3] & 255))
+    {
+      s += 4;
+    }
+    else
+    {
+      token = MAN_TOKEN_ESCAPE;
+      s     += 2;
+    }
+
+    *end = lex->s = s;
+
+    return (token);
+  }
+  else if (MAN_CLASS(*s, MAN_CHAR_ENTITY))
+  {
+    *end = lex->s = s + 1;
+
+    return (MAN_TOKEN_ENTITY);
+  }
+
+  // Plain text, up to the next escape, HTML special character, or URL...
+  while ((s = scan_man(s, lexend)) < lexend)
+  {
+    if ((*s == '\\' && (s + 1) < lexend) || MAN_CLASS(*s, MAN_CHAR_ENTITY))
+      break;
+
+    if (*s == ':' && (url = man_scheme(*start, s, lexend)) != NULL)
+    {
+      // The URL ends with the word, trailing punctuation, a character that
+      // cannot be in a URL, or an escape other than a quoted character...
+      for (; s < lexend && !MAN_CLASS(*s, MAN_CHAR_SPACE); s ++)
+      {
+        if (MAN_CLASS(*s, MAN_CHAR_URLPUNCT) && ((s + 1) >= lexend || MAN_CLASS(s[1], MAN_CHAR_URLEND)))
+          break;
+        else if (*s == '\"' || *s == '<' || *s == '>')
+          break;
+        else if (*s == '\\')
+        {
+          if ((s + 1) >= lexend || !ispunct(s[1] & 255) || s[1] == '(' || s[1] == '*' || s[1] == '[')
+            break;
+
+          s ++;
+        }
+      }
+
+      if (url == *start)
+      {
+        *end = lex->s = s;
+        return (MAN_TOKEN_URL);
+      }
+
+      lex->next       = MAN_TOKEN_URL;
+      lex->next_start = url;
+      lex->next_end   = s;
+
+      *end = url;
+
+      return (MAN_TOKEN_TEXT);
+    }
+
+    s ++;
+  }
+
+  *end = lex->s = s;
+
+  return (MAN_TOKEN_TEXT);
+}
+
+
+//
+// 'man_link()' - Start or end a link.
+//
+// Pass `NULL` for the URL to end the current link.
+//
+
+static void
+man_link(man_state_t *state,		// I - Current man state
+         man_link_t  link,		// I - Kind of link
+         const char  *url)		// I - URL, email address, or man page name, `NULL` to end link
+{
+  man_node_t	*node;			// Link node
+
+
+  if ((node = man_node(state, man_inline(state), url ? MAN_NODE_LINK : MAN_NODE_LINK_END)) != NULL)
+  {
+    node->value = link;
+    node->text  = url;
+  }
+}
+
+
+//
+// 'man_macro()' - Look up the function for a macro.
+//
+// Macro names are one or two characters, so the name is packed into an
+// integer and dispatched with a single switch.  Longer names are not
+// supported and return `NULL`.
+//
+
+static man_macro_cb_t			// O - Macro function or `NULL` if unsupported
+man_macro(const char *name)		// I - Macro name, including the leading "."
+{
+  int	key;				// Packed macro name
+
+
+  if (!name[1] || (name[2] && name[3]))
+    return (NULL);
+
+  key = MAN_MACRO(name[1], name[2]);
+
+  switch (key)
+  {
+    case MAN_MACRO('B', 0) :
+        return (macro_B);
+    case MAN_MACRO('B', 'I') :
+        return (macro_BI);
+    case MAN_MACRO('B', 'R') :
+        return (macro_BR);
+    case MAN_MACRO('E', 'E') :
+    case MAN_MACRO('f', 'i') :
+        return (macro_EE);
+    case MAN_MACRO('E', 'X') :
+    case MAN_MACRO('n', 'f') :
+        return (macro_EX);
+    case MAN_MACRO('H', 'P') :
+        return (macro_HP);
+    case MAN_MACRO('I', 0) :
+        return (macro_I);
+    case MAN_MACRO('I', 'B') :
+        return (macro_IB);
+    case MAN_MACRO('I', 'P') :
+        return (macro_IP);
+    case MAN_MACRO('I', 'R') :
+        return (macro_IR);
+    case MAN_MACRO('L', 'P') :
+    case MAN_MACRO('P', 0) :
+    case MAN_MACRO('P', 'P') :
+        return (macro_LP);
+    case MAN_MACRO('M', 'E') :
+    case MAN_MACRO('U', 'E') :
+        return (macro_ME);
+    case MAN_MACRO('M', 'T') :
+        return (macro_MT);
+    case MAN_MACRO('R', 'B') :
+        return (macro_RB);
+    case MAN_MACRO('R', 'E') :
+        return (macro_RE);
+    case MAN_MACRO('R', 'S') :
+        return (macro_RS);
+    case MAN_MACRO('S', 'B') :
+        return (macro_SB);
+    case MAN_MACRO('S', 'H') :
+        return (macro_SH);
+    case MAN_MACRO('S', 'M') :
+        return (macro_SM);
+    case MAN_MACRO('S', 'S') :
+        return (macro_SS);
+    case MAN_MACRO('S', 'Y') :
+        return (macro_SY);
+    case MAN_MACRO('T', 'H') :
+        return (macro_TH);
+    case MAN_MACRO('T', 'P') :
+        return (macro_TP);
+    case MAN_MACRO('U', 'R') :
+        return (macro_UR);
+    case MAN_MACRO('Y', 'S') :
+        return (macro_YS);
+    case MAN_MACRO('b', 'r') :
+        return (macro_br);
+    case MAN_MACRO('i', 'n') :
+        return (macro_in);
+    case MAN_MACRO('s', 'o') :
+        return (macro_so);
+    case MAN_MACRO('s', 'p') :
+        return (macro_sp);
+    default :
+        return (NULL);
+  }
+}
+
+
+//
+// 'man_message()' - Show a diagnostic message.
+//
+// Messages are written to the standard error unless the state is collecting
+// them for a section that is converted in parallel.
+//
+
+static void
+man_message(man_state_t *state,		// I - Current man state
+            const char  *format,	// I - Printf-style format string
+            ...)			// I - Additional arguments as needed
+{
+  va_list	ap;			// Pointer to additional arguments
+  char		buffer[1024];		// Message buffer
+  int		len;			// Length of message
+
+
+  va_start(ap, format);
+  len = vsnprintf(buffer, sizeof(buffer), format, ap);
+  va_end(ap);
+
+  if (len < 0)
+    return;
+  else if ((size_t)len >= sizeof(buffer))
+    len = (int)sizeof(buffer) - 1;
+
+  if (state->messages)
+    mantohtml_sink_write(state->messages, buffer, (size_t)len);
+  else
+    fwrite(buffer, 1, (size_t)len, stderr);
+}
+
+
+//
+// 'man_node()' - Add a node.
+//
+
+static man_node_t *			// O - New node or `NULL` on error
+man_node(man_state_t     *state,	// I - Current man state
+         man_node_t      *parent,	// I - Parent node
+         man_node_type_t type)		// I - Node type
+{
+  man_node_t	*node;			// New node
+
+
+  if (!parent || (node = _mantohtml_arena_alloc(&state->arena, sizeof(man_node_t))) == NULL)
+  {
+    state->nomem = true;
+    return (NULL);
+  }
+
+  node->type = type;
+
+  if (type == MAN_NODE_HTML)
+    node->from = state->font;
+
+  state->num_nodes ++;
+
+  if (parent->last_child)
+    parent->last_child->next = node;
+  else
+    parent->child = node;
+
+  parent->last_child = node;
+
+  return (node);
+}
+
+
+//
+// 'man_open_block()' - Start a new block.
+//
+
+static void
+man_open_block(man_state_t *state,	// I - Current man state
+               man_block_t block,	// I - Kind of block
+               const char  *indent)	// I - Indentation or `NULL`
+{
+  man_node_t	*node;			// Block node
+  static const char * const elems[] =	// HTML elements for blocks
+  {
+    NULL,
+    "p",
+    "p",
+    "p",
+    "p",
+    "pre",
+    "ul"
+  };
+
+
+  if ((node = man_node(state, state->parent, MAN_NODE_BLOCK)) != NULL)
+  {
+    node->value = block;
+    node->elem  = elems[block];
+    node->text  = indent;
+  }
+
+  state->in_block  = elems[block];
+  state->block     = node;
+  state->container = node;
+}
+
+
+//
+// 'man_open_buffer()' - Open a man page source in memory.
+//
+// The source is copied so that lines can be terminated in place.
+//
+
+static bool				// O - `true` on success, `false` on error
+man_open_buffer(man_source_t *src,	// I - Man page source
+                const char   *data,	// I - Man page data
+                size_t       len)	// I - Length of man page data
+{
+  memset(src, 0, sizeof(man_source_t));
+
+  src->fd  = -1;
+  src->eof = true;
+
+  if ((src->buffer = malloc(len + 1)) == NULL)
+    return (false);
+
+  memcpy(src->buffer, data, len);
+
+  src->bufsize = len + 1;
+  src->ptr     = src->buffer;
+  src->end     = src->buffer + len;
+
+  _MANTOHTML_STATS_ADD(src->bytes, len);
+
+  if (!man_open_stream(src))
+  {
+    man_close(src);
+    return (false);
+  }
+
+  return (true);
+}
+
+
+//
+// 'man_open_fd()' - Open a man page source file descriptor.
+//
+// Regular files of up to 1MiB are read with a single read() into a buffer
+// that is sized to hold the whole file.  Larger files and pipes are read in
+// blocks as the man page is converted.
+//
+
+static bool				// O - `true` on success, `false` on error
+man_open_fd(man_source_t *src,		// I - Man page source
+            int          fd)		// I - File descriptor
+{
+  struct stat	fileinfo;		// File information
+  ssize_t	bytes;			// Bytes read
+
+
+  memset(src, 0, sizeof(man_source_t));
+
+  src->fd = fd;
+
+  if (!fstat(src->fd, &fileinfo) && S_ISREG(fileinfo.st_mode) && fileinfo.st_size > 0)
+    src->bufsize = fileinfo.st_size < MAN_MAX_BUFFER ? (size_t)fileinfo.st_size + 1 : MAN_MAX_BUFFER;
+  else
+    src->bufsize = 65536;
+
+  if ((src->buffer = malloc(src->bufsize)) == NULL)
+    return (false);
+
+  src->ptr = src->end = src->buffer;
+
+  // Read enough to detect compression...
+  while ((src->end - src->buffer) < 6)
+  {
+    if ((bytes = man_read(src, src->end, src->bufsize - (size_t)(src->end - src->buffer) - 1)) < 0)
+    {
+      free(src->buffer);
+      src->buffer = NULL;
+      return (false);
+    }
+    else if (bytes == 0)
+    {
+      src->eof = true;
+      break;
+    }
+
+    src->end += bytes;
+  }
+
+  if (!man_open_stream(src))
+  {
+    src->fd = -1;
+    man_close(src);
+    return (false);
+  }
+
+  return (true);
+}
+
+
+//
+// 'man_open_file()' - Open a man page source file.
+//
+
+static bool				// O - `true` on success, `false` on error
+man_open_file(man_source_t *src,	// I - Man page source
+              const char   *filename)	// I - Man filename
+{
+  int	fd;				// File descriptor
+
+
+  if ((fd = open(filename, O_RDONLY)) < 0)
+    return (false);
+
+  if (!man_open_fd(src, fd))
+  {
+    int error = errno;			// Saved error
+
+    close(fd);
+    errno = error;
+    return (false);
+  }
+
+  return (true);
+}
+
+
+
+//
+// 'man_open_range()' - Open part of a man page source that is already in memory.
+//
+// The range must end with a newline or be followed by room for a nul
+// terminator.  The caller owns the memory, which is modified as lines are read.
+//
+
+static void
+man_open_range(man_source_t *src,	// I - Man page source
+               char         *start,	// I - Start of range
+               char         *end,	// I - End of range
+               int          linenum)	// I - Number of lines before the range
+{
+  memset(src, 0, sizeof(man_source_t));
+
+  src->fd      = -1;
+  src->eof     = true;
+  src->ptr     = start;
+  src->end     = end;
+  src->linenum = linenum;
+}
+
+//
+// 'man_open_stream()' - Start decompressing a man page source as needed.
+//
+// The compression is detected from the first few bytes in the source buffer.
+// Compressed data is moved to the compressed data buffer and a new source
+// buffer is allocated for the decompressed data.
+//
+
+static bool				// O - `true` on success, `false` on error
+man_open_stream(man_source_t *src)	// I - Man page source
+{
+  const unsigned char *data = (unsigned char *)src->ptr;
+					// Start of data
+  size_t	len = (size_t)(src->end - src->ptr);
+					// Length of data
+
+
+  if (len >= 2 && data[0] == 0x1f && data[1] == 0x8b)
+    src->compress = MAN_COMPRESS_GZIP;
+  else if (len >= 3 && !memcmp(data, "BZh", 3))
+    src->compress = MAN_COMPRESS_BZIP2;
+  else if (len >= 6 && !memcmp(data, "\3757zXZ\0", 6))
+    src->compress = MAN_COMPRESS_XZ;
+  else if (len >= 4 && !memcmp(data, "\050\265\057\375", 4))
+    src->compress = MAN_COMPRESS_ZSTD;
+  else
+    return (true);
+
+  // Move the compressed data to the compressed data buffer...
+  src->inbuf     = (unsigned char *)src->buffer;
+  src->inbufsize = src->bufsize;
+  src->inptr     = (unsigned char *)src->ptr;
+  src->inend     = (unsigned char *)src->end;
+  src->ineof     = src->fd < 0;
+  src->bufsize   = 65536;
+
+  if ((src->buffer = malloc(src->bufsize)) == NULL)
+  {
+    src->compress = MAN_COMPRESS_NONE;
+    return (false);
+  }
+
+  src->ptr = src->end = src->buffer;
+  src->eof = false;
+
+  // Then start the decompressor...
+  switch (src->compress)
+  {
+    default :
+        break;
+
+    case MAN_COMPRESS_GZIP :
+        if (inflateInit2(&src->gz, 16 + MAX_WBITS) != Z_OK)
+        {
+          src->compress = MAN_COMPRESS_NONE;
+          src->error    = "Unable to initialize gzip decompressor";
+        }
+        break;
+
+    case MAN_COMPRESS_BZIP2 :
+#ifdef HAVE_BZLIB
+        if (BZ2_bzDecompressInit(&src->bz, 0, 0) != BZ_OK)
+        {
+          src->compress = MAN_COMPRESS_NONE;
+          src->error    = "Unable to initialize bzip2 decompressor";
+        }
+#else
+        src->compress = MAN_COMPRESS_NONE;
+        src->error    = "bzip2 compression is not supported";
+#endif // HAVE_BZLIB
+        break;
+
+    case MAN_COMPRESS_XZ :
+#ifdef HAVE_LZMA
+        if (lzma_stream_decoder(&src->xz, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK)
+        {
+          src->compress = MAN_COMPRESS_NONE;
+          src->error    = "Unable to initialize xz decompressor";
+        }
+#else
+        src->compress = MAN_COMPRESS_NONE;
+        src->error    = "xz compression is not supported";
+#endif // HAVE_LZMA
+        break;
+
+    case MAN_COMPRESS_ZSTD :
+#ifdef HAVE_ZSTD
+        if ((src->zstd = ZSTD_createDStream()) == NULL)
+        {
+          src->compress = MAN_COMPRESS_NONE;
+          src->error    = "Unable to initialize Zstandard decompressor";
+        }
+#else
+        src->compress = MAN_COMPRESS_NONE;
+        src->error    = "Zstandard compression is not supported";
+#endif // HAVE_ZSTD
+        break;
+  }
+
+  // Unsupported compression is reported by man_gets() returning NULL...
+  if (src->error)
+    src->eof = true;
+
+  return (true);
+}
+
+
+//
+// 'man_putn()' - Add a man string of the given length.
+//
+// The string does not need to be nul-terminated, so macro arguments can be
+// added directly from the line.
+//
+
+static void
+man_putn(man_state_t *state,		// I - Current man state
+         const char  *s,		// I - String
+         size_t      len)		// I - Length of string
+{
+  man_lex_t	lex;			// Lexer
+  man_token_t	token;			// Current token
+  const char	*start,			// Start of token
+		*end;			// End of token
+  man_node_t	*link;			// Link node
+  _MANTOHTML_STATS_START(start_time);	// Start time
+
+
+  lex.s          = s;
+  lex.end        = s + len;
+  lex.next       = MAN_TOKEN_END;
+  lex.next_start = NULL;
+  lex.next_end   = NULL;
+
+  while ((token = man_lex(&lex, &start, &end)) != MAN_TOKEN_END)
+  {
+    switch (token)
+    {
+      case MAN_TOKEN_TEXT :
+          man_text(state, start, (size_t)(end - start), false);
+          break;
+
+      case MAN_TOKEN_ENTITY :
+          // Quoted HTML character...
+          man_text(state, start, 1, true);
+          break;
+
+      case MAN_TOKEN_FONT :
+          switch (start[2])
+          {
+            case 'R' :
+            case 'P' :
+                man_font(state, MAN_FONT_REGULAR);
+                break;
+
+            case 'b' :
+            case 'B' :
+                man_font(state, MAN_FONT_BOLD);
+                break;
+
+            case 'i' :
+            case 'I' :
+                man_font(state, MAN_FONT_ITALIC);
+                break;
+
+            default :
+                man_message(state, "mantohtml: Unknown font '\\f%c' ignored.\n", start[2]);
+                _MANTOHTML_STATS_ADD(state->counts.unknown_escapes, 1);
+                break;
+          }
+          break;
+
+      case MAN_TOKEN_CHAR :
+          if (start[1] == '*')
+          {
+            // Substitute macro...
+            const char	*name = start + 3;
+					// Name of string
+            size_t	namelen = (size_t)(end - name);
+					// Length of name
+
+            if (start[2] == 'R')
+            {
+              man_html(state, "&reg;");
+            }
+            else if (start[2] != '(')
+            {
+              man_message(state, "mantohtml: Unknown macro '\\*%c' ignored.\n", start[2]);
+              _MANTOHTML_STATS_ADD(state->counts.unknown_escapes, 1);
+            }
+            else if (namelen == 2 && !strncmp(name, "aq", 2))
+            {
+              man_text(state, "'", 1, false);
+            }
+            else if (namelen == 2 && !strncmp(name, "dq", 2))
+            {
+              man_html(state, "&quot;");
+            }
+            else if (namelen == 2 && !strncmp(name, "lq", 2))
+            {
+              man_html(state, "&ldquo;");
+            }
+            else if (namelen == 2 && !strncmp(name, "rq", 2))
+            {
+              man_html(state, "&rdquo;");
+            }
+            else if (namelen == 2 && !strncmp(name, "Tm", 2))
+            {
+              man_html(state, "<sup>TM</sup>");
+            }
+            else
+            {
+              man_message(state, "mantohtml: Unknown macro '\\*(%.*s' ignored.\n", (int)namelen, name);
+              _MANTOHTML_STATS_ADD(state->counts.unknown_escapes, 1);
+            }
+          }
+          else if (start[1] == '(' || start[1] == '[')
+          {
+            // Substitute special character...
+            const char	*name = start + 2,
+					// Name of character
+			*nameend = start[1] == '(' ? end : end - 1,
+					// End of name
+			*html;		// HTML text for character
+
+            if ((html = man_glyph(name, (size_t)(nameend - name))) != NULL)
+            {
+              man_html(state, html);
+            }
+            else if (*name == 'u' && (nameend - name) > 4 && strspn(name + 1, "0123456789ABCDEFabcdef_") >= (size_t)(nameend - name - 1))
+            {
+              // Unicode character(s) - uXXXX or uXXXX_YYYY...
+              const char	*code;	// Start of code point
+
+              for (code = name + 1; code < nameend; code = name + 1)
+              {
+                if ((name = memchr(code, '_', (size_t)(nameend - code))) == NULL)
+                  name = nameend;
+
+                if (name > code)
+                  man_htmlf(state, "&#x%.*s;", (int)(name - code), code);
+              }
+            }
+            else if ((nameend - name) > 4 && !strncmp(name, "char", 4) && strspn(name + 4, "0123456789") >= (size_t)(nameend - name - 4))
+            {
+              // Numbered character - charNNN...
+              man_htmlf(state, "&#%d;", atoi(name + 4));
+            }
+            else
+            {
+              // Show the escape for an unknown character...
+              man_message(state, "mantohtml: Unknown character '%.*s'.\n", (int)(end - start), start);
+              _MANTOHTML_STATS_ADD(state->counts.unknown_escapes, 1);
+              man_text(state, start, (size_t)(end - start), false);
+            }
+          }
+          else
+          {
+            // Octal character - \NNN...
+            man_htmlf(state, "&#%d;", ((start[1] - '0') * 8 + start[2] - '0') * 8 + start[3] - '0');
+          }
+          break;
+
+      case MAN_TOKEN_ESCAPE :
+          if (start[1] != '\\' && start[1] != '\"' && start[1] != '\'' && start[1] != '-' && start[1] != 'e' && start[1] != ' ')
+          {
+            man_message(state, "mantohtml: Unrecognized escape '\\%c' ignored.\n", start[1]);
+            _MANTOHTML_STATS_ADD(state->counts.unknown_escapes, 1);
+            man_text(state, "\\", 1, false);
+          }
+
+          if (start[1] == 'e')
+          {
+            // Escape sequence for backslash...
+            man_text(state, "\\", 1, false);
+          }
+          else
+          {
+            // Something else that is written as-is...
+            man_text(state, start + 1, 1, true);
+          }
+          break;
+
+      case MAN_TOKEN_URL :
+          // Embed URL, the link uses the same copy of the URL as its text...
+          if ((link = man_node(state, man_inline(state), MAN_NODE_LINK)) == NULL)
+            break;
+
+          link->value = MAN_LINK_AUTO;
+
+          for (s = start; s < end; s ++)
+          {
+            if (*s == '\\' && (s + 1) < end)
+            {
+              // Escaped character, "\\&" is a zero-width character...
+              man_text(state, start, (size_t)(s - start), true);
+              start = ++ s;
+
+              if (*s == '&')
+                start ++;
+            }
+          }
+
+          man_text(state, start, (size_t)(end - start), true);
+
+          link->text = link->next ? link->next->text : "";
+
+          man_link(state, MAN_LINK_AUTO, NULL);
+          break;
+
+      default :
+          break;
+    }
+  }
+
+  _MANTOHTML_STATS_END(state->counts.puts_time, start_time);
+}
+
+
+//
+// 'man_puts()' - Add a man string.
+//
+
+static void
+man_puts(man_state_t *state,		// I - Current man state
+         const char  *s)		// I - String
+{
+  man_putn(state, s, strlen(s));
+}
+
+
+//
+// 'man_read()' - Read data from a man page file.
+//
+
+static ssize_t				// O - Number of bytes or 0 on end of file, -1 on error
+man_read(man_source_t *src,		// I - Man page source
+         char         *buffer,		// I - Buffer
+         size_t       bufsize)		// I - Size of buffer
+{
+  ssize_t	bytes;			// Bytes read
+
+
+  if (src->fd < 0)
+    return (0);
+
+  while ((bytes = read(src->fd, buffer, bufsize)) < 0)
+  {
+    if (errno != EINTR && errno != EAGAIN)
+    {
+      src->error = strerror(errno);
+      break;
+    }
+  }
+
+  _MANTOHTML_STATS_ADD(src->bytes, bytes > 0 ? (size_t)bytes : 0);
+
+  return (bytes);
+}
+
+
+//
+// 'man_render()' - Write a list of nodes to the current output.
+//
+// When "flush" is `true` the nodes are followed by more nodes for the same man
+// page, so compact HTML closes the current font.
+//
+
+static bool				// O - `true` on success, `false` on error
+man_render(man_state_t *state,		// I - Current man state
+           man_node_t  *node,		// I - First node
+           bool        flush)		// I - Flushing nodes?
+{
+  switch (state->format)
+  {
+    case MANTOHTML_FORMAT_HTML :
+    case MANTOHTML_FORMAT_FRAGMENT :
+        if (!html_node(state, node))
+          return (false);
+
+        if (flush && state->options.compact)
+          html_font_sync(state, MAN_FONT_REGULAR);
+        break;
+
+    case MANTOHTML_FORMAT_JSON :
+        return (json_node(state, node, &state->json_comma));
+
+    case MANTOHTML_FORMAT_TEXT :
+        return (text_node(state, node));
+  }
+
+  return (true);
+}
+
+
+//
+// 'man_scheme()' - Find the scheme of a URL in man text.
+//
+// The URL must start a word and use one of the "ftp://", "http://",
+// "https://", or "mailto:" schemes.
+//
+
+static const char *			// O - Start of URL or `NULL` if none
+man_scheme(const char *start,		// I - Start of text
+           const char *s,		// I - Pointer to ':' after the scheme
+           const char *end)		// I - End of text
+{
+  size_t	i;			// Looping var
+  const char	*url;			// Start of URL
+  static const struct
+  {
+    const char	*name;			// Scheme name
+    size_t	len;			// Length of name
+    bool	slashes;		// Is the scheme followed by "//"?
+  }		schemes[] =		// Schemes that are linked
+  {
+    { "ftp",    3, true },
+    { "http",   4, true },
+    { "https",  5, true },
+    { "mailto", 6, false }
+  };
+
+
+  if (s == start || (s[-1] != 'p' && s[-1] != 's' && s[-1] != 'o'))
+    return (NULL);
+
+  for (i = 0; i < (sizeof(schemes) / sizeof(schemes[0])); i ++)
+  {
+    if ((size_t)(s - start) < schemes[i].len)
+      continue;
+
+    url = s - schemes[i].len;
+
+    if (memcmp(url, schemes[i].name, schemes[i].len) || (url > start && (MAN_ALPHA(url[-1]) || isdigit(url[-1] & 255))))
+      continue;
+
+    if (schemes[i].slashes)
+    {
+      // "scheme://" needs a host name...
+      if ((end - s) >= 4 && s[1] == '/' && s[2] == '/' && !MAN_CLASS(s[3], MAN_CHAR_SPACE))
+        return (url);
+    }
+    else if ((end - s) >= 2 && !MAN_CLASS(s[1], MAN_CHAR_SPACE))
+    {
+      // "mailto:" needs an address...
+      return (url);
+    }
+  }
+
+  return (NULL);
+}
+
+
+//
+// 'man_split()' - Split a text node.
+//
+
+static man_node_t *			// O - New node with the text after the split or `NULL` on error
+man_split(man_state_t *state,		// I - Current man state
+          man_node_t  *parent,		// I - Parent node
+          man_node_t  *node,		// I - Text node
+          size_t      offset)		// I - Offset of split
+{
+  man_node_t	*rest;			// Text after the split
+
+
+  if ((rest = man_insert(state, parent, node, MAN_NODE_TEXT)) != NULL)
+  {
+    rest->value   = node->value;
+    rest->text    = node->text + offset;
+    rest->textlen = node->textlen - offset;
+    node->textlen = offset;
+  }
+
+  return (rest);
+}
+
+
+#ifdef MANTOHTML_STATS
+//
+// 'man_stats_macro()' - Count a macro.
+//
+// Names are truncated to 7 characters, and macros after the first
+// `_MANTOHTML_MAX_MCOUNTS` names are not counted by name.
+//
+
+static void
+man_stats_macro(man_state_t *state,	// I - Current man state
+                const char  *name,	// I - Macro name without the leading "."
+                size_t      count)	// I - Number of uses
+{
+  size_t		i;		// Looping var
+  _mantohtml_mcount_t	*mcount;	// Current macro count
+
+
+  for (i = state->num_mcounts, mcount = state->mcounts; i > 0; i --, mcount ++)
+  {
+    if (!strncmp(mcount->name, name, sizeof(mcount->name) - 1))
+    {
+      mcount->count += count;
+      return;
+    }
+  }
+
+  if (state->num_mcounts < _MANTOHTML_MAX_MCOUNTS)
+  {
+    strncpy(mcount->name, name, sizeof(mcount->name) - 1);
+    mcount->name[sizeof(mcount->name) - 1] = '\0';
+    mcount->count = count;
+
+    state->num_mcounts ++;
+  }
+}
+
+
+//
+// 'man_stats_out()' - Get the output statistics for the main and additional
+//                     outputs.
+//
+
+static void
+man_stats_out(man_state_t *state,	// I - Current man state
+              size_t      *bytes,	// O - Bytes written
+              size_t      *growths,	// O - Buffer growths
+              double      *secs)	// O - Write time in seconds
+{
+  size_t	i,			// Looping var
+		obytes,			// Bytes written to output
+		ogrowths;		// Buffer growths for output
+  double	osecs;			// Write time for output
+  man_output_t	*output;		// Current additional output
+
+
+  _mantohtml_sink_stats(state->out, bytes, growths, secs);
+
+  for (i = state->num_outputs, output = state->outputs; i > 0; i --, output ++)
+  {
+    _mantohtml_sink_stats(output->out, &obytes, &ogrowths, &osecs);
+
+    *bytes   += obytes;
+    *growths += ogrowths;
+    *secs    += osecs;
+  }
+}
+#endif // MANTOHTML_STATS
+
+
+//
+// 'man_swap()' - Swap the current output with an additional output.
+//
+
+static void
+man_swap(man_state_t  *state,		// I - Current man state
+         man_output_t *output)		// I - Additional output
+{
+  man_output_t	current;		// Current output
+
+
+  current.format     = state->format;
+  current.out        = state->out;
+  current.out_font   = state->out_font;
+  current.text_font  = state->text_font;
+  current.json_comma = state->json_comma;
+  current.text_nl    = state->text_nl;
+
+  state->format     = output->format;
+  state->out        = output->out;
+  state->out_font   = output->out_font;
+  state->text_font  = output->text_font;
+  state->json_comma = output->json_comma;
+  state->text_nl    = output->text_nl;
+
+  *output = current;
+}
+
+
+//
+// 'man_text()' - Add plain text.
+//
+// Consecutive text is collected in a single node.  Text nodes remember
+// whether they contain HTML special characters so that only those nodes need
+// to be quoted.
+//
+
+static void
+man_text(man_state_t *state,		// I - Current man state
+         const char  *s,		// I - Text
+         size_t      len,		// I - Length of text
+         bool        quote)		// I - Does the text contain HTML special characters?
+{
+  man_node_t	*parent,		// Parent node
+		*node;			// Text node
+  char		*text;			// Text buffer
+
+
+  if (!len || (parent = man_inline(state)) == NULL)
+    return;
+
+  if ((node = parent->last_child) == NULL || node->type != MAN_NODE_TEXT || node->text != state->arena.last)
+  {
+    // Start a new text node...
+    if ((node = man_node(state, parent, MAN_NODE_TEXT)) == NULL)
+      return;
+  }
+
+  if ((text = _mantohtml_arena_grow(&state->arena, (char *)node->text, node->textlen, node->textlen + len + 1)) == NULL)
+  {
+    state->nomem = true;
+    return;
+  }
+
+  memcpy(text + node->textlen, s, len);
+
+  if (quote)
+    node->value = true;
+
+  node->text    = text;
+  node->textlen += len;
+
+  text[node->textlen] = '\0';
+}
+
+
+//
+// 'man_title()' - Get the title of a heading as HTML.
+//
+
+static const char *			// O - Title or `NULL` on error
+man_title(man_state_t *state,		// I - Current man state
+          man_node_t  *heading)		// I - Heading or anchor node
+{
+  size_t	len;			// Length of title
+  char		*title;			// Title
+
+
+  len = html_title(NULL, heading->child);
+
+  if ((title = _mantohtml_arena_grow(&state->arena, NULL, 0, len + 1)) == NULL)
+  {
+    state->nomem = true;
+    return (NULL);
+  }
+
+  html_title(title, heading->child);
+  title[len] = '\0';
+
+  return (title);
+}
+
+
+//
+// 'man_write()' - Write a list of nodes to each output.
+//
+
+static bool				// O - `true` on success, `false` on error
+man_write(man_state_t *state,		// I - Current man state
+          man_node_t  *node,		// I - First node
+          bool        flush)		// I - Flushing nodes?
+{
+  bool		ret;			// Return value
+  size_t	i;			// Looping var
+  man_output_t	*output;		// Current additional output
+
+
+  ret = man_render(state, node, flush);
+
+  for (i = state->num_outputs, output = state->outputs; i > 0; i --, output ++)
+  {
+    man_swap(state, output);
+
+    if (!man_render(state, node, flush))
+      ret = false;
+
+    man_swap(state, output);
+  }
+
+  return (ret);
+}
+
+
+//
+// 'man_xref()' - Link references to other man pages in a block.
+//
+// References are "name(section)" in the text, or a name in its own font
+// followed by "(section)" as produced by "\fBname\fR(section)" and
+// ".BR name (section)".  Only references to man pages in the index are
+// linked.
+//
+
+static void
+man_xref(man_state_t *state,		// I - Current man state
+         man_node_t  *parent,		// I - Block or list item
+         bool        *in_link)		// IO - Are we in a link?
+{
+  man_node_t	*node,			// Current node
+		*back[4] = { NULL, NULL, NULL, NULL },
+					// Previous nodes, nearest first
+		*after,			// Node before the link
+		*link,			// Link or end of link node
+		*rest;			// Text after the link
+  const char	*s,			// Pointer into text
+		*end,			// End of text
+		*name,			// Start of name
+		*section,		// Start of section
+		*secend,		// End of section
+		*href;			// URL for man page
+  size_t	namelen;		// Length of name
+  bool		in_font;		// Is the name in its own font?
+
+
+  for (node = parent->child; node && !state->nomem; back[3] = back[2], back[2] = back[1], back[1] = back[0], back[0] = node, node = node->next)
+  {
+    if (node->type == MAN_NODE_BLOCK || node->type == MAN_NODE_ITEM)
+    {
+      man_xref(state, node, in_link);
+      continue;
+    }
+    else if (node->type == MAN_NODE_LINK || node->type == MAN_NODE_LINK_END)
+    {
+      *in_link = node->type == MAN_NODE_LINK;
+      continue;
+    }
+    else if (node->type != MAN_NODE_TEXT || *in_link)
+    {
+      continue;
+    }
+
+    for (s = node->text, end = s + node->textlen; s < end && (s = memchr(s, '(', (size_t)(end - s))) != NULL; s ++)
+    {
+      // Look for "(section)"...
+      section = s + 1;
+
+      if (section >= end || !isdigit(*section & 255))
+        continue;
+
+      for (secend = section + 1; secend < end && isalnum(*secend & 255); secend ++);
+
+      if (secend >= end || *secend != ')')
+        continue;
+
+      // Then the name before it...
+      for (name = s; name > node->text && MAN_CLASS(name[-1], MAN_CHAR_NAME); name --);
+
+      while (name < s && (*name == '-' || *name == '.'))
+        name ++;
+
+      if (name < s)
+      {
+        // "name(section)"...
+        namelen = (size_t)(s - name);
+        in_font = false;
+      }
+      else if (s == node->text && back[0] && back[0]->type == MAN_NODE_FONT && back[1] && back[1]->type == MAN_NODE_TEXT && back[2] && back[2]->type == MAN_NODE_FONT && back[2]->value == (int)back[0]->from && back[0]->value == (int)back[2]->from)
+      {
+        // "\fBname\fR(section)", the whole text node must be the name...
+        for (name = back[1]->text + back[1]->textlen; name > back[1]->text && MAN_CLASS(name[-1], MAN_CHAR_NAME); name --);
+
+        if (name > back[1]->text || !back[1]->textlen || *name == '-' || *name == '.')
+          continue;
+
+        namelen = back[1]->textlen;
+        in_font = true;
+      }
+      else
+      {
+        continue;
+      }
+
+      if ((href = _mantohtml_index_find(state->options.index, name, namelen, section, (size_t)(secend - section))) == NULL)
+        continue;
+
+      if (state->options.index_prefix)
+      {
+        // Make the hyperlink relative to the directory of this man page...
+        size_t	prefixlen = strlen(state->options.index_prefix),
+					// Length of prefix
+		hreflen = strlen(href);	// Length of URL
+        char	*temp;			// Prefixed URL
+
+        if ((temp = _mantohtml_arena_alloc(&state->arena, prefixlen + hreflen + 1)) == NULL)
+        {
+          state->nomem = true;
+          return;
+        }
+
+        memcpy(temp, state->options.index_prefix, prefixlen);
+        memcpy(temp + prefixlen, href, hreflen + 1);
+        href = temp;
+      }
+
+      // Start the link before the name, or the font change for the name...
+      if (in_font)
+      {
+        after = back[3];
+      }
+      else if (name > node->text)
+      {
+        after = node;
+
+        if ((node = man_split(state, parent, node, (size_t)(name - node->text))) == NULL)
+          return;
+      }
+      else
+      {
+        after = back[0];
+      }
+
+      if ((link = man_insert(state, parent, after, MAN_NODE_LINK)) == NULL)
+        return;
+
+      link->value = MAN_LINK_AUTO;
+      link->text  = href;
+
+      // End the link after the section...
+      if ((size_t)(secend + 1 - node->text) < node->textlen)
+      {
+        if ((rest = man_split(state, parent, node, (size_t)(secend + 1 - node->text))) == NULL)
+          return;
+      }
+      else
+      {
+        rest = NULL;
+      }
+
+      if ((link = man_insert(state, parent, node, MAN_NODE_LINK_END)) == NULL)
+        return;
+
+      link->value = MAN_LINK_AUTO;
+
+      if (!rest)
+      {
+        node = link;
+        break;
+      }
+
+      // Continue with the rest of the text...
+      back[0] = link;
+      node    = rest;
+      s       = rest->text - 1;
+      end     = rest->text + rest->textlen;
+    }
+  }
+}
+
+
+//
+// 'man_xx()' - Parse font macro.
+//
+// Each word is added directly from the line without being copied.
+//
+
+static void
+man_xx(man_state_t *state,		// I - Current man state
+       man_font_t  a,			// I - First font
+       man_font_t  b,			// I - Second font
+       const char  *line)		// I - Line
+{
+  const char	*word;			// Word from line
+  size_t	wordlen;		// Length of word
+  man_font_t	font = state->font;	// Current font
+  bool		use_a = true;		// Use the first font?
+
+
+  // Loop until all words are written
+  while ((word = parse_arg(&line, &wordlen)) != NULL)
+  {
+    bool	have_link = false;	// Have a link?
+
+    if (a == MAN_FONT_BOLD && b == MAN_FONT_REGULAR && use_a)
+    {
+      const char *section,		// Section (regular portion)
+		*secptr,		// Pointer into section
+		*saveline = line;	// Saved line pointer
+      size_t	seclen;			// Length of section
+
+      if ((section = parse_arg(&saveline, &seclen)) != NULL && seclen > 1 && section[0] == '(' && isdigit(section[1] & 255) && (secptr = memchr(section, ')', seclen)) != NULL)
+      {
+        // Possibly convert ".BR name (section)" to hyperlink...
+        char	*filename;		// Man source file
+        size_t	i,			// Looping var
+		filesize;		// Size of filename buffer
+
+        filesize = strlen(state->basepath) + wordlen + seclen + 7;
+
+        if ((filename = _mantohtml_arena_grow(&state->arena, NULL, 0, filesize)) == NULL)
+        {
+          state->nomem = true;
+          return;
+        }
+
+        for (i = 0; i < (sizeof(man_exts) / sizeof(man_exts[0])); i ++)
+        {
+          snprintf(filename, filesize, "%s/%.*s.%.*s%s", state->basepath, (int)wordlen, word, (int)(secptr - section - 1), section + 1, man_exts[i]);
+          if (!access(filename, 0))
+          {
+            // Have a "name.section" source file...
+            have_link = true;
+            break;
+          }
+        }
+
+        // Release the filename...
+        _mantohtml_arena_grow(&state->arena, filename, filesize, 0);
+
+        if (have_link)
+        {
+          // The link is to "name.section" plus the suffix, like the output
+          // files for --output-dir...
+          char	*name;			// Man page name and section
+          size_t	namelen = wordlen + (size_t)(secptr - section);
+					// Length of name and section
+
+          if ((name = _mantohtml_arena_alloc(&state->arena, namelen + 1)) == NULL)
+          {
+            state->nomem = true;
+            return;
+          }
+
+          snprintf(name, namelen + 1, "%.*s.%.*s", (int)wordlen, word, (int)(secptr - section - 1), section + 1);
+
+          man_link(state, MAN_LINK_MAN, name);
+        }
+      }
+    }
+
+    man_font(state, use_a ? a : b);
+    man_putn(state, word, wordlen);
+
+    if (have_link && (word = parse_arg(&line, &wordlen)) != NULL)
+    {
+      // Show man page section and close the link...
+      man_font(state, b);
+      man_putn(state, word, wordlen);
+      man_link(state, MAN_LINK_MAN, NULL);
+    }
+    else
+    {
+      // Alternate fonts...
+      use_a = !use_a;
+    }
+  }
+
+  // Restore the original font...
+  man_font(state, font);
+  man_text(state, "\n", 1, false);
+}
+
+
+//
+// 'parse_arg()' - Parse an argument from the line without copying it.
+//
+// The returned pointer is into the line.  Quotes are removed but escapes are
+// kept, so the argument can be added with man_putn().
+//
+
+static const char *			// O  - Start of argument or `NULL` if none
+parse_arg(const char **line,		// IO - Pointer into line
+          size_t     *len)		// O  - Length of argument
+{
+  const char	*lineptr,		// Pointer into line
+		*start,			// Start of argument
+		*end;			// End of argument
+  bool		quoted;			// Quoted argument?
+
+
+  // Skip leading whitespace...
+  lineptr = *line;
+
+  while (MAN_CLASS(*lineptr, MAN_CHAR_SPACE))
+    lineptr ++;
+
+  if (!*lineptr)
+  {
+    *len = 0;
+    return (NULL);
+  }
+
+  // Find the end of the argument...
+  if ((quoted = *lineptr == '\"') == true)
+    lineptr ++;
+
+  for (start = lineptr; *lineptr && (quoted ? *lineptr != '\"' : !MAN_CLASS(*lineptr, MAN_CHAR_SPACE)); lineptr ++)
+  {
+    // Make sure we don't lose an escaped value...
+    if (*lineptr == '\\' && lineptr[1])
+      lineptr ++;
+  }
+
+  end = lineptr;
+
+  if (quoted && *lineptr)
+    lineptr ++;
+
+  // Skip trailing whitespace...
+  while (MAN_CLASS(*lineptr, MAN_CHAR_SPACE))
+    lineptr ++;
+
+  // Store where we ended up...
+  *line = lineptr;
+  *len  = (size_t)(end - start);
+
+  return (start);
+}
+
+
+//
+// 'parse_measurement()' - Parse a measurement value from the line.
+//
+
+static char *				// O  - String value or `NULL` if none
+parse_measurement(
+    man_state_t *state,			// I  - Current man state
+    const char  **line,			// IO - Pointer into line
+    char        defunit)		// I  - Default units
+{
+  char		*buffer,		// String buffer
+		*bufptr,		// Pointer into buffer
+		*bufend,		// End of buffer
+		unit;			// Unit
+  size_t	len,			// Length of value
+		bufsize;		// Size of string buffer
+
+
+  // First get a value, with room for the units or a formatted number...
+  if ((buffer = parse_value(state, line)) == NULL)
+    return (NULL);
+
+  len     = strlen(buffer);
+  bufsize = len + 320;
+
+  if ((buffer = _mantohtml_arena_grow(&state->arena, buffer, len + 1, bufsize)) == NULL)
+  {
+    state->nomem = true;
+    return (NULL);
+  }
+
+  // Then convert the value to a CSS measurement
+  //
+  //    ##c -> ##cm (centimeters)
+  //    ##f -> ##% (1/65536 of font size - divide by 655.36)
+  //    ##i -> ##in (inches)
+  //    ##m -> ##em (em's)
+  //    ##M -> ##em (1/100th em)
+  //    ##n -> ##en (en's)
+  //    ##P -> ##pi (picas)
+  //    ##p -> ##pt (points)
+  //    ##s -> ##% (multiple of font size - multiply by 100)
+  //    ##u -> ##px (pixel)
+  //    ##v -> ## (multiple of line height)
+  if ((bufptr = buffer + strlen(buffer) - 1) < buffer)
+    return (NULL);
+
+  bufend = buffer + bufsize - 1;
+
+  if (isalpha(*bufptr & 255))
+    unit = *bufptr;
+  else
+    unit = defunit;
+
+  switch (unit)
+  {
+    case 'c' : // Centimaters
+        if ((bufptr + 1) >= bufend)
+          return (NULL);
+
+	// Convert to ##cm
+	bufptr[1] = 'm';
+	bufptr[2] = '\0';
+        break;
+
+    case 'f' : // 1/65536 of font size
+	// Convert to ##%
+	snprintf(buffer, bufsize, "%.1f%%", 100.0 * atof(buffer) / 65536.0);
+        break;
+
+    case 'i' : // Inches
+        if ((bufptr + 1) >= bufend)
+          return (NULL);
+
+	// Convert to ##in
+	bufptr[1] = 'n';
+	bufptr[2] = '\0';
+        break;
+
+    case 'm' : // Ems
+        if ((bufptr + 1) >= bufend)
+          return (NULL);
+
+	// Convert to ##em
+	bufptr[0] = 'e';
+	bufptr[1] = 'm';
+	bufptr[2] = '\0';
+        break;
+
+    case 'M' : // 1/100th ems
+	// Convert to ##em
+	snprintf(buffer, bufsize, "%.2fem", 0.01 * atof(buffer));
+        break;
+
+    case 'n' : // Ens (1/2 em)
+	// Convert to ##em
+	snprintf(buffer, bufsize, "%gem", 0.5 * atof(buffer));
+        break;
+
+    case 'P' : // Picas
+        if ((bufptr + 1) >= bufend)
+          return (NULL);
+
+	// Convert to ##pc
+	bufptr[0] = 'p';
+	bufptr[1] = 'c';
+	bufptr[2] = '\0';
+        break;
+
+    case 'p' : // Points
+        if ((bufptr + 1) >= bufend)
+          return (NULL);
+
+	// Convert to ##pt
+	bufptr[1] = 't';
+	bufptr[2] = '\0';
+        break;
+
+    case 's' : // Multiple of font size
+	// Convert to ##%
+	snprintf(buffer, bufsize, "%.1f%%", 100.0 * atof(buffer));
+        break;
+
+    case 'u' : // Device unit (pixel)
+        if ((bufptr + 1) >= bufend)
+          return (NULL);
+
+	// Convert to ##px
+	bufptr[0] = 'p';
+	bufptr[1] = 'x';
+	bufptr[2] = '\0';
+        break;
+
+    case 'v' : // Multiple of line height
+	// Convert to ##
+	*bufptr = '\0';
+        break;
+
+    default :
+        return (NULL);
+  }
+
+  // Release the unused memory...
+  len = strlen(buffer);
+
+  return (_mantohtml_arena_grow(&state->arena, buffer, len + 1, len + 1));
+}
+
+
+//
+// 'parse_value()' - Parse a value from the line.
+//
+// The value is allocated from the document's arena.  Quotes are removed but
+// escapes are kept, so the value is never longer than the line.
+//
+
+static char *				// O  - String value or `NULL` if none
+parse_value(man_state_t *state,		// I  - Current man state
+            const char  **line)		// IO - Pointer into line
+{
+  const char	*start;			// Start of value
+  size_t	len;			// Length of value
+  char		*value;			// Value
+
+
+  if ((start = parse_arg(line, &len)) == NULL)
+    return (NULL);
+
+  if ((value = _mantohtml_arena_strdup(&state->arena, start, len)) == NULL)
+    state->nomem = true;
+
+  return (value);
+}
+
+
+//
+// 'scan_chars()' - Find the first of up to five characters in a string.
+//
+// This is the common code for scan_html() and scan_man().  The string is
+// checked 32 (AVX2) or 16 (SSE2/NEON) bytes at a time when the compiler
+// targets those instruction sets, with the remainder checked one byte at a
+// time using the character classes, which must match the characters.  Pass
+// the same character more than once to look for fewer than five.
+//
+
+static inline const char *		// O - Pointer to character or `end`
+scan_chars(const char *s,		// I - Start of string
+           const char *end,		// I - End of string
+           int        mask,		// I - Character classes (MAN_CHAR_xxx) for the characters
+           int        c0,		// I - First character
+           int        c1,		// I - Second character
+           int        c2,		// I - Third character
+           int        c3,		// I - Fourth character
+           int        c4)		// I - Fifth character
+{
+#if defined(__AVX2__)
+  const __m256i	v0 = _mm256_set1_epi8((char)c0),
+		v1 = _mm256_set1_epi8((char)c1),
+		v2 = _mm256_set1_epi8((char)c2),
+		v3 = _mm256_set1_epi8((char)c3),
+		v4 = _mm256_set1_epi8((char)c4);
+					// Characters to look for
+
+  while ((end - s) >= 32)
+  {
+    __m256i	data = _mm256_loadu_si256((const __m256i *)s);
+					// 32 bytes of the string
+    unsigned	bits = (unsigned)_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(data, v0), _mm256_cmpeq_epi8(data, v1)), _mm256_or_si256(_mm256_cmpeq_epi8(data, v2), _mm256_cmpeq_epi8(data, v3))), _mm256_cmpeq_epi8(data, v4)));
+					// Matching bytes
+
+    if (bits)
+      return (s + __builtin_ctz(bits));
+
+    s += 32;
+  }
+
+#elif defined(__SSE2__)
+  const __m128i	v0 = _mm_set1_epi8((char)c0),
+		v1 = _mm_set1_epi8((char)c1),
+		v2 = _mm_set1_epi8((char)c2),
+		v3 = _mm_set1_epi8((char)c3),
+		v4 = _mm_set1_epi8((char)c4);
+					// Characters to look for
+
+  while ((end - s) >= 16)
+  {
+    __m128i	data = _mm_loadu_si128((const __m128i *)s);
+					// 16 bytes of the string
+    unsigned	bits = (unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(data, v0), _mm_cmpeq_epi8(data, v1)), _mm_or_si128(_mm_cmpeq_epi8(data, v2), _mm_cmpeq_epi8(data, v3))), _mm_cmpeq_epi8(data, v4)));
+					// Matching bytes
+
+    if (bits)
+      return (s + __builtin_ctz(bits));
+
+    s += 16;
+  }
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  const uint8x16_t v0 = vdupq_n_u8((uint8_t)c0),
+		v1 = vdupq_n_u8((uint8_t)c1),
+		v2 = vdupq_n_u8((uint8_t)c2),
+		v3 = vdupq_n_u8((uint8_t)c3),
+		v4 = vdupq_n_u8((uint8_t)c4);
+					// Characters to look for
+
+  while ((end - s) >= 16)
+  {
+    uint8x16_t	data = vld1q_u8((const uint8_t *)s);
+					// 16 bytes of the string
+    uint8x16_t	match = vorrq_u8(vorrq_u8(vorrq_u8(vceqq_u8(data, v0), vceqq_u8(data, v1)), vorrq_u8(vceqq_u8(data, v2), vceqq_u8(data, v3))), vceqq_u8(data, v4));
+					// Matching bytes
+
+    if (vmaxvq_u8(match))
+      break;
+
+    s += 16;
+  }
+
+#else
+  (void)c0;
+  (void)c1;
+  (void)c2;
+  (void)c3;
+  (void)c4;
+#endif // __AVX2__
+
+  while (s < end && !MAN_CLASS(*s, mask))
+    s ++;
+
+  return (s);
+}
+
+
+//
+// 'scan_html()' - Find the next character that needs a HTML entity.
+//
+
+static const char *			// O - Pointer to character or `end`
+scan_html(const char *s,		// I - Start of string
+          const char *end)		// I - End of string
+{
+  return (scan_chars(s, end, MAN_CHAR_ENTITY, '&', '<', '\"', '\"', '\"'));
+}
+
+
+//
+// 'scan_man()' - Find the next character that needs special handling in man text.
+//
+// This finds HTML special characters, backslash escapes, and the ':' after
+// URL schemes.
+//
+
+static const char *			// O - Pointer to character or `end`
+scan_man(const char *s,			// I - Start of string
+         const char *end)		// I - End of string
+{
+  return (scan_chars(s, end, MAN_CHAR_ENTITY | MAN_CHAR_MAN, '\\', '&', '<', '\"', ':'));
+}
+
+
+//
+// 'scan_plain()' - Find the first character in man text that is not plain text.
+//
+// This is like @link scan_man@ but skips any ':' that does not start a URL, so
+// that most lines of text can be added without going through man_puts().
+//
+
+static const char *			// O - Pointer to character or `end`
+scan_plain(const char *s,		// I - Start of string
+           const char *end)		// I - End of string
+{
+  const char	*start = s;		// Start of string
+
+
+  while ((s = scan_man(s, end)) < end)
+  {
+    if (*s != ':' || man_scheme(start, s, end))
+      break;
+
+    s ++;
+  }
+
+  return (s);
+}
+
+
+//
+// 'text_html()' - Write HTML markup as text.
+//
+// Character entities are converted to UTF-8 and elements are dropped.
+//
+
+static void
+text_html(man_state_t *state,		// I - Current man state
+          const char  *s,		// I - HTML markup
+          size_t      len)		// I - Length of HTML markup
+{
+  const char	*start = s,		// Start of current fragment
+		*end = s + len,		// End of markup
+		*semi;			// End of entity
+  unsigned	code;			// Unicode code point
+  char		utf8[4];		// UTF-8 character
+  size_t	utf8len;		// Length of UTF-8 character
+
+
+  while (s < end)
+  {
+    if (*s == '<')
+    {
+      // Skip element...
+      if (s > start)
+        text_write(state, start, (size_t)(s - start));
+
+      while (s < end && *s != '>')
+        s ++;
+
+      if (s < end)
+        s ++;
+
+      start = s;
+    }
+    else if (*s == '&' && (semi = memchr(s, ';', (size_t)(end - s))) != NULL)
+    {
+      // Convert entity...
+      if (s > start)
+        text_write(state, start, (size_t)(s - start));
+
+      code = 0;
+
+      if (s[1] == '#' && (s[2] == 'x' || s[2] == 'X'))
+      {
+        code = (unsigned)strtoul(s + 3, NULL, 16);
+      }
+      else if (s[1] == '#')
+      {
+        code = (unsigned)strtoul(s + 2, NULL, 10);
+      }
+      else
+      {
+        // Named entities are looked up with a binary search...
+        size_t	namelen = (size_t)(semi - s - 1),
+					// Length of name
+		left = 0,		// Left side of search
+		right = sizeof(man_entities) / sizeof(man_entities[0]),
+					// Right side of search
+		current;		// Current entry
+	int	result;			// Result of comparison
+
+        while (left < right)
+        {
+          current = (left + right) / 2;
+
+          if ((result = strncmp(s + 1, man_entities[current].name, namelen)) == 0 && man_entities[current].name[namelen])
+            result = -1;
+
+          if (result == 0)
+          {
+            code = man_entities[current].code;
+            break;
+          }
+          else if (result < 0)
+          {
+            right = current;
+          }
+          else
+          {
+            left = current + 1;
+          }
+        }
+      }
+
+      if (code > 0 && code < 0x80)
+      {
+        utf8[0] = (char)code;
+        utf8len = 1;
+      }
+      else if (code > 0 && code < 0x800)
+      {
+        utf8[0] = (char)(0xc0 | (code >> 6));
+        utf8[1] = (char)(0x80 | (code & 0x3f));
+        utf8len = 2;
+      }
+      else if (code > 0 && code < 0x10000)
+      {
+        utf8[0] = (char)(0xe0 | (code >> 12));
+        utf8[1] = (char)(0x80 | ((code >> 6) & 0x3f));
+        utf8[2] = (char)(0x80 | (code & 0x3f));
+        utf8len = 3;
+      }
+      else if (code > 0 && code < 0x110000)
+      {
+        utf8[0] = (char)(0xf0 | (code >> 18));
+        utf8[1] = (char)(0x80 | ((code >> 12) & 0x3f));
+        utf8[2] = (char)(0x80 | ((code >> 6) & 0x3f));
+        utf8[3] = (char)(0x80 | (code & 0x3f));
+        utf8len = 4;
+      }
+      else
+      {
+        // Unknown entity, copy it as-is...
+        start = s;
+        s     = semi + 1;
+        continue;
+      }
+
+      text_write(state, utf8, utf8len);
+
+      s     = semi + 1;
+      start = s;
+    }
+    else
+    {
+      s ++;
+    }
+  }
+
+  if (s > start)
+    text_write(state, start, (size_t)(s - start));
+}
+
+
+//
+// 'text_node()' - Write the plain text for a list of nodes.
+//
+// Blocks and headings are separated by blank lines and list items start on a
+// new line.  Font changes, links, and indentation are not shown.
+//
+
+static bool				// O - `true` on success, `false` on error
+text_node(man_state_t *state,		// I - Current man state
+          man_node_t  *node)		// I - First node
+{
+  for (; node; node = node->next)
+  {
+    switch (node->type)
+    {
+      case MAN_NODE_ROOT :
+      case MAN_NODE_ANCHOR :
+      case MAN_NODE_FONT :
+      case MAN_NODE_HEADER :
+      case MAN_NODE_INDENT :
+      case MAN_NODE_LINK :
+      case MAN_NODE_LINK_END :
+      case MAN_NODE_UNINDENT :
+          break;
+
+      case MAN_NODE_BLOCK :
+          if (node->value != MAN_BLOCK_NONE)
+            text_sep(state, 2);
+
+          if (!text_node(state, node->child))
+            return (false);
+
+          if (node->closed)
+            text_sep(state, 1);
+          break;
+
+      case MAN_NODE_BREAK :
+          text_write(state, "\n", 1);
+          break;
+
+      case MAN_NODE_HEADING :
+          text_sep(state, 2);
+
+          if (!text_node(state, node->child))
+            return (false);
+
+          text_sep(state, 1);
+          break;
+
+      case MAN_NODE_HTML :
+          text_html(state, node->text, node->textlen);
+          break;
+
+      case MAN_NODE_ITEM :
+          text_sep(state, 1);
+
+          if (!text_node(state, node->child))
+            return (false);
+          break;
+
+      case MAN_NODE_SPACE :
+          text_sep(state, 2);
+          break;
+
+      case MAN_NODE_TEXT :
+          text_write(state, node->text, node->textlen);
+          break;
+    }
+  }
+
+  return (true);
+}
+
+
+//
+// 'text_sep()' - End the current line of text and add blank lines as needed.
+//
+// Nothing is written at the start of the text output.
+//
+
+static void
+text_sep(man_state_t *state,		// I - Current man state
+         int         newlines)		// I - Number of newlines needed
+{
+  if (state->text_nl < 0)
+    return;
+
+  while (state->text_nl < newlines)
+  {
+    mantohtml_sink_putc(state->out, '\n');
+    state->text_nl ++;
+  }
+}
+
+
+//
+// 'text_write()' - Output a literal string as text or in a JSON string.
+//
+// Blank lines in the text output are collapsed.
+//
+
+static void
+text_write(man_state_t *state,		// I - Current man state
+           const char  *s,		// I - String
+           size_t      len)		// I - Length of string
+{
+  size_t	trailing;		// Number of trailing newlines
+
+
+  if (state->format == MANTOHTML_FORMAT_JSON)
+  {
+    json_write(state, s, len);
+    return;
+  }
+
+  // Skip newlines at the start of the output and after a blank line...
+  while (len > 0 && *s == '\n' && (state->text_nl < 0 || state->text_nl >= 2))
+  {
+    s ++;
+    len --;
+  }
+
+  if (len == 0)
+    return;
+
+  mantohtml_sink_write(state->out, s, len);
+
+  for (trailing = 0; trailing < len && s[len - trailing - 1] == '\n'; trailing ++);
+
+  if (trailing == len)
+    state->text_nl += (int)trailing;
+  else
+    state->text_nl = (int)trailing;
+}
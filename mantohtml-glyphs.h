@@ -0,0 +1,648 @@
+//
+// Special character table for the man page to HTML conversion library.
+//
+// Copyright © 2022-2023 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.
+// <https://opensource.org/licenses/Apache-2.0>
+//
+// The table covers the special characters documented in groff_char(7).  Two
+// character names are packed with MAN_GLYPH() and stored in an open-addressed
+// hash table: each entry lives at MAN_GLYPH_HASH() of its name or, if that
+// slot is taken, in the next free slot.  Longer names are kept in a small
+// table sorted by name.  The named HTML entities used by both tables are kept
+// in a table sorted by name with their Unicode code points, for the JSON and
+// plain text output.
+//
+
+#ifndef MANTOHTML_GLYPHS_H
+#  define MANTOHTML_GLYPHS_H
+
+
+//
+// Constants...
+//
+
+#  define MAN_GLYPH(a,b)	((unsigned)((((a) & 255) << 8) | ((b) & 255)))
+					// Pack a two character name
+#  define MAN_GLYPH_HASH(key)	((((unsigned)(key)) * 2654435761U) >> 22)
+					// Hash a packed name
+#  define MAN_GLYPH_SIZE	1024	// Size of hash table (must match MAN_GLYPH_HASH)
+
+
+//
+// Types...
+//
+
+typedef struct man_glyph_s		// Two character special character
+{
+  unsigned	key;			// Packed name or 0 for an empty slot
+  const char	*html;			// HTML text
+} man_glyph_t;
+
+typedef struct man_lglyph_s		// Long name special character
+{
+  const char	*name;			// Name
+  const char	*html;			// HTML text
+} man_lglyph_t;
+
+typedef struct man_entity_s		// Named HTML entity
+{
+  const char	*name;			// Name without "&" and ";"
+  unsigned	code;			// Unicode code point
+} man_entity_t;
+
+
+//
+// Tables...
+//
+
+static const man_glyph_t man_glyphs[MAN_GLYPH_SIZE] =
+{
+  [   3] = { MAN_GLYPH('o', 'a'), "&aring;" },
+  [   4] = { MAN_GLYPH('a', 'n'), "&#9135;" },
+  [   5] = { MAN_GLYPH('~', '='), "&asymp;" },
+  [   7] = { MAN_GLYPH('w', 'p'), "&weierp;" },
+  [   9] = { MAN_GLYPH('/', 'O'), "&Oslash;" },
+  [  14] = { MAN_GLYPH('^', 'E'), "&Ecirc;" },
+  [  15] = { MAN_GLYPH('r', 'u'), "_" },
+  [  16] = { MAN_GLYPH('*', 'T'), "&Tau;" },
+  [  18] = { MAN_GLYPH('p', 'l'), "+" },
+  [  22] = { MAN_GLYPH('n', 'c'), "&#8837;" },
+  [  27] = { MAN_GLYPH('-', 'h'), "&#8463;" },
+  [  29] = { MAN_GLYPH('c', '+'), "&oplus;" },
+  [  31] = { MAN_GLYPH('t', 'i'), "~" },
+  [  33] = { MAN_GLYPH('a', '"'), "&#733;" },
+  [  51] = { MAN_GLYPH('*', 'a'), "&alpha;" },
+  [  54] = { MAN_GLYPH('\'', 'o'), "&oacute;" },
+  [  55] = { MAN_GLYPH('f', 'a'), "&forall;" },
+  [  56] = { MAN_GLYPH('c', 'o'), "&copy;" },
+  [  60] = { MAN_GLYPH('*', '*'), "&lowast;" },
+  [  64] = { MAN_GLYPH('F', 'i'), "&#64259;" },
+  [  71] = { MAN_GLYPH('-', '>'), "&rarr;" },
+  [  73] = { MAN_GLYPH('*', 'L'), "&Lambda;" },
+  [  75] = { MAN_GLYPH('p', 'd'), "&part;" },
+  [  76] = { MAN_GLYPH('b', 'q'), "&sbquo;" },
+  [  86] = { MAN_GLYPH('<', '<'), "&#8810;" },
+  [  87] = { MAN_GLYPH('*', 'n'), "&nu;" },
+  [  93] = { MAN_GLYPH('d', 'e'), "&deg;" },
+  [  94] = { MAN_GLYPH('=', '~'), "&cong;" },
+  [  97] = { MAN_GLYPH('\'', 'E'), "&Eacute;" },
+  [  98] = { MAN_GLYPH('l', 't'), "&#9127;" },
+  [  99] = { MAN_GLYPH('5', '8'), "&#8541;" },
+  [ 101] = { MAN_GLYPH('r', '!'), "&iexcl;" },
+  [ 103] = { MAN_GLYPH(':', 'U'), "&Uuml;" },
+  [ 104] = { MAN_GLYPH('u', 'l'), "_" },
+  [ 108] = { MAN_GLYPH('s', 'c'), "&sect;" },
+  [ 109] = { MAN_GLYPH('*', 'Y'), "&Eta;" },
+  [ 114] = { MAN_GLYPH('r', 'C'), "}" },
+  [ 115] = { MAN_GLYPH('`', 'u'), "&ugrave;" },
+  [ 117] = { MAN_GLYPH('a', '^'), "^" },
+  [ 130] = { MAN_GLYPH('*', 'D'), "&Delta;" },
+  [ 132] = { MAN_GLYPH('~', 'O'), "&Otilde;" },
+  [ 133] = { MAN_GLYPH('+', '-'), "&plusmn;" },
+  [ 138] = { MAN_GLYPH('>', '='), "&ge;" },
+  [ 141] = { MAN_GLYPH('h', 'o'), "&#731;" },
+  [ 143] = { MAN_GLYPH('B', 'q'), "&bdquo;" },
+  [ 144] = { MAN_GLYPH('s', 'p'), "&sup;" },
+  [ 145] = { MAN_GLYPH('*', 'f'), "&#981;" },
+  [ 146] = { MAN_GLYPH('f', 'f'), "&#64256;" },
+  [ 148] = { MAN_GLYPH('c', 't'), "&cent;" },
+  [ 154] = { MAN_GLYPH('f', '/'), "&frasl;" },
+  [ 156] = { MAN_GLYPH('F', 'n'), "&fnof;" },
+  [ 159] = { MAN_GLYPH('/', 'L'), "&#321;" },
+  [ 162] = { MAN_GLYPH('O', 'f'), "&ordf;" },
+  [ 166] = { MAN_GLYPH('*', 'Q'), "&Psi;" },
+  [ 168] = { MAN_GLYPH('b', 'v'), "&#9130;" },
+  [ 174] = { MAN_GLYPH(':', 'o'), "&ouml;" },
+  [ 179] = { MAN_GLYPH('*', 's'), "&sigma;" },
+  [ 180] = { MAN_GLYPH('t', 'f'), "&there4;" },
+  [ 181] = { MAN_GLYPH('~', '~'), "&asymp;" },
+  [ 189] = { MAN_GLYPH('I', 'm'), "&image;" },
+  [ 190] = { MAN_GLYPH('b', 'a'), "|" },
+  [ 194] = { MAN_GLYPH('3', '4'), "&frac34;" },
+  [ 195] = { MAN_GLYPH('R', 'e'), "&real;" },
+  [ 198] = { MAN_GLYPH('v', 'Z'), "&#381;" },
+  [ 199] = { MAN_GLYPH('^', 'O'), "&Ocirc;" },
+  [ 200] = { MAN_GLYPH('l', 'B'), "[" },
+  [ 201] = { MAN_GLYPH('s', 'h'), "#" },
+  [ 202] = { MAN_GLYPH('C', 'R'), "&crarr;" },
+  [ 203] = { MAN_GLYPH('e', 'u'), "&euro;" },
+  [ 207] = { MAN_GLYPH('n', 'm'), "&notin;" },
+  [ 210] = { MAN_GLYPH('a', 'c'), "&cedil;" },
+  [ 216] = { MAN_GLYPH('t', 's'), "&sigmaf;" },
+  [ 218] = { MAN_GLYPH(':', 'E'), "&Euml;" },
+  [ 223] = { MAN_GLYPH('*', 'I'), "&Iota;" },
+  [ 227] = { MAN_GLYPH('m', 'o'), "&isin;" },
+  [ 230] = { MAN_GLYPH('`', 'e'), "&egrave;" },
+  [ 231] = { MAN_GLYPH('o', 'A'), "&Aring;" },
+  [ 233] = { MAN_GLYPH('1', '8'), "&#8539;" },
+  [ 236] = { MAN_GLYPH('*', 'k'), "&kappa;" },
+  [ 239] = { MAN_GLYPH('\'', 'y'), "&yacute;" },
+  [ 245] = { MAN_GLYPH('a', 'p'), "&sim;" },
+  [ 247] = { MAN_GLYPH('l', 'q'), "&ldquo;" },
+  [ 252] = { MAN_GLYPH('H', 'E'), "&hearts;" },
+  [ 258] = { MAN_GLYPH('e', 'm'), "&mdash;" },
+  [ 259] = { MAN_GLYPH('~', 'a'), "&atilde;" },
+  [ 264] = { MAN_GLYPH('n', 'e'), "&#8802;" },
+  [ 268] = { MAN_GLYPH('E', 'u'), "&euro;" },
+  [ 269] = { MAN_GLYPH('^', 'i'), "&icirc;" },
+  [ 271] = { MAN_GLYPH('i', 'j'), "&#307;" },
+  [ 272] = { MAN_GLYPH('*', 'x'), "&chi;" },
+  [ 275] = { MAN_GLYPH('g', 'a'), "`" },
+  [ 276] = { MAN_GLYPH('S', '1'), "&sup1;" },
+  [ 277] = { MAN_GLYPH('r', 'b'), "&#9133;" },
+  [ 280] = { MAN_GLYPH('*', 'A'), "&Alpha;" },
+  [ 282] = { MAN_GLYPH('\'', 'O'), "&Oacute;" },
+  [ 293] = { MAN_GLYPH('*', 'c'), "&xi;" },
+  [ 294] = { MAN_GLYPH('~', 'n'), "&ntilde;" },
+  [ 295] = { MAN_GLYPH('f', 'c'), "&rsaquo;" },
+  [ 298] = { MAN_GLYPH('c', 'q'), "&rsquo;" },
+  [ 299] = { MAN_GLYPH('A', 'N'), "&and;" },
+  [ 302] = { MAN_GLYPH('a', 'h'), "&#711;" },
+  [ 310] = { MAN_GLYPH('u', 'a'), "&uarr;" },
+  [ 315] = { MAN_GLYPH('*', 'N'), "&Nu;" },
+  [ 326] = { MAN_GLYPH('^', 'a'), "&acirc;" },
+  [ 327] = { MAN_GLYPH('h', 'y'), "&#8208;" },
+  [ 328] = { MAN_GLYPH('<', '>'), "&harr;" },
+  [ 329] = { MAN_GLYPH('i', 'b'), "&sube;" },
+  [ 330] = { MAN_GLYPH('*', 'p'), "&pi;" },
+  [ 334] = { MAN_GLYPH('-', '+'), "&#8723;" },
+  [ 335] = { MAN_GLYPH('d', 'g'), "&dagger;" },
+  [ 344] = { MAN_GLYPH('`', 'U'), "&Ugrave;" },
+  [ 345] = { MAN_GLYPH('D', 'o'), "$" },
+  [ 352] = { MAN_GLYPH('p', 's'), "&para;" },
+  [ 353] = { MAN_GLYPH('\'', 'i'), "&iacute;" },
+  [ 355] = { MAN_GLYPH('c', 'i'), "&#9675;" },
+  [ 359] = { MAN_GLYPH(':', 'y'), "&yuml;" },
+  [ 361] = { MAN_GLYPH('l', 'a'), "&#10216;" },
+  [ 362] = { MAN_GLYPH('F', 'c'), "&raquo;" },
+  [ 366] = { MAN_GLYPH('+', 'f'), "&phi;" },
+  [ 369] = { MAN_GLYPH('A', 'h'), "&alefsym;" },
+  [ 370] = { MAN_GLYPH('r', 'g'), "&reg;" },
+  [ 372] = { MAN_GLYPH('*', 'F'), "&Phi;" },
+  [ 385] = { MAN_GLYPH('s', 'r'), "&radic;" },
+  [ 386] = { MAN_GLYPH('*', 'h'), "&theta;" },
+  [ 402] = { MAN_GLYPH(':', 'O'), "&Ouml;" },
+  [ 405] = { MAN_GLYPH('r', 't'), "&#9131;" },
+  [ 407] = { MAN_GLYPH('*', 'S'), "&Sigma;" },
+  [ 410] = { MAN_GLYPH('\'', 'a'), "&aacute;" },
+  [ 412] = { MAN_GLYPH('c', 'a'), "&cap;" },
+  [ 414] = { MAN_GLYPH('`', 'o'), "&ograve;" },
+  [ 415] = { MAN_GLYPH('n', 'b'), "&nsub;" },
+  [ 420] = { MAN_GLYPH('c', '*'), "&otimes;" },
+  [ 421] = { MAN_GLYPH('*', 'u'), "&upsilon;" },
+  [ 432] = { MAN_GLYPH('T', 'p'), "&thorn;" },
+  [ 433] = { MAN_GLYPH('m', 'd'), "&sdot;" },
+  [ 439] = { MAN_GLYPH('S', 'P'), "&spades;" },
+  [ 449] = { MAN_GLYPH('n', 'o'), "&not;" },
+  [ 451] = { MAN_GLYPH('a', 'e'), "&aelig;" },
+  [ 453] = { MAN_GLYPH('l', 'f'), "&lfloor;" },
+  [ 458] = { MAN_GLYPH('`', 'E'), "&Egrave;" },
+  [ 460] = { MAN_GLYPH('a', '.'), "&#729;" },
+  [ 464] = { MAN_GLYPH('*', 'K'), "&Kappa;" },
+  [ 466] = { MAN_GLYPH('p', 'c'), "&middot;" },
+  [ 467] = { MAN_GLYPH('\'', 'Y'), "&Yacute;" },
+  [ 473] = { MAN_GLYPH(':', 'i'), "&iuml;" },
+  [ 478] = { MAN_GLYPH('*', 'm'), "&mu;" },
+  [ 480] = { MAN_GLYPH('f', 'm'), "&prime;" },
+  [ 483] = { MAN_GLYPH('O', 'K'), "&#10003;" },
+  [ 484] = { MAN_GLYPH('d', 'd'), "&Dagger;" },
+  [ 486] = { MAN_GLYPH('o', 'e'), "&oelig;" },
+  [ 487] = { MAN_GLYPH('~', 'A'), "&Atilde;" },
+  [ 491] = { MAN_GLYPH('.', 'j'), "&#567;" },
+  [ 496] = { MAN_GLYPH('O', 'm'), "&ordm;" },
+  [ 497] = { MAN_GLYPH('h', 'a'), "^" },
+  [ 498] = { MAN_GLYPH('^', 'I'), "&Icirc;" },
+  [ 499] = { MAN_GLYPH('s', 'b'), "&sub;" },
+  [ 500] = { MAN_GLYPH('*', 'X'), "&Chi;" },
+  [ 501] = { MAN_GLYPH('C', 'L'), "&clubs;" },
+  [ 502] = { MAN_GLYPH('p', 'p'), "&perp;" },
+  [ 505] = { MAN_GLYPH('r', 'B'), "]" },
+  [ 513] = { MAN_GLYPH('*', 'z'), "&zeta;" },
+  [ 515] = { MAN_GLYPH('t', 'm'), "<sup>TM</sup>" },
+  [ 518] = { MAN_GLYPH('S', '3'), "&sup3;" },
+  [ 520] = { MAN_GLYPH('d', 'q'), "&quot;" },
+  [ 521] = { MAN_GLYPH('o', 'r'), "|" },
+  [ 522] = { MAN_GLYPH('*', 'C'), "&Xi;" },
+  [ 523] = { MAN_GLYPH('~', 'N'), "&Ntilde;" },
+  [ 526] = { MAN_GLYPH('m', 'i'), "&minus;" },
+  [ 530] = { MAN_GLYPH(':', 'a'), "&auml;" },
+  [ 532] = { MAN_GLYPH('v', 'a'), "&#8597;" },
+  [ 533] = { MAN_GLYPH('1', '2'), "&frac12;" },
+  [ 535] = { MAN_GLYPH('*', 'e'), "&epsilon;" },
+  [ 538] = { MAN_GLYPH('u', 'A'), "&uArr;" },
+  [ 541] = { MAN_GLYPH('7', '8'), "&#8542;" },
+  [ 546] = { MAN_GLYPH('l', 'k'), "&#9128;" },
+  [ 550] = { MAN_GLYPH('+', 'p'), "&piv;" },
+  [ 554] = { MAN_GLYPH('r', 'q'), "&rdquo;" },
+  [ 555] = { MAN_GLYPH('^', 'A'), "&Acirc;" },
+  [ 557] = { MAN_GLYPH('*', 'P'), "&Pi;" },
+  [ 559] = { MAN_GLYPH('b', 'u'), "&middot;" },
+  [ 566] = { MAN_GLYPH('I', 'J'), "&#306;" },
+  [ 570] = { MAN_GLYPH('*', 'r'), "&rho;" },
+  [ 572] = { MAN_GLYPH('t', 'e'), "&exist;" },
+  [ 577] = { MAN_GLYPH('d', 'i'), "&divide;" },
+  [ 581] = { MAN_GLYPH('\'', 'I'), "&Iacute;" },
+  [ 584] = { MAN_GLYPH('|', '='), "&#8771;" },
+  [ 587] = { MAN_GLYPH(':', 'Y'), "&Yuml;" },
+  [ 589] = { MAN_GLYPH('l', 'A'), "&lArr;" },
+  [ 601] = { MAN_GLYPH('a', 'b'), "&#728;" },
+  [ 603] = { MAN_GLYPH('l', 'c'), "&lceil;" },
+  [ 607] = { MAN_GLYPH('C', 's'), "&curren;" },
+  [ 608] = { MAN_GLYPH('+', 'h'), "&thetasym;" },
+  [ 614] = { MAN_GLYPH('*', 'H'), "&Theta;" },
+  [ 627] = { MAN_GLYPH('s', 't'), "&ni;" },
+  [ 634] = { MAN_GLYPH('d', 'a'), "&darr;" },
+  [ 636] = { MAN_GLYPH('a', 'o'), "&#730;" },
+  [ 638] = { MAN_GLYPH('\'', 'A'), "&Aacute;" },
+  [ 643] = { MAN_GLYPH('`', 'O'), "&Ograve;" },
+  [ 649] = { MAN_GLYPH('*', 'U'), "&Upsilon;" },
+  [ 651] = { MAN_GLYPH('\'', 'c'), "&#263;" },
+  [ 655] = { MAN_GLYPH('r', '?'), "&iquest;" },
+  [ 660] = { MAN_GLYPH('v', 's'), "&scaron;" },
+  [ 661] = { MAN_GLYPH('T', 'P'), "&THORN;" },
+  [ 663] = { MAN_GLYPH('*', 'w'), "&omega;" },
+  [ 668] = { MAN_GLYPH('r', 'a'), "&#10217;" },
+  [ 677] = { MAN_GLYPH('3', '8'), "&#8540;" },
+  [ 684] = { MAN_GLYPH('s', 'l'), "/" },
+  [ 685] = { MAN_GLYPH('*', 'b'), "&beta;" },
+  [ 695] = { MAN_GLYPH('l', 'h'), "&#9756;" },
+  [ 696] = { MAN_GLYPH('^', 'u'), "&ucirc;" },
+  [ 699] = { MAN_GLYPH('%', '0'), "&permil;" },
+  [ 701] = { MAN_GLYPH(':', 'I'), "&Iuml;" },
+  [ 704] = { MAN_GLYPH('r', 'n'), "&oline;" },
+  [ 706] = { MAN_GLYPH('*', 'M'), "&Mu;" },
+  [ 709] = { MAN_GLYPH('b', 'r'), "&#9474;" },
+  [ 713] = { MAN_GLYPH('`', 'i'), "&igrave;" },
+  [ 718] = { MAN_GLYPH('<', '='), "&le;" },
+  [ 720] = { MAN_GLYPH('*', 'o'), "&omicron;" },
+  [ 722] = { MAN_GLYPH('f', 'o'), "&lsaquo;" },
+  [ 724] = { MAN_GLYPH('Y', 'e'), "&yen;" },
+  [ 726] = { MAN_GLYPH('h', 'A'), "&hArr;" },
+  [ 728] = { MAN_GLYPH('a', 't'), "@" },
+  [ 737] = { MAN_GLYPH(',', 'c'), "&ccedil;" },
+  [ 741] = { MAN_GLYPH('s', 'd'), "&Prime;" },
+  [ 742] = { MAN_GLYPH('e', 'q'), "=" },
+  [ 743] = { MAN_GLYPH('*', 'Z'), "&Zeta;" },
+  [ 747] = { MAN_GLYPH('A', 'E'), "&AElig;" },
+  [ 757] = { MAN_GLYPH('+', 'e'), "&#1013;" },
+  [ 758] = { MAN_GLYPH(':', 'A'), "&Auml;" },
+  [ 760] = { MAN_GLYPH('v', 'A'), "&#8661;" },
+  [ 761] = { MAN_GLYPH('r', 'f'), "&rfloor;" },
+  [ 763] = { MAN_GLYPH('*', 'E'), "&Epsilon;" },
+  [ 770] = { MAN_GLYPH('`', 'a'), "&agrave;" },
+  [ 771] = { MAN_GLYPH('>', '>'), "&#8811;" },
+  [ 774] = { MAN_GLYPH('1', '4'), "&frac14;" },
+  [ 776] = { MAN_GLYPH('s', 'q'), "&#9633;" },
+  [ 777] = { MAN_GLYPH('*', 'g'), "&gamma;" },
+  [ 779] = { MAN_GLYPH('\'', 'u'), "&uacute;" },
+  [ 781] = { MAN_GLYPH('c', 'u'), "&cup;" },
+  [ 782] = { MAN_GLYPH('O', 'E'), "&OElig;" },
+  [ 789] = { MAN_GLYPH('F', 'o'), "&laquo;" },
+  [ 794] = { MAN_GLYPH('g', 'r'), "&nabla;" },
+  [ 796] = { MAN_GLYPH('-', 'D'), "&ETH;" },
+  [ 797] = { MAN_GLYPH('r', 's'), "\\" },
+  [ 798] = { MAN_GLYPH('*', 'R'), "&Rho;" },
+  [ 805] = { MAN_GLYPH('/', 'o'), "&oslash;" },
+  [ 808] = { MAN_GLYPH('S', 'd'), "&eth;" },
+  [ 810] = { MAN_GLYPH('^', 'e'), "&ecirc;" },
+  [ 812] = { MAN_GLYPH('i', 'f'), "&infin;" },
+  [ 813] = { MAN_GLYPH('*', 't'), "&tau;" },
+  [ 817] = { MAN_GLYPH('O', 'R'), "&or;" },
+  [ 823] = { MAN_GLYPH('b', 'b'), "&brvbar;" },
+  [ 824] = { MAN_GLYPH('l', 'z'), "&loz;" },
+  [ 825] = { MAN_GLYPH('m', 'c'), "&mu;" },
+  [ 831] = { MAN_GLYPH('l', 'C'), "{" },
+  [ 833] = { MAN_GLYPH('<', '-'), "&larr;" },
+  [ 843] = { MAN_GLYPH('a', 'd'), "&uml;" },
+  [ 847] = { MAN_GLYPH('i', 's'), "&int;" },
+  [ 851] = { MAN_GLYPH('a', '-'), "&macr;" },
+  [ 853] = { MAN_GLYPH('r', 'k'), "&#9132;" },
+  [ 862] = { MAN_GLYPH('d', 'A'), "&dArr;" },
+  [ 869] = { MAN_GLYPH('*', 'l'), "&lambda;" },
+  [ 871] = { MAN_GLYPH('f', 'l'), "&#64258;" },
+  [ 872] = { MAN_GLYPH('!', '='), "&ne;" },
+  [ 873] = { MAN_GLYPH('D', 'I'), "&diams;" },
+  [ 875] = { MAN_GLYPH('3', 'd'), "&there4;" },
+  [ 878] = { MAN_GLYPH('a', 'q'), "'" },
+  [ 880] = { MAN_GLYPH('\'', 'C'), "&#262;" },
+  [ 882] = { MAN_GLYPH('.', 'i'), "&#305;" },
+  [ 888] = { MAN_GLYPH('v', 'S'), "&Scaron;" },
+  [ 891] = { MAN_GLYPH('e', 'n'), "&ndash;" },
+  [ 892] = { MAN_GLYPH('*', 'W'), "&Omega;" },
+  [ 893] = { MAN_GLYPH('\'', 'e'), "&eacute;" },
+  [ 897] = { MAN_GLYPH('r', 'A'), "&rArr;" },
+  [ 899] = { MAN_GLYPH(':', 'u'), "&uuml;" },
+  [ 904] = { MAN_GLYPH('*', 'y'), "&eta;" },
+  [ 909] = { MAN_GLYPH('S', '2'), "&sup2;" },
+  [ 910] = { MAN_GLYPH('r', 'c'), "&rceil;" },
+  [ 913] = { MAN_GLYPH('a', '~'), "~" },
+  [ 914] = { MAN_GLYPH('o', 'q'), "&lsquo;" },
+  [ 915] = { MAN_GLYPH('*', 'B'), "&Beta;" },
+  [ 919] = { MAN_GLYPH('/', '_'), "&ang;" },
+  [ 924] = { MAN_GLYPH('^', 'U'), "&Ucirc;" },
+  [ 926] = { MAN_GLYPH('*', 'd'), "&delta;" },
+  [ 927] = { MAN_GLYPH('~', 'o'), "&otilde;" },
+  [ 938] = { MAN_GLYPH('F', 'l'), "&#64260;" },
+  [ 940] = { MAN_GLYPH('=', '='), "&equiv;" },
+  [ 941] = { MAN_GLYPH('`', 'I'), "&Igrave;" },
+  [ 948] = { MAN_GLYPH('*', 'O'), "&Omicron;" },
+  [ 952] = { MAN_GLYPH('m', 'u'), "&times;" },
+  [ 954] = { MAN_GLYPH('/', 'l'), "&#322;" },
+  [ 960] = { MAN_GLYPH('P', 'o'), "&pound;" },
+  [ 961] = { MAN_GLYPH('*', 'q'), "&psi;" },
+  [ 965] = { MAN_GLYPH(',', 'C'), "&Ccedil;" },
+  [ 983] = { MAN_GLYPH('e', 's'), "&empty;" },
+  [ 985] = { MAN_GLYPH('p', 't'), "&prop;" },
+  [ 992] = { MAN_GLYPH('a', 'a'), "&acute;" },
+  [ 994] = { MAN_GLYPH('^', 'o'), "&ocirc;" },
+  [ 995] = { MAN_GLYPH('v', 'z'), "&#382;" },
+  [ 996] = { MAN_GLYPH('l', 'b'), "&#9129;" },
+  [ 997] = { MAN_GLYPH('i', 'p'), "&supe;" },
+  [ 998] = { MAN_GLYPH('`', 'A'), "&Agrave;" },
+  [1002] = { MAN_GLYPH('r', 'h'), "&#9758;" },
+  [1005] = { MAN_GLYPH('*', 'G'), "&Gamma;" },
+  [1007] = { MAN_GLYPH('\'', 'U'), "&Uacute;" },
+  [1013] = { MAN_GLYPH(':', 'e'), "&euml;" },
+  [1018] = { MAN_GLYPH('s', 's'), "&szlig;" },
+  [1019] = { MAN_GLYPH('*', 'i'), "&iota;" },
+  [1020] = { MAN_GLYPH('f', 'i'), "&#64257;" },
+};
+
+static const man_lglyph_t man_lglyphs[] =
+{
+  { "braceex", "&#9130;" },
+  { "braceleftbt", "&#9129;" },
+  { "braceleftex", "&#9130;" },
+  { "braceleftmid", "&#9128;" },
+  { "bracelefttp", "&#9127;" },
+  { "bracerightbt", "&#9133;" },
+  { "bracerightex", "&#9130;" },
+  { "bracerightmid", "&#9132;" },
+  { "bracerighttp", "&#9131;" },
+  { "bracketleftbt", "&#9123;" },
+  { "bracketleftex", "&#9122;" },
+  { "bracketlefttp", "&#9121;" },
+  { "bracketrightbt", "&#9126;" },
+  { "bracketrightex", "&#9125;" },
+  { "bracketrighttp", "&#9124;" },
+  { "coproduct", "&#8720;" },
+  { "hbar", "&#8463;" },
+  { "integral", "&int;" },
+  { "parenleftbt", "&#9117;" },
+  { "parenleftex", "&#9116;" },
+  { "parenlefttp", "&#9115;" },
+  { "parenrightbt", "&#9120;" },
+  { "parenrightex", "&#9119;" },
+  { "parenrighttp", "&#9118;" },
+  { "product", "&prod;" },
+  { "sqrt", "&radic;" },
+  { "sum", "&sum;" },
+  { "t+-", "&plusmn;" },
+  { "tdi", "&divide;" },
+  { "tmu", "&times;" },
+  { "tno", "&not;" },
+};
+
+static const man_entity_t man_entities[] =
+{
+  { "AElig", 0x00C6 },
+  { "Aacute", 0x00C1 },
+  { "Acirc", 0x00C2 },
+  { "Agrave", 0x00C0 },
+  { "Alpha", 0x0391 },
+  { "Aring", 0x00C5 },
+  { "Atilde", 0x00C3 },
+  { "Auml", 0x00C4 },
+  { "Beta", 0x0392 },
+  { "Ccedil", 0x00C7 },
+  { "Chi", 0x03A7 },
+  { "Dagger", 0x2021 },
+  { "Delta", 0x0394 },
+  { "ETH", 0x00D0 },
+  { "Eacute", 0x00C9 },
+  { "Ecirc", 0x00CA },
+  { "Egrave", 0x00C8 },
+  { "Epsilon", 0x0395 },
+  { "Eta", 0x0397 },
+  { "Euml", 0x00CB },
+  { "Gamma", 0x0393 },
+  { "Iacute", 0x00CD },
+  { "Icirc", 0x00CE },
+  { "Igrave", 0x00CC },
+  { "Iota", 0x0399 },
+  { "Iuml", 0x00CF },
+  { "Kappa", 0x039A },
+  { "Lambda", 0x039B },
+  { "Mu", 0x039C },
+  { "Ntilde", 0x00D1 },
+  { "Nu", 0x039D },
+  { "OElig", 0x0152 },
+  { "Oacute", 0x00D3 },
+  { "Ocirc", 0x00D4 },
+  { "Ograve", 0x00D2 },
+  { "Omega", 0x03A9 },
+  { "Omicron", 0x039F },
+  { "Oslash", 0x00D8 },
+  { "Otilde", 0x00D5 },
+  { "Ouml", 0x00D6 },
+  { "Phi", 0x03A6 },
+  { "Pi", 0x03A0 },
+  { "Prime", 0x2033 },
+  { "Psi", 0x03A8 },
+  { "Rho", 0x03A1 },
+  { "Scaron", 0x0160 },
+  { "Sigma", 0x03A3 },
+  { "THORN", 0x00DE },
+  { "Tau", 0x03A4 },
+  { "Theta", 0x0398 },
+  { "Uacute", 0x00DA },
+  { "Ucirc", 0x00DB },
+  { "Ugrave", 0x00D9 },
+  { "Upsilon", 0x03A5 },
+  { "Uuml", 0x00DC },
+  { "Xi", 0x039E },
+  { "Yacute", 0x00DD },
+  { "Yuml", 0x0178 },
+  { "Zeta", 0x0396 },
+  { "aacute", 0x00E1 },
+  { "acirc", 0x00E2 },
+  { "acute", 0x00B4 },
+  { "aelig", 0x00E6 },
+  { "agrave", 0x00E0 },
+  { "alefsym", 0x2135 },
+  { "alpha", 0x03B1 },
+  { "amp", 0x0026 },
+  { "and", 0x2227 },
+  { "ang", 0x2220 },
+  { "aring", 0x00E5 },
+  { "asymp", 0x2248 },
+  { "atilde", 0x00E3 },
+  { "auml", 0x00E4 },
+  { "bdquo", 0x201E },
+  { "beta", 0x03B2 },
+  { "brvbar", 0x00A6 },
+  { "cap", 0x2229 },
+  { "ccedil", 0x00E7 },
+  { "cedil", 0x00B8 },
+  { "cent", 0x00A2 },
+  { "chi", 0x03C7 },
+  { "clubs", 0x2663 },
+  { "cong", 0x2245 },
+  { "copy", 0x00A9 },
+  { "crarr", 0x21B5 },
+  { "cup", 0x222A },
+  { "curren", 0x00A4 },
+  { "dArr", 0x21D3 },
+  { "dagger", 0x2020 },
+  { "darr", 0x2193 },
+  { "deg", 0x00B0 },
+  { "delta", 0x03B4 },
+  { "diams", 0x2666 },
+  { "divide", 0x00F7 },
+  { "eacute", 0x00E9 },
+  { "ecirc", 0x00EA },
+  { "egrave", 0x00E8 },
+  { "empty", 0x2205 },
+  { "epsilon", 0x03B5 },
+  { "equiv", 0x2261 },
+  { "eta", 0x03B7 },
+  { "eth", 0x00F0 },
+  { "euml", 0x00EB },
+  { "euro", 0x20AC },
+  { "exist", 0x2203 },
+  { "fnof", 0x0192 },
+  { "forall", 0x2200 },
+  { "frac12", 0x00BD },
+  { "frac14", 0x00BC },
+  { "frac34", 0x00BE },
+  { "frasl", 0x2044 },
+  { "gamma", 0x03B3 },
+  { "ge", 0x2265 },
+  { "gt", 0x003E },
+  { "hArr", 0x21D4 },
+  { "harr", 0x2194 },
+  { "hearts", 0x2665 },
+  { "iacute", 0x00ED },
+  { "icirc", 0x00EE },
+  { "iexcl", 0x00A1 },
+  { "igrave", 0x00EC },
+  { "image", 0x2111 },
+  { "infin", 0x221E },
+  { "int", 0x222B },
+  { "iota", 0x03B9 },
+  { "iquest", 0x00BF },
+  { "isin", 0x2208 },
+  { "iuml", 0x00EF },
+  { "kappa", 0x03BA },
+  { "lArr", 0x21D0 },
+  { "lambda", 0x03BB },
+  { "laquo", 0x00AB },
+  { "larr", 0x2190 },
+  { "lceil", 0x2308 },
+  { "ldquo", 0x201C },
+  { "le", 0x2264 },
+  { "lfloor", 0x230A },
+  { "lowast", 0x2217 },
+  { "loz", 0x25CA },
+  { "lsaquo", 0x2039 },
+  { "lsquo", 0x2018 },
+  { "lt", 0x003C },
+  { "macr", 0x00AF },
+  { "mdash", 0x2014 },
+  { "middot", 0x00B7 },
+  { "minus", 0x2212 },
+  { "mu", 0x03BC },
+  { "nabla", 0x2207 },
+  { "nbsp", 0x00A0 },
+  { "ndash", 0x2013 },
+  { "ne", 0x2260 },
+  { "ni", 0x220B },
+  { "not", 0x00AC },
+  { "notin", 0x2209 },
+  { "nsub", 0x2284 },
+  { "ntilde", 0x00F1 },
+  { "nu", 0x03BD },
+  { "oacute", 0x00F3 },
+  { "ocirc", 0x00F4 },
+  { "oelig", 0x0153 },
+  { "ograve", 0x00F2 },
+  { "oline", 0x203E },
+  { "omega", 0x03C9 },
+  { "omicron", 0x03BF },
+  { "oplus", 0x2295 },
+  { "or", 0x2228 },
+  { "ordf", 0x00AA },
+  { "ordm", 0x00BA },
+  { "oslash", 0x00F8 },
+  { "otilde", 0x00F5 },
+  { "otimes", 0x2297 },
+  { "ouml", 0x00F6 },
+  { "para", 0x00B6 },
+  { "part", 0x2202 },
+  { "permil", 0x2030 },
+  { "perp", 0x22A5 },
+  { "phi", 0x03C6 },
+  { "pi", 0x03C0 },
+  { "piv", 0x03D6 },
+  { "plusmn", 0x00B1 },
+  { "pound", 0x00A3 },
+  { "prime", 0x2032 },
+  { "prod", 0x220F },
+  { "prop", 0x221D },
+  { "psi", 0x03C8 },
+  { "quot", 0x0022 },
+  { "rArr", 0x21D2 },
+  { "radic", 0x221A },
+  { "raquo", 0x00BB },
+  { "rarr", 0x2192 },
+  { "rceil", 0x2309 },
+  { "rdquo", 0x201D },
+  { "real", 0x211C },
+  { "reg", 0x00AE },
+  { "rfloor", 0x230B },
+  { "rho", 0x03C1 },
+  { "rsaquo", 0x203A },
+  { "rsquo", 0x2019 },
+  { "sbquo", 0x201A },
+  { "scaron", 0x0161 },
+  { "sdot", 0x22C5 },
+  { "sect", 0x00A7 },
+  { "sigma", 0x03C3 },
+  { "sigmaf", 0x03C2 },
+  { "sim", 0x223C },
+  { "spades", 0x2660 },
+  { "sub", 0x2282 },
+  { "sube", 0x2286 },
+  { "sum", 0x2211 },
+  { "sup", 0x2283 },
+  { "sup1", 0x00B9 },
+  { "sup2", 0x00B2 },
+  { "sup3", 0x00B3 },
+  { "supe", 0x2287 },
+  { "szlig", 0x00DF },
+  { "tau", 0x03C4 },
+  { "there4", 0x2234 },
+  { "theta", 0x03B8 },
+  { "thetasym", 0x03D1 },
+  { "thorn", 0x00FE },
+  { "times", 0x00D7 },
+  { "uArr", 0x21D1 },
+  { "uacute", 0x00FA },
+  { "uarr", 0x2191 },
+  { "ucirc", 0x00FB },
+  { "ugrave", 0x00F9 },
+  { "uml", 0x00A8 },
+  { "upsilon", 0x03C5 },
+  { "uuml", 0x00FC },
+  { "weierp", 0x2118 },
+  { "xi", 0x03BE },
+  { "yacute", 0x00FD },
+  { "yen", 0x00A5 },
+  { "yuml", 0x00FF },
+  { "zeta", 0x03B6 },
+};
+
+
+#endif // !MANTOHTML_GLYPHS_H
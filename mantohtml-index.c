@@ -0,0 +1,625 @@
+//
+// Cross-reference index functions for the man page to HTML conversion library.
+//
+// Copyright © 2022-2023 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.
+// <https://opensource.org/licenses/Apache-2.0>
+//
+
+#include "mantohtml-private.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#if _WIN32
+#  include <windows.h>
+#else
+#  include <pthread.h>
+#endif // _WIN32
+
+
+//
+// Constants...
+//
+
+#define MAN_INDEX_SIZE	4096		// Number of hash buckets
+
+
+//
+// Local types...
+//
+
+typedef struct man_ianchor_s		// Index anchor
+{
+  int			level;		// Heading level (0 = topic, 1 = section, 2 = sub-section)
+  char			*id,		// Anchor ID
+			*title;		// Heading title (HTML)
+} man_ianchor_t;
+
+typedef struct man_ipage_s		// Index page
+{
+  struct man_ipage_s	*next;		// Next page in bucket
+  char			*key,		// "name(section)"
+			*filename,	// Man filename
+			*href;		// URL of HTML file
+  size_t		namelen,	// Length of name in key
+			num_anchors,	// Number of anchors
+			alloc_anchors;	// Allocated anchors
+  man_ianchor_t		*anchors;	// Anchors
+} man_ipage_t;
+
+struct mantohtml_index_s		// Cross-reference index
+{
+#if _WIN32
+  CRITICAL_SECTION	mutex;		// Mutex for index
+#else
+  pthread_mutex_t	mutex;		// Mutex for index
+#endif // _WIN32
+  size_t		num_pages,	// Number of pages
+			alloc_pages;	// Allocated pages
+  man_ipage_t		**pages;	// Pages in the order they were added
+  man_ipage_t		*buckets[MAN_INDEX_SIZE];
+					// Hash buckets
+};
+
+
+//
+// Local functions...
+//
+
+static int	index_compare(man_ipage_t **a, man_ipage_t **b);
+static man_ipage_t *index_find(mantohtml_index_t *index, const char *key);
+static size_t	index_hash(const char *key);
+static char	*index_key(const char *filename, char *buffer, size_t bufsize);
+static void	index_lock(mantohtml_index_t *index);
+static void	index_puts_html(mantohtml_sink_t *sink, const char *s);
+static void	index_unlock(mantohtml_index_t *index);
+
+
+//
+// 'mantohtml_index_add()' - Add a man page to a cross-reference index.
+//
+// The man page name and section come from the filename, for example
+// "/path/to/foo.3.gz" is "foo(3)".  References to the man page in the text of
+// any document using the index are linked to "href".  Pages are normally
+// added before any documents are converted so that references to pages that
+// are converted later are also linked.
+//
+// If a man page with the same name and section has already been added, the
+// existing page is kept.
+//
+
+bool					// O - `true` on success, `false` on error
+mantohtml_index_add(
+    mantohtml_index_t *index,		// I - Cross-reference index
+    const char        *filename,	// I - Man filename
+    const char        *href)		// I - URL of HTML file
+{
+  char		key[1024];		// "name(section)"
+  man_ipage_t	*page;			// New page
+  size_t	hash;			// Hash bucket
+
+
+  if (!index_key(filename, key, sizeof(key)))
+    return (false);
+
+  hash = index_hash(key);
+
+  index_lock(index);
+
+  if (index_find(index, key))
+  {
+    index_unlock(index);
+    return (true);
+  }
+
+  if (index->num_pages >= index->alloc_pages)
+  {
+    man_ipage_t	**temp;			// New pages array
+
+    if ((temp = realloc(index->pages, (index->alloc_pages + 1024) * sizeof(man_ipage_t *))) == NULL)
+    {
+      index_unlock(index);
+      return (false);
+    }
+
+    index->pages       = temp;
+    index->alloc_pages += 1024;
+  }
+
+  if ((page = calloc(1, sizeof(man_ipage_t))) == NULL || (page->key = strdup(key)) == NULL || (page->filename = strdup(filename)) == NULL || (page->href = strdup(href)) == NULL)
+  {
+    if (page)
+    {
+      free(page->key);
+      free(page->filename);
+      free(page);
+    }
+
+    index_unlock(index);
+    return (false);
+  }
+
+  page->namelen = (size_t)(strrchr(key, '(') - key);
+
+  index->pages[index->num_pages ++] = page;
+
+  page->next           = index->buckets[hash];
+  index->buckets[hash] = page;
+
+  index_unlock(index);
+
+  return (true);
+}
+
+
+//
+// 'mantohtml_index_delete()' - Free the memory used by a cross-reference index.
+//
+
+void
+mantohtml_index_delete(
+    mantohtml_index_t *index)		// I - Cross-reference index
+{
+  size_t	i,			// Looping var
+		j;			// Looping var
+  man_ipage_t	*page;			// Current page
+
+
+  if (!index)
+    return;
+
+  for (i = 0; i < index->num_pages; i ++)
+  {
+    page = index->pages[i];
+
+    for (j = 0; j < page->num_anchors; j ++)
+    {
+      free(page->anchors[j].id);
+      free(page->anchors[j].title);
+    }
+
+    free(page->anchors);
+    free(page->key);
+    free(page->filename);
+    free(page->href);
+    free(page);
+  }
+
+  free(index->pages);
+
+#if _WIN32
+  DeleteCriticalSection(&index->mutex);
+#else
+  pthread_mutex_destroy(&index->mutex);
+#endif // _WIN32
+
+  free(index);
+}
+
+
+//
+// 'mantohtml_index_new()' - Create a cross-reference index.
+//
+// A cross-reference index links "name(section)" references in the text of
+// man pages to the HTML files for those man pages, and collects the topic,
+// section, and sub-section anchors of each man page as it is converted.  The
+// index can be shared by any number of documents and threads using the
+// "index" member of @link mantohtml_options_t@.
+//
+
+mantohtml_index_t *			// O - Cross-reference index or `NULL` on error
+mantohtml_index_new(void)
+{
+  mantohtml_index_t	*index;		// Cross-reference index
+
+
+  if ((index = calloc(1, sizeof(mantohtml_index_t))) == NULL)
+    return (NULL);
+
+#if _WIN32
+  InitializeCriticalSection(&index->mutex);
+#else
+  pthread_mutex_init(&index->mutex, NULL);
+#endif // _WIN32
+
+  return (index);
+}
+
+
+//
+// 'mantohtml_index_write_html()' - Write a HTML index page.
+//
+// The index page lists each man page that has been converted, sorted by name
+// and section, with links to its sections.  The options are used for the HTML
+// header, with a default title of "Index".
+//
+
+bool					// O - `true` on success, `false` on error
+mantohtml_index_write_html(
+    mantohtml_index_t         *index,	// I - Cross-reference index
+    const mantohtml_options_t *options,	// I - Conversion options or `NULL` for defaults
+    mantohtml_sink_t          *sink)	// I - Output sink
+{
+  mantohtml_t	*doc;			// HTML document for header and footer
+  size_t	i,			// Looping var
+		j;			// Looping var
+  man_ipage_t	*page;			// Current page
+  bool		have_sections,		// Have any section anchors?
+		ret;			// Return value
+
+
+  if ((doc = mantohtml_new(options, sink)) == NULL)
+    return (false);
+
+  if ((ret = _mantohtml_header(doc, "Index")) == true)
+  {
+    index_lock(index);
+
+    if (index->num_pages > 1)
+      qsort(index->pages, index->num_pages, sizeof(man_ipage_t *), (int (*)(const void *, const void *))index_compare);
+
+    mantohtml_sink_puts(sink, "    <ul>\n");
+
+    for (i = 0; i < index->num_pages; i ++)
+    {
+      if ((page = index->pages[i])->num_anchors == 0)
+        continue;
+
+      mantohtml_sink_puts(sink, "      <li><a href=\"");
+      index_puts_html(sink, page->href);
+      mantohtml_sink_puts(sink, "\">");
+      index_puts_html(sink, page->key);
+      mantohtml_sink_puts(sink, "</a>");
+
+      for (j = 0, have_sections = false; j < page->num_anchors; j ++)
+      {
+        if (page->anchors[j].level != 1)
+          continue;
+
+        if (!have_sections)
+        {
+          mantohtml_sink_puts(sink, "<ul>\n");
+          have_sections = true;
+        }
+
+        mantohtml_sink_puts(sink, "        <li><a href=\"");
+        index_puts_html(sink, page->href);
+        mantohtml_sink_putc(sink, '#');
+        index_puts_html(sink, page->anchors[j].id);
+        mantohtml_sink_puts(sink, "\">");
+        mantohtml_sink_puts(sink, page->anchors[j].title);
+        mantohtml_sink_puts(sink, "</a></li>\n");
+      }
+
+      if (have_sections)
+        mantohtml_sink_puts(sink, "      </ul></li>\n");
+      else
+        mantohtml_sink_puts(sink, "</li>\n");
+    }
+
+    mantohtml_sink_puts(sink, "    </ul>\n");
+
+    index_unlock(index);
+
+    ret = mantohtml_finish(doc);
+  }
+
+  mantohtml_delete(doc);
+
+  return (ret);
+}
+
+
+//
+// 'mantohtml_index_write_json()' - Write a JSON index.
+//
+// The JSON index is an array with an object for each man page that has been
+// converted, sorted by name and section:
+//
+//     {"name":"foo","section":"3","href":"foo.3.html","anchors":[
+//     {"id":"foo-3","level":0,"title":"foo(3)"},...]}
+//
+// Anchor levels are 0 for topics, 1 for sections, and 2 for sub-sections.
+// Anchor titles are HTML.
+//
+
+bool					// O - `true` on success, `false` on error
+mantohtml_index_write_json(
+    mantohtml_index_t *index,		// I - Cross-reference index
+    mantohtml_sink_t  *sink)		// I - Output sink
+{
+  size_t	i,			// Looping var
+		j;			// Looping var
+  man_ipage_t	*page;			// Current page
+  bool		first = true;		// First page?
+
+
+  index_lock(index);
+
+  if (index->num_pages > 1)
+    qsort(index->pages, index->num_pages, sizeof(man_ipage_t *), (int (*)(const void *, const void *))index_compare);
+
+  mantohtml_sink_putc(sink, '[');
+
+  for (i = 0; i < index->num_pages; i ++)
+  {
+    if ((page = index->pages[i])->num_anchors == 0)
+      continue;
+
+    mantohtml_sink_puts(sink, first ? "\n{\"name\":" : ",\n{\"name\":");
+    first = false;
+
+    _mantohtml_sink_puts_json(sink, page->key, page->namelen);
+    mantohtml_sink_puts(sink, ",\"section\":");
+    _mantohtml_sink_puts_json(sink, page->key + page->namelen + 1, strlen(page->key + page->namelen + 1) - 1);
+    mantohtml_sink_puts(sink, ",\"href\":");
+    _mantohtml_sink_puts_json(sink, page->href, strlen(page->href));
+    mantohtml_sink_puts(sink, ",\"anchors\":[");
+
+    for (j = 0; j < page->num_anchors; j ++)
+    {
+      mantohtml_sink_puts(sink, j ? ",\n{\"id\":" : "\n{\"id\":");
+      _mantohtml_sink_puts_json(sink, page->anchors[j].id, strlen(page->anchors[j].id));
+      mantohtml_sink_printf(sink, ",\"level\":%d,\"title\":", page->anchors[j].level);
+      _mantohtml_sink_puts_json(sink, page->anchors[j].title, strlen(page->anchors[j].title));
+      mantohtml_sink_putc(sink, '}');
+    }
+
+    mantohtml_sink_puts(sink, "]}");
+  }
+
+  mantohtml_sink_puts(sink, "\n]\n");
+
+  index_unlock(index);
+
+  return (mantohtml_sink_flush(sink));
+}
+
+
+//
+// '_mantohtml_index_add_anchor()' - Add an anchor to a man page in an index.
+//
+// Anchors are only added for man pages that were added using
+// @link mantohtml_index_add@ with the same filename.
+//
+
+bool					// O - `true` on success, `false` on error
+_mantohtml_index_add_anchor(
+    mantohtml_index_t *index,		// I - Cross-reference index
+    const char        *filename,	// I - Man filename
+    int               level,		// I - Heading level
+    const char        *id,		// I - Anchor ID
+    const char        *title)		// I - Heading title (HTML)
+{
+  char		key[1024];		// "name(section)"
+  man_ipage_t	*page;			// Page
+  man_ianchor_t	*anchor;		// New anchor
+
+
+  if (!index_key(filename, key, sizeof(key)))
+    return (true);
+
+  index_lock(index);
+
+  if ((page = index_find(index, key)) == NULL || strcmp(page->filename, filename))
+  {
+    index_unlock(index);
+    return (true);
+  }
+
+  if (page->num_anchors >= page->alloc_anchors)
+  {
+    if ((anchor = realloc(page->anchors, (page->alloc_anchors + 16) * sizeof(man_ianchor_t))) == NULL)
+    {
+      index_unlock(index);
+      return (false);
+    }
+
+    page->anchors       = anchor;
+    page->alloc_anchors += 16;
+  }
+
+  anchor = page->anchors + page->num_anchors;
+
+  if ((anchor->id = strdup(id)) == NULL || (anchor->title = strdup(title)) == NULL)
+  {
+    free(anchor->id);
+    index_unlock(index);
+    return (false);
+  }
+
+  anchor->level = level;
+  page->num_anchors ++;
+
+  index_unlock(index);
+
+  return (true);
+}
+
+
+//
+// '_mantohtml_index_find()' - Find the URL for a man page in an index.
+//
+// Pages are never changed or freed until the index is deleted, so the
+// returned pointer can be used without holding a lock.
+//
+
+const char *				// O - URL of HTML file or `NULL` if not found
+_mantohtml_index_find(
+    mantohtml_index_t *index,		// I - Cross-reference index
+    const char        *name,		// I - Man page name
+    size_t            namelen,		// I - Length of name
+    const char        *section,		// I - Man page section
+    size_t            seclen)		// I - Length of section
+{
+  char		key[1024];		// "name(section)"
+  man_ipage_t	*page;			// Page
+  const char	*href;			// URL of HTML file
+
+
+  if ((namelen + seclen + 3) > sizeof(key))
+    return (NULL);
+
+  snprintf(key, sizeof(key), "%.*s(%.*s)", (int)namelen, name, (int)seclen, section);
+
+  index_lock(index);
+  href = (page = index_find(index, key)) != NULL ? page->href : NULL;
+  index_unlock(index);
+
+  return (href);
+}
+
+
+//
+// 'index_compare()' - Compare two pages by name and section.
+//
+
+static int				// O - Result of comparison
+index_compare(man_ipage_t **a,		// I - First page
+              man_ipage_t **b)		// I - Second page
+{
+  int	result;				// Result of comparison
+
+
+  if ((result = strncmp((*a)->key, (*b)->key, (*a)->namelen < (*b)->namelen ? (*a)->namelen : (*b)->namelen)) != 0)
+    return (result);
+  else if ((*a)->namelen != (*b)->namelen)
+    return ((*a)->namelen < (*b)->namelen ? -1 : 1);
+  else
+    return (strcmp((*a)->key + (*a)->namelen, (*b)->key + (*b)->namelen));
+}
+
+
+//
+// 'index_find()' - Find a page, with the index locked.
+//
+
+static man_ipage_t *			// O - Page or `NULL` if not found
+index_find(mantohtml_index_t *index,	// I - Cross-reference index
+           const char        *key)	// I - "name(section)"
+{
+  man_ipage_t	*page;			// Current page
+
+
+  for (page = index->buckets[index_hash(key)]; page; page = page->next)
+  {
+    if (!strcmp(page->key, key))
+      break;
+  }
+
+  return (page);
+}
+
+
+//
+// 'index_hash()' - Compute the hash bucket for a key.
+//
+
+static size_t				// O - Hash bucket
+index_hash(const char *key)		// I - Key string
+{
+  unsigned	hash = 2166136261U;	// FNV-1a hash
+
+
+  for (; *key; key ++)
+    hash = (hash ^ (*key & 255)) * 16777619U;
+
+  return (hash % MAN_INDEX_SIZE);
+}
+
+
+//
+// 'index_key()' - Make the "name(section)" key for a man filename.
+//
+
+static char *				// O - Key or `NULL` if not a man filename
+index_key(const char *filename,		// I - Man filename
+          char       *buffer,		// I - Key buffer
+          size_t     bufsize)		// I - Size of key buffer
+{
+  const char	*base,			// Base name of man file
+		*end,			// End of section
+		*ext;			// Section extension
+
+
+  if ((base = strrchr(filename, '/')) != NULL)
+    base ++;
+  else
+    base = filename;
+
+  end = base + strlen(base);
+
+  if ((ext = strrchr(base, '.')) != NULL && (!strcmp(ext, ".bz2") || !strcmp(ext, ".gz") || !strcmp(ext, ".xz") || !strcmp(ext, ".zst")))
+  {
+    // Strip the compression extension...
+    for (end = ext, ext --; ext > base && *ext != '.'; ext --);
+  }
+
+  if (!ext || ext <= base || *ext != '.' || !isdigit(ext[1] & 255))
+    return (NULL);
+
+  if (snprintf(buffer, bufsize, "%.*s(%.*s)", (int)(ext - base), base, (int)(end - ext - 1), ext + 1) >= (int)bufsize)
+    return (NULL);
+
+  return (buffer);
+}
+
+
+//
+// 'index_lock()' - Lock a cross-reference index.
+//
+
+static void
+index_lock(mantohtml_index_t *index)	// I - Cross-reference index
+{
+#if _WIN32
+  EnterCriticalSection(&index->mutex);
+#else
+  pthread_mutex_lock(&index->mutex);
+#endif // _WIN32
+}
+
+
+//
+// 'index_puts_html()' - Write a string, quoting HTML entities as needed.
+//
+
+static void
+index_puts_html(mantohtml_sink_t *sink,	// I - Output sink
+                const char       *s)	// I - String
+{
+  const char	*start;			// Start of current fragment
+
+
+  for (start = s; *s; s ++)
+  {
+    if (*s == '&' || *s == '<' || *s == '\"')
+    {
+      if (s > start)
+        mantohtml_sink_write(sink, start, (size_t)(s - start));
+
+      mantohtml_sink_puts(sink, *s == '&' ? "&amp;" : *s == '<' ? "&lt;" : "&quot;");
+      start = s + 1;
+    }
+  }
+
+  if (s > start)
+    mantohtml_sink_write(sink, start, (size_t)(s - start));
+}
+
+
+//
+// 'index_unlock()' - Unlock a cross-reference index.
+//
+
+static void
+index_unlock(mantohtml_index_t *index)	// I - Cross-reference index
+{
+#if _WIN32
+  LeaveCriticalSection(&index->mutex);
+#else
+  pthread_mutex_unlock(&index->mutex);
+#endif // _WIN32
+}
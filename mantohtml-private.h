@@ -0,0 +1,103 @@
+//
+// Private header file for the man page to HTML conversion library.
+//
+// Copyright © 2022-2023 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.
+// <https://opensource.org/licenses/Apache-2.0>
+//
+
+#ifndef MANTOHTML_PRIVATE_H
+#  define MANTOHTML_PRIVATE_H
+#  include "mantohtml.h"
+
+
+//
+// Macros...
+//
+// The conversion statistics are only collected when the library is built
+// with MANTOHTML_STATS defined, otherwise these macros compile to nothing.
+//
+
+#  ifdef MANTOHTML_STATS
+#    define _MANTOHTML_STATS_ADD(var,n)	((var) += (n))
+					// Add to a counter
+#    define _MANTOHTML_STATS_START(start) double start = _mantohtml_stats_time()
+					// Start timing
+#    define _MANTOHTML_STATS_END(var,start) ((var) += _mantohtml_stats_time() - (start))
+					// Add the time since "start" to a counter
+#  else
+#    define _MANTOHTML_STATS_ADD(var,n)
+#    define _MANTOHTML_STATS_START(start)
+#    define _MANTOHTML_STATS_END(var,start)
+#  endif // MANTOHTML_STATS
+
+
+//
+// Constants...
+//
+
+#  define _MANTOHTML_MAX_MCOUNTS 64	// Maximum number of macro names per man page
+
+
+//
+// Types...
+//
+
+typedef struct _mantohtml_arena_s	// Arena (bump) allocator
+{
+  struct _mantohtml_achunk_s *chunks;	// Memory chunks, largest first
+  char		*ptr,			// Next free byte in current chunk
+		*end,			// End of current chunk
+		*last;			// Most recent allocation
+#  ifdef MANTOHTML_STATS
+  size_t	growths;		// Number of chunks added
+#  endif // MANTOHTML_STATS
+} _mantohtml_arena_t;
+
+typedef struct _mantohtml_counts_s	// Conversion statistics
+{
+  double	gets_time,		// Time reading lines in seconds
+		macro_time,		// Time running macros in seconds
+		puts_time,		// Time converting text in seconds
+		write_time;		// Time writing output in seconds
+  size_t	bytes_in,		// Bytes read
+		bytes_out,		// Bytes written
+		lines,			// Lines read
+		unknown_escapes,	// Unknown escapes and special characters
+		unknown_macros,		// Unknown macros
+		growths;		// Buffer growth events
+} _mantohtml_counts_t;
+
+typedef struct _mantohtml_mcount_s	// Macro count
+{
+  char		name[8];		// Macro name without the leading "."
+  size_t	count;			// Number of uses
+} _mantohtml_mcount_t;
+
+
+//
+// Functions...
+//
+
+extern void		*_mantohtml_arena_alloc(_mantohtml_arena_t *arena, size_t size);
+extern void		_mantohtml_arena_free(_mantohtml_arena_t *arena);
+extern void		*_mantohtml_arena_grow(_mantohtml_arena_t *arena, void *ptr, size_t oldsize, size_t newsize);
+extern void		_mantohtml_arena_reset(_mantohtml_arena_t *arena);
+extern char		*_mantohtml_arena_strdup(_mantohtml_arena_t *arena, const char *s, size_t len);
+
+extern bool		_mantohtml_cache_add(mantohtml_cache_t *cache, const char *key, const char *files, const void *data, size_t len);
+extern void		*_mantohtml_cache_find(mantohtml_cache_t *cache, const char *key, _mantohtml_arena_t *arena, size_t *len);
+
+extern bool		_mantohtml_header(mantohtml_t *doc, const char *title);
+
+extern bool		_mantohtml_index_add_anchor(mantohtml_index_t *index, const char *filename, int level, const char *id, const char *title);
+extern const char	*_mantohtml_index_find(mantohtml_index_t *index, const char *name, size_t namelen, const char *section, size_t seclen);
+
+extern void		_mantohtml_sink_puts_json(mantohtml_sink_t *sink, const char *s, size_t len);
+extern void		_mantohtml_sink_stats(mantohtml_sink_t *sink, size_t *bytes, size_t *growths, double *secs);
+
+extern bool		_mantohtml_stats_add(mantohtml_stats_t *stats, const char *filename, double secs, const _mantohtml_counts_t *counts, size_t num_mcounts, const _mantohtml_mcount_t *mcounts);
+extern double		_mantohtml_stats_time(void);
+
+#endif // !MANTOHTML_PRIVATE_H
@@ -0,0 +1,471 @@
+//
+// Output sink functions for the man page to HTML conversion library.
+//
+// Copyright © 2022-2023 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.
+// <https://opensource.org/licenses/Apache-2.0>
+//
+
+#include "mantohtml-private.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#if _WIN32
+#  include <io.h>
+#  define write _write
+typedef int ssize_t;
+#else
+#  include <unistd.h>
+#endif // _WIN32
+
+
+//
+// Local types...
+//
+
+struct mantohtml_sink_s			// Output sink
+{
+  char			*buffer;	// Output buffer
+  size_t		bufsize,	// Size of output buffer
+			bufused;	// Bytes used in output buffer
+  mantohtml_sink_cb_t	cb;		// Write callback or `NULL` for memory
+  void			*cbdata;	// Callback data
+  int			fd;		// File descriptor for mantohtml_sink_new_fd()
+  bool			error;		// Has a write error occurred?
+#ifdef MANTOHTML_STATS
+  size_t		bytes,		// Number of bytes written
+			growths;	// Number of times the buffer has grown
+  double		write_time;	// Time writing output in seconds
+#endif // MANTOHTML_STATS
+};
+
+
+//
+// Local functions...
+//
+
+static bool	sink_fd_cb(mantohtml_sink_t *sink, const char *data, size_t len);
+
+
+//
+// 'mantohtml_sink_delete()' - Free the memory used by an output sink.
+//
+// Callers should use @link mantohtml_sink_flush@ first for callback and file
+// descriptor sinks.  File descriptors are not closed.
+//
+
+void
+mantohtml_sink_delete(
+    mantohtml_sink_t *sink)		// I - Output sink
+{
+  if (sink)
+  {
+    free(sink->buffer);
+    free(sink);
+  }
+}
+
+
+//
+// 'mantohtml_sink_flush()' - Flush any buffered output to the callback.
+//
+// Memory sinks are not flushed - the output remains in the buffer.
+//
+
+bool					// O - `true` on success, `false` on error
+mantohtml_sink_flush(
+    mantohtml_sink_t *sink)		// I - Output sink
+{
+  if (sink->cb && sink->bufused > 0 && !sink->error)
+  {
+    _MANTOHTML_STATS_START(start);
+
+    if (!(sink->cb)(sink->cbdata, sink->buffer, sink->bufused))
+      sink->error = true;
+
+    _MANTOHTML_STATS_END(sink->write_time, start);
+
+    sink->bufused = 0;
+  }
+
+  return (!sink->error);
+}
+
+
+//
+// 'mantohtml_sink_get_buffer()' - Get the output collected by a memory sink.
+//
+// The returned string is nul-terminated and remains valid until the next
+// write to, reset of, or deletion of the sink.  `NULL` is returned for
+// callback and file descriptor sinks or if a memory allocation failed.
+//
+
+const char *				// O - Output or `NULL` on error
+mantohtml_sink_get_buffer(
+    mantohtml_sink_t *sink,		// I - Output sink
+    size_t           *len)		// O - Length of output or `NULL` if not needed
+{
+  if (sink->cb || sink->error)
+  {
+    if (len)
+      *len = 0;
+
+    return (NULL);
+  }
+
+  if (len)
+    *len = sink->bufused;
+
+  return (sink->buffer);
+}
+
+
+//
+// 'mantohtml_sink_new_cb()' - Create an output sink that writes via a callback.
+//
+// Output is collected in a 64k buffer and passed to the callback in large
+// blocks.  The callback returns `true` on success and `false` on error.
+//
+
+mantohtml_sink_t *			// O - Output sink or `NULL` on error
+mantohtml_sink_new_cb(
+    mantohtml_sink_cb_t cb,		// I - Write callback
+    void                *cbdata)	// I - Callback data
+{
+  mantohtml_sink_t	*sink;		// Output sink
+
+
+  if ((sink = calloc(1, sizeof(mantohtml_sink_t))) == NULL)
+    return (NULL);
+
+  if ((sink->buffer = malloc(65536)) == NULL)
+  {
+    free(sink);
+    return (NULL);
+  }
+
+  sink->bufsize = 65536;
+  sink->cb      = cb;
+  sink->cbdata  = cbdata;
+  sink->fd      = -1;
+
+  return (sink);
+}
+
+
+//
+// 'mantohtml_sink_new_fd()' - Create an output sink that writes to a file descriptor.
+//
+
+mantohtml_sink_t *			// O - Output sink or `NULL` on error
+mantohtml_sink_new_fd(int fd)		// I - File descriptor
+{
+  mantohtml_sink_t	*sink;		// Output sink
+
+
+  if ((sink = mantohtml_sink_new_cb(NULL, NULL)) != NULL)
+  {
+    sink->cb     = (mantohtml_sink_cb_t)sink_fd_cb;
+    sink->cbdata = sink;
+    sink->fd     = fd;
+  }
+
+  return (sink);
+}
+
+
+//
+// 'mantohtml_sink_new_memory()' - Create an output sink that writes to memory.
+//
+// The output is available using @link mantohtml_sink_get_buffer@ and the
+// buffer grows as needed.
+//
+
+mantohtml_sink_t *			// O - Output sink or `NULL` on error
+mantohtml_sink_new_memory(void)
+{
+  mantohtml_sink_t	*sink;		// Output sink
+
+
+  if ((sink = calloc(1, sizeof(mantohtml_sink_t))) == NULL)
+    return (NULL);
+
+  if ((sink->buffer = malloc(4096)) == NULL)
+  {
+    free(sink);
+    return (NULL);
+  }
+
+  sink->bufsize   = 4096;
+  sink->buffer[0] = '\0';
+  sink->fd        = -1;
+
+  return (sink);
+}
+
+
+//
+// 'mantohtml_sink_printf()' - Write a formatted string to an output sink.
+//
+
+void
+mantohtml_sink_printf(
+    mantohtml_sink_t *sink,		// I - Output sink
+    const char       *format,		// I - Printf-style format string
+    ...)				// I - Additional arguments as needed
+{
+  va_list	ap;			// Pointer to additional arguments
+  int		bytes;			// Formatted bytes
+  char		temp[1024],		// Temporary buffer
+		*tempptr = temp;	// Pointer to formatted string
+
+
+  va_start(ap, format);
+  bytes = vsnprintf(temp, sizeof(temp), format, ap);
+  va_end(ap);
+
+  if (bytes < 0)
+    return;
+
+  if ((size_t)bytes >= sizeof(temp))
+  {
+    // Format again into a larger buffer...
+    if ((tempptr = malloc((size_t)bytes + 1)) == NULL)
+    {
+      sink->error = true;
+      return;
+    }
+
+    va_start(ap, format);
+    vsnprintf(tempptr, (size_t)bytes + 1, format, ap);
+    va_end(ap);
+  }
+
+  mantohtml_sink_write(sink, tempptr, (size_t)bytes);
+
+  if (tempptr != temp)
+    free(tempptr);
+}
+
+
+//
+// 'mantohtml_sink_putc()' - Write a single character to an output sink.
+//
+
+void
+mantohtml_sink_putc(
+    mantohtml_sink_t *sink,		// I - Output sink
+    int              ch)		// I - Character
+{
+  if ((sink->bufused + 1) < sink->bufsize)
+  {
+    _MANTOHTML_STATS_ADD(sink->bytes, 1);
+
+    sink->buffer[sink->bufused ++] = (char)ch;
+
+    if (!sink->cb)
+      sink->buffer[sink->bufused] = '\0';
+  }
+  else
+  {
+    char	temp = (char)ch;	// Character
+
+    mantohtml_sink_write(sink, &temp, 1);
+  }
+}
+
+
+//
+// 'mantohtml_sink_puts()' - Write a string to an output sink.
+//
+
+void
+mantohtml_sink_puts(
+    mantohtml_sink_t *sink,		// I - Output sink
+    const char       *s)		// I - String
+{
+  mantohtml_sink_write(sink, s, strlen(s));
+}
+
+
+//
+// 'mantohtml_sink_reset()' - Discard any buffered output and clear errors.
+//
+// This allows a memory sink to be reused for another document without
+// reallocating its buffer.
+//
+
+void
+mantohtml_sink_reset(
+    mantohtml_sink_t *sink)		// I - Output sink
+{
+  sink->bufused   = 0;
+  sink->buffer[0] = '\0';
+  sink->error     = false;
+}
+
+
+//
+// 'mantohtml_sink_write()' - Write data to an output sink.
+//
+
+void
+mantohtml_sink_write(
+    mantohtml_sink_t *sink,		// I - Output sink
+    const char       *data,		// I - Data to write
+    size_t           len)		// I - Length of data
+{
+  if (sink->error)
+    return;
+
+  _MANTOHTML_STATS_ADD(sink->bytes, len);
+
+  if ((sink->bufused + len) >= sink->bufsize)
+  {
+    if (sink->cb)
+    {
+      // Flush the buffer, and write large blocks directly...
+      if (!mantohtml_sink_flush(sink))
+        return;
+
+      if (len >= sink->bufsize)
+      {
+        _MANTOHTML_STATS_START(start);
+
+        if (!(sink->cb)(sink->cbdata, data, len))
+          sink->error = true;
+
+        _MANTOHTML_STATS_END(sink->write_time, start);
+
+        return;
+      }
+    }
+    else
+    {
+      // Grow the memory buffer...
+      size_t	bufsize = 2 * sink->bufsize;
+					// New size of buffer
+      char	*buffer;		// New buffer
+
+      while (bufsize <= (sink->bufused + len))
+        bufsize *= 2;
+
+      if ((buffer = realloc(sink->buffer, bufsize)) == NULL)
+      {
+        sink->error = true;
+        return;
+      }
+
+      sink->buffer  = buffer;
+      sink->bufsize = bufsize;
+
+      _MANTOHTML_STATS_ADD(sink->growths, 1);
+    }
+  }
+
+  memcpy(sink->buffer + sink->bufused, data, len);
+  sink->bufused += len;
+
+  if (!sink->cb)
+    sink->buffer[sink->bufused] = '\0';
+}
+
+
+//
+// '_mantohtml_sink_puts_json()' - Write a JSON string.
+//
+
+void
+_mantohtml_sink_puts_json(
+    mantohtml_sink_t *sink,		// I - Output sink
+    const char       *s,		// I - String
+    size_t           len)		// I - Length of string
+{
+  const char	*start,			// Start of current fragment
+		*end = s + len;		// End of string
+
+
+  mantohtml_sink_putc(sink, '\"');
+
+  for (start = s; s < end; s ++)
+  {
+    if (*s == '\"' || *s == '\\' || (*s & 255) < ' ')
+    {
+      if (s > start)
+        mantohtml_sink_write(sink, start, (size_t)(s - start));
+
+      if (*s == '\"' || *s == '\\')
+        mantohtml_sink_printf(sink, "\\%c", *s);
+      else
+        mantohtml_sink_printf(sink, "\\u%04x", *s & 255);
+
+      start = s + 1;
+    }
+  }
+
+  if (s > start)
+    mantohtml_sink_write(sink, start, (size_t)(s - start));
+
+  mantohtml_sink_putc(sink, '\"');
+}
+
+
+//
+// '_mantohtml_sink_stats()' - Get the output statistics for a sink.
+//
+// The statistics are cumulative, and are always 0 unless the library is built
+// with MANTOHTML_STATS defined.
+//
+
+void
+_mantohtml_sink_stats(
+    mantohtml_sink_t *sink,		// I - Output sink
+    size_t           *bytes,		// O - Number of bytes written
+    size_t           *growths,		// O - Number of times the buffer has grown
+    double           *secs)		// O - Time writing output in seconds
+{
+#ifdef MANTOHTML_STATS
+  *bytes   = sink->bytes;
+  *growths = sink->growths;
+  *secs    = sink->write_time;
+#else
+  (void)sink;
+
+  *bytes   = 0;
+  *growths = 0;
+  *secs    = 0.0;
+#endif // MANTOHTML_STATS
+}
+
+
+//
+// 'sink_fd_cb()' - Write callback for file descriptor sinks.
+//
+
+static bool				// O - `true` on success, `false` on error
+sink_fd_cb(mantohtml_sink_t *sink,	// I - Output sink
+           const char       *data,	// I - Data to write
+           size_t           len)	// I - Length of data
+{
+  ssize_t	bytes;			// Bytes written
+
+
+  while (len > 0)
+  {
+    if ((bytes = write(sink->fd, data, len)) < 0)
+    {
+      if (errno == EINTR || errno == EAGAIN)
+        continue;
+
+      return (false);
+    }
+
+    data += bytes;
+    len  -= (size_t)bytes;
+  }
+
+  return (true);
+}
@@ -0,0 +1,434 @@
+//
+// Conversion statistics functions for the man page to HTML conversion library.
+//
+// Copyright © 2022-2023 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.
+// <https://opensource.org/licenses/Apache-2.0>
+//
+
+#include "mantohtml-private.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#if _WIN32
+#  include <windows.h>
+#else
+#  include <pthread.h>
+#endif // _WIN32
+#ifndef ENOTSUP
+#  define ENOTSUP ENOSYS
+#endif // !ENOTSUP
+
+
+#ifdef MANTOHTML_STATS
+//
+// Local types...
+//
+
+typedef struct man_spage_s		// Statistics for a man page
+{
+  char			*filename;	// Man filename
+  double		secs;		// Conversion time in seconds
+  _mantohtml_counts_t	counts;		// Conversion statistics
+} man_spage_t;
+
+struct mantohtml_stats_s		// Conversion statistics
+{
+#  if _WIN32
+  CRITICAL_SECTION	mutex;		// Mutex for statistics
+#  else
+  pthread_mutex_t	mutex;		// Mutex for statistics
+#  endif // _WIN32
+  size_t		num_pages,	// Number of pages
+			alloc_pages;	// Allocated pages
+  man_spage_t		*pages;		// Pages
+  double		secs;		// Total conversion time in seconds
+  _mantohtml_counts_t	counts;		// Total conversion statistics
+  size_t		footer_bytes;	// Bytes written when documents are finished
+  size_t		num_mcounts,	// Number of macro names
+			alloc_mcounts;	// Allocated macro names
+  _mantohtml_mcount_t	*mcounts;	// Macro counts by name
+};
+
+
+//
+// Local functions...
+//
+
+static int	stats_compare_mcounts(_mantohtml_mcount_t *a, _mantohtml_mcount_t *b);
+static int	stats_compare_pages(man_spage_t *a, man_spage_t *b);
+static void	stats_lock(mantohtml_stats_t *stats);
+static void	stats_unlock(mantohtml_stats_t *stats);
+static void	stats_write_counts(mantohtml_sink_t *sink, double secs, const _mantohtml_counts_t *counts);
+#endif // MANTOHTML_STATS
+
+
+//
+// 'mantohtml_stats_delete()' - Free the memory used by conversion statistics.
+//
+
+void
+mantohtml_stats_delete(
+    mantohtml_stats_t *stats)		// I - Conversion statistics
+{
+#ifdef MANTOHTML_STATS
+  size_t	i;			// Looping var
+
+
+  if (!stats)
+    return;
+
+  for (i = 0; i < stats->num_pages; i ++)
+    free(stats->pages[i].filename);
+
+  free(stats->pages);
+  free(stats->mcounts);
+
+#  if _WIN32
+  DeleteCriticalSection(&stats->mutex);
+#  else
+  pthread_mutex_destroy(&stats->mutex);
+#  endif // _WIN32
+
+  free(stats);
+
+#else
+  (void)stats;
+#endif // MANTOHTML_STATS
+}
+
+
+//
+// 'mantohtml_stats_new()' - Create a conversion statistics collector.
+//
+// Conversion statistics record the time spent reading lines, running macros,
+// converting text, and writing output, along with the number of bytes, lines,
+// macros, unknown macros and escapes, and buffer growth events, for each man
+// page converted.  The statistics can be shared by any number of documents
+// and threads using the "stats" member of @link mantohtml_options_t@.
+//
+// `NULL` is returned with `errno` set to `ENOTSUP` if the library was not
+// built with MANTOHTML_STATS defined.
+//
+
+mantohtml_stats_t *			// O - Conversion statistics or `NULL` on error
+mantohtml_stats_new(void)
+{
+#ifdef MANTOHTML_STATS
+  mantohtml_stats_t	*stats;		// Conversion statistics
+
+
+  if ((stats = calloc(1, sizeof(mantohtml_stats_t))) == NULL)
+    return (NULL);
+
+#  if _WIN32
+  InitializeCriticalSection(&stats->mutex);
+#  else
+  pthread_mutex_init(&stats->mutex, NULL);
+#  endif // _WIN32
+
+  return (stats);
+
+#else
+  errno = ENOTSUP;
+  return (NULL);
+#endif // MANTOHTML_STATS
+}
+
+
+//
+// 'mantohtml_stats_write_json()' - Write conversion statistics as JSON.
+//
+// The JSON object contains the totals for all man pages, the macro counts by
+// name, and a "files" array with the statistics for each man page, slowest
+// first.  The total "bytes_out" is the sum for the man pages, and the bytes
+// written when the documents are finished are reported separately as
+// "footer_bytes_out".
+//
+
+bool					// O - `true` on success, `false` on error
+mantohtml_stats_write_json(
+    mantohtml_stats_t *stats,		// I - Conversion statistics
+    mantohtml_sink_t  *sink)		// I - Output sink
+{
+#ifdef MANTOHTML_STATS
+  size_t	i;			// Looping var
+  man_spage_t	*page;			// Current page
+
+
+  stats_lock(stats);
+
+  if (stats->num_pages > 1)
+    qsort(stats->pages, stats->num_pages, sizeof(man_spage_t), (int (*)(const void *, const void *))stats_compare_pages);
+
+  if (stats->num_mcounts > 1)
+    qsort(stats->mcounts, stats->num_mcounts, sizeof(_mantohtml_mcount_t), (int (*)(const void *, const void *))stats_compare_mcounts);
+
+  mantohtml_sink_printf(sink, "{\n\"pages\":%lu,", (unsigned long)stats->num_pages);
+  stats_write_counts(sink, stats->secs, &stats->counts);
+  mantohtml_sink_printf(sink, ",\"footer_bytes_out\":%lu,\n\"macros\":{", (unsigned long)stats->footer_bytes);
+
+  for (i = 0; i < stats->num_mcounts; i ++)
+  {
+    if (i)
+      mantohtml_sink_putc(sink, ',');
+
+    _mantohtml_sink_puts_json(sink, stats->mcounts[i].name, strlen(stats->mcounts[i].name));
+    mantohtml_sink_printf(sink, ":%lu", (unsigned long)stats->mcounts[i].count);
+  }
+
+  mantohtml_sink_puts(sink, "},\n\"files\":[");
+
+  for (i = 0, page = stats->pages; i < stats->num_pages; i ++, page ++)
+  {
+    mantohtml_sink_puts(sink, i ? ",\n{\"file\":" : "\n{\"file\":");
+    _mantohtml_sink_puts_json(sink, page->filename, strlen(page->filename));
+    mantohtml_sink_putc(sink, ',');
+    stats_write_counts(sink, page->secs, &page->counts);
+    mantohtml_sink_putc(sink, '}');
+  }
+
+  mantohtml_sink_puts(sink, "\n]\n}\n");
+
+  stats_unlock(stats);
+
+  return (mantohtml_sink_flush(sink));
+
+#else
+  (void)stats;
+  (void)sink;
+
+  return (false);
+#endif // MANTOHTML_STATS
+}
+
+
+//
+// '_mantohtml_stats_add()' - Add the statistics for a man page.
+//
+// A `NULL` filename adds to the totals without recording a man page, which is
+// used for the output written when a document is finished.  Those output
+// bytes are kept separate so that the total is the sum for the man pages.
+//
+
+bool					// O - `true` on success, `false` on error
+_mantohtml_stats_add(
+    mantohtml_stats_t         *stats,	// I - Conversion statistics
+    const char                *filename,// I - Man filename or `NULL`
+    double                    secs,	// I - Conversion time in seconds
+    const _mantohtml_counts_t *counts,	// I - Conversion statistics for man page
+    size_t                    num_mcounts,
+					// I - Number of macro names
+    const _mantohtml_mcount_t *mcounts)	// I - Macro counts by name
+{
+#ifdef MANTOHTML_STATS
+  bool		ret = true;		// Return value
+  size_t	i,			// Looping var
+		j;			// Looping var
+
+
+  stats_lock(stats);
+
+  // Add the totals...
+  stats->secs                   += secs;
+  stats->counts.gets_time       += counts->gets_time;
+  stats->counts.macro_time      += counts->macro_time;
+  stats->counts.puts_time       += counts->puts_time;
+  stats->counts.write_time      += counts->write_time;
+  stats->counts.bytes_in        += counts->bytes_in;
+  if (filename)
+    stats->counts.bytes_out     += counts->bytes_out;
+  else
+    stats->footer_bytes         += counts->bytes_out;
+  stats->counts.lines           += counts->lines;
+  stats->counts.unknown_escapes += counts->unknown_escapes;
+  stats->counts.unknown_macros  += counts->unknown_macros;
+  stats->counts.growths         += counts->growths;
+
+  // Add the macro counts...
+  for (i = 0; i < num_mcounts; i ++)
+  {
+    for (j = 0; j < stats->num_mcounts; j ++)
+    {
+      if (!strcmp(stats->mcounts[j].name, mcounts[i].name))
+        break;
+    }
+
+    if (j >= stats->num_mcounts)
+    {
+      if (stats->num_mcounts >= stats->alloc_mcounts)
+      {
+        size_t		alloc_mcounts = stats->alloc_mcounts + 64;
+					// New number of macro names
+        _mantohtml_mcount_t *temp;	// New macro counts
+
+        if ((temp = realloc(stats->mcounts, alloc_mcounts * sizeof(_mantohtml_mcount_t))) == NULL)
+        {
+          ret = false;
+          break;
+        }
+
+        stats->mcounts       = temp;
+        stats->alloc_mcounts = alloc_mcounts;
+      }
+
+      stats->mcounts[j] = mcounts[i];
+      stats->num_mcounts ++;
+    }
+    else
+    {
+      stats->mcounts[j].count += mcounts[i].count;
+    }
+  }
+
+  // Then record the man page...
+  if (filename && ret)
+  {
+    if (stats->num_pages >= stats->alloc_pages)
+    {
+      size_t		alloc_pages = stats->alloc_pages ? 2 * stats->alloc_pages : 256;
+					// New number of pages
+      man_spage_t	*temp;		// New pages
+
+      if ((temp = realloc(stats->pages, alloc_pages * sizeof(man_spage_t))) == NULL)
+        ret = false;
+      else
+      {
+        stats->pages       = temp;
+        stats->alloc_pages = alloc_pages;
+      }
+    }
+
+    if (ret && (stats->pages[stats->num_pages].filename = strdup(filename)) == NULL)
+      ret = false;
+
+    if (ret)
+    {
+      stats->pages[stats->num_pages].secs   = secs;
+      stats->pages[stats->num_pages].counts = *counts;
+      stats->num_pages ++;
+    }
+  }
+
+  stats_unlock(stats);
+
+  return (ret);
+
+#else
+  (void)stats;
+  (void)filename;
+  (void)secs;
+  (void)counts;
+  (void)num_mcounts;
+  (void)mcounts;
+
+  return (false);
+#endif // MANTOHTML_STATS
+}
+
+
+//
+// '_mantohtml_stats_time()' - Get the current time in seconds.
+//
+
+double					// O - Time in seconds
+_mantohtml_stats_time(void)
+{
+#if _WIN32
+  LARGE_INTEGER	counter,		// Performance counter
+		frequency;		// Counter frequency
+
+  QueryPerformanceCounter(&counter);
+  QueryPerformanceFrequency(&frequency);
+
+  return ((double)counter.QuadPart / (double)frequency.QuadPart);
+
+#else
+  struct timespec	ts;		// Current time
+
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ((double)ts.tv_sec + 0.000000001 * (double)ts.tv_nsec);
+#endif // _WIN32
+}
+
+
+#ifdef MANTOHTML_STATS
+//
+// 'stats_compare_mcounts()' - Compare two macro counts by name.
+//
+
+static int				// O - Result of comparison
+stats_compare_mcounts(
+    _mantohtml_mcount_t *a,		// I - First macro count
+    _mantohtml_mcount_t *b)		// I - Second macro count
+{
+  return (strcmp(a->name, b->name));
+}
+
+
+//
+// 'stats_compare_pages()' - Compare two pages by conversion time, slowest first.
+//
+
+static int				// O - Result of comparison
+stats_compare_pages(man_spage_t *a,	// I - First page
+                    man_spage_t *b)	// I - Second page
+{
+  if (a->secs > b->secs)
+    return (-1);
+  else if (a->secs < b->secs)
+    return (1);
+  else
+    return (strcmp(a->filename, b->filename));
+}
+
+
+//
+// 'stats_lock()' - Lock conversion statistics.
+//
+
+static void
+stats_lock(mantohtml_stats_t *stats)	// I - Conversion statistics
+{
+#  if _WIN32
+  EnterCriticalSection(&stats->mutex);
+#  else
+  pthread_mutex_lock(&stats->mutex);
+#  endif // _WIN32
+}
+
+
+//
+// 'stats_unlock()' - Unlock conversion statistics.
+//
+
+static void
+stats_unlock(mantohtml_stats_t *stats)	// I - Conversion statistics
+{
+#  if _WIN32
+  LeaveCriticalSection(&stats->mutex);
+#  else
+  pthread_mutex_unlock(&stats->mutex);
+#  endif // _WIN32
+}
+
+
+//
+// 'stats_write_counts()' - Write the members for a set of statistics.
+//
+
+static void
+stats_write_counts(
+    mantohtml_sink_t          *sink,	// I - Output sink
+    double                    secs,	// I - Conversion time in seconds
+    const _mantohtml_counts_t *counts)	// I - Conversion statistics
+{
+  mantohtml_sink_printf(sink, "\"seconds\":%.6f,\"gets_seconds\":%.6f,\"macro_seconds\":%.6f,\"text_seconds\":%.6f,\"write_seconds\":%.6f,", secs, counts->gets_time, counts->macro_time, counts->puts_time, counts->write_time);
+  mantohtml_sink_printf(sink, "\"bytes_in\":%lu,\"bytes_out\":%lu,\"lines\":%lu,\"unknown_macros\":%lu,\"unknown_escapes\":%lu,\"buffer_growths\":%lu", (unsigned long)counts->bytes_in, (unsigned long)counts->bytes_out, (unsigned long)counts->lines, (unsigned long)counts->unknown_macros, (unsigned long)counts->unknown_escapes, (unsigned long)counts->growths);
+}
+#endif // MANTOHTML_STATS
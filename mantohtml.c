@@ -9,96 +9,209 @@
 // Usage:
 //
 //    mantohtml [OPTIONS] MAN-FILE [... MAN-FILE] >HTML-FILE
+//    mantohtml [OPTIONS] --output-dir DIR MAN-FILE [... MAN-FILE]
+//    mantohtml [OPTIONS] --output-dir DIR --tree MAN-DIR [... --tree MAN-DIR]
+//    mantohtml [OPTIONS] --serve -
+//    mantohtml [OPTIONS] [--jobs N] --serve SOCKET
 //
 // Options:
 //
 //    --author 'AUTHOR'        Set author metadata
+//    --cache DIR              Skip unchanged man pages with --output-dir
 //    --chapter 'CHAPTER'      Set chapter (H1 heading)
+//    --compact                Write compact HTML
+//    --compress gzip,br       Write compressed copies with --output-dir
 //    --copyright 'COPYRIGHT'  Set copyright metadata
 //    --css CSS-FILE-OR-URL    Use named stylesheet
+//    --css-link               Link to the stylesheet file instead of embedding it
+//    --format html,json,text  Set output formats (html, fragment, json, text)
 //    --help                   Show help
+//    --index NAME             Write NAME.json and NAME.html index files with --output-dir
+//    --jobs N                 Convert N files at a time with --output-dir
+//    --output-dir DIR         Write each man page to a separate file in DIR
+//    --serve -                Convert requests from stdin to stdout
+//    --serve SOCKET           Convert requests from a UNIX domain socket
+//    --stats FILENAME         Write conversion statistics to a JSON file
 //    --subject 'SUBJECT'      Set subject metadata
+//    --suffix '.EXT'          Set filename suffix for --output-dir (.html)
+//    --threads N              Convert the sections of large man pages using N threads
 //    --title 'TITLE'          Set output title
+//    --toc                    Include a table of contents
+//    --tree MAN-DIR           Convert the man1 to man9 directories of MAN-DIR with --output-dir
 //    --version                Show version
 //
 
+#include "mantohtml.h"
 #include <stdio.h>
 #include <stdlib.h>
-#include <stdbool.h>
-#include <stdarg.h>
 #include <string.h>
 #include <ctype.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <zlib.h>
+#ifdef HAVE_BROTLI
+#  include <brotli/encode.h>
+#endif // HAVE_BROTLI
 #if _WIN32
 #  include <io.h>
-#  define access _access
+#  include <direct.h>
+#  define close _close
+#  define mkdir(d,m) _mkdir(d)
+#  define open _open
+#  define read _read
+#  define unlink _unlink
+#  define write _write
+typedef int ssize_t;
 #else
 #  include <unistd.h>
+#  include <dirent.h>
+#  include <pthread.h>
+#  include <signal.h>
+#  include <sys/socket.h>
+#  include <sys/un.h>
 #endif // _WIN32
-#if !defined(__has_extension) && !defined(__GNUC__)
-#  define __attribute__(...)
-#endif // !__has_extension && !__GNUC__
 
 
 //
 // Local types...
 //
 
-typedef enum man_font_e			// Man page fonts
+typedef struct man_client_s		// Server client connection
 {
-  MAN_FONT_REGULAR,			// Plain/regular font
-  MAN_FONT_BOLD,			// Boldface (<strong>) font
-  MAN_FONT_ITALIC,			// Italic (<em>) font
-  MAN_FONT_SMALL,			// Small (<small>) font
-  MAN_FONT_SMALL_BOLD,			// Small bold (<small><strong>) font
-  MAN_FONT_MONOSPACE			// Monospaced (<pre>) font
-} man_font_t;
-
-typedef enum man_heading_e		// Man page heading levels
+  int		fd;			// Input file descriptor
+  char		buffer[65536],		// Input buffer
+		*bufptr,		// Current position in buffer
+		*bufend;		// End of buffer
+} man_client_t;
+
+typedef enum man_compress_e		// Compressed copies of output files
+{
+  MAN_COMPRESS_NONE = 0,		// No compressed copies
+  MAN_COMPRESS_GZIP = 1,		// gzip (".gz")
+  MAN_COMPRESS_BROTLI = 2		// Brotli (".br")
+} man_compress_t;
+
+typedef struct man_job_s		// Batch conversion job
+{
+  const char	*filename;		// Man filename, allocated for --tree
+  char		*subdir;		// Output subdirectory for --tree or `NULL`
+  size_t	size;			// Size of man file for --tree
+  int		formats;		// Additional output formats with --output-dir
+  mantohtml_options_t options;		// Options for this file
+} man_job_t;
+
+typedef struct man_output_s		// Output file with compressed copies
+{
+  const char	*outname;		// Output filename
+  char		gzname[1100],		// gzip filename
+		brname[1100];		// Brotli filename
+  int		fd,			// Output file
+		gzfd;			// gzip file or -1
+  z_stream	gzstream;		// gzip compressor
+#ifdef HAVE_BROTLI
+  int		brfd;			// Brotli file or -1
+  BrotliEncoderState *brstate;		// Brotli compressor
+#endif // HAVE_BROTLI
+  unsigned char	buffer[65536];		// Compressed data buffer
+} man_output_t;
+
+#if !_WIN32
+typedef struct man_queue_s		// Work-stealing job queue
+{
+  pthread_mutex_t mutex;		// Mutex for queue
+  size_t	head,			// First job in queue
+		tail;			// Last job in queue + 1
+} man_queue_t;
+
+typedef struct man_pool_s		// Worker pool
 {
-  MAN_HEADING_TOPIC,			// Topic heading (.TH)
-  MAN_HEADING_SECTION,			// Section heading (.SH)
-  MAN_HEADING_SUBSECTION		// Sub-section heading (.SS)
-} man_heading_t;
+  const char	*outdir;		// Output directory
+  const char	*cachedir;		// Cache directory or `NULL`
+  int		compress;		// Compressed copies to write
+  man_job_t	*jobs;			// Jobs
+  size_t	num_queues;		// Number of queues/workers
+  man_queue_t	*queues;		// Per-worker queues
+} man_pool_t;
+
+typedef struct man_worker_s		// Worker thread
+{
+  man_pool_t	*pool;			// Worker pool
+  size_t	queue;			// Queue for this worker
+  bool		status;			// `true` if all jobs succeeded
+} man_worker_t;
+
+typedef struct man_server_s		// Socket server
+{
+  int		fd;			// Listening socket
+  const mantohtml_options_t *options;	// Default conversion options
+} man_server_t;
 
-typedef struct man_state_s		// Current man page state
+typedef struct man_tdir_s		// Man directory in a --tree
+{
+  char		*path;			// Directory path
+  char		*subdir;		// Output subdirectory ("man1", etc.)
+  const man_job_t *tree;		// Tree with the options for the man pages
+  man_job_t	*jobs;			// Jobs for the man pages
+  size_t	num_jobs,		// Number of jobs
+		alloc_jobs;		// Allocated jobs
+  bool		status;			// `true` if the directory was scanned
+} man_tdir_t;
+
+typedef struct man_tree_s		// Man directories being scanned
 {
-  bool		wrote_header;		// Did we write the HTML header?
-  char		basepath[1024];		// Source base path
-  const char	*in_block;		// Current block element?
-  bool		in_link;		// Are we in a link?
-  size_t	indent;			// Indentation level
-  const char	*author;		// Author metadata
-  const char	*chapter;		// Chapter title
-  const char	*copyright;		// Copyright metadata
-  const char	*css;			// Stylesheet
-  const char	*subject;		// Subject metadata
-  const char	*title;			// Title
-  char		atopic[256],		// Current topic (anchor)
-		asection[256];		// Current section (anchor)
-  man_font_t	font;			// Current font
-} man_state_t;
+  pthread_mutex_t mutex;		// Mutex for next directory
+  man_tdir_t	*dirs;			// Man directories
+  size_t	num_dirs,		// Number of man directories
+		next_dir;		// Next directory to scan
+} man_tree_t;
+#endif // !_WIN32
 
 
 //
 // Local functions...
 //
 
-static void	convert_man(man_state_t *state, const char *filename);
-static char	*html_anchor(char *anchor, const char *s, size_t anchorsize);
-static void	html_font(man_state_t *state, man_font_t font);
-static void	html_footer(man_state_t *state);
-static void	html_header(man_state_t *state, const char *title);
-static void	html_heading(man_state_t *state, man_heading_t heading, const char *s);
-static void	html_printf(const char *format, ...) __attribute__((__format__(__printf__, 1, 2)));
-static void	html_putc(int ch);
-static void	html_puts(const char *s);
-static char	*man_gets(FILE *fp, char *buffer, size_t bufsize, int *linenum);
-static void	man_puts(man_state_t *state, const char *s);
-static void	man_xx(man_state_t *state, man_font_t a, man_font_t b, const char *line);
-static char	*parse_measurement(char *buffer, const char **lineptr, size_t bufsize, char defunit);
-static char	*parse_value(char *buffer, const char **lineptr, size_t bufsize);
-static void	safe_strcpy(char *dst, const char *src, size_t dstsize);
-static int	usage(const char *opt);
+static bool	cache_check(const char *cachename, const char *header, const char * const *outnames, size_t num_outnames, int compress);
+static bool	cache_update(const char *cachename, const char *header, const char *filename, const char *srchash, const char *css, const char *includes);
+static bool	check_outnames(man_job_t *jobs, size_t *num_jobs, const char *outdir);
+#if !_WIN32
+static int	compare_jobs(const man_job_t *a, const man_job_t *b);
+#endif // !_WIN32
+static int	compare_outnames(man_job_t **a, man_job_t **b);
+static bool	convert_file(const man_job_t *job, const char *outdir, const char *cachedir, int compress);
+static const char *format_suffix(mantohtml_format_t format, const char *suffix);
+static char	*hash_file(const char *filename, char *buffer, size_t bufsize);
+static unsigned long long hash_string(unsigned long long hash, const char *s);
+static void	include_cb(mantohtml_sink_t *includes, const char *filename);
+static void	index_add(mantohtml_index_t *index, man_job_t *jobs, size_t num_jobs, const char *outdir);
+static bool	index_write(mantohtml_index_t *index, const mantohtml_options_t *options, const char *outdir, const char *indexname, int compress);
+static bool	link_css(man_job_t *jobs, size_t num_jobs, mantohtml_options_t *options, const char *outdir, int compress);
+static char	*make_outname(char *buffer, size_t bufsize, const char *outdir, const char *subdir, const char *filename, const char *suffix);
+static bool	output_close(man_output_t *output, mantohtml_sink_t *sink, bool ret);
+static bool	output_compress(man_output_t *output, const char *data, size_t len, bool finish);
+static mantohtml_sink_t *output_open(man_output_t *output, const char *outname, int compress);
+static bool	output_write(man_output_t *output, const char *data, size_t len);
+static bool	run_jobs(man_job_t *jobs, size_t num_jobs, const char *outdir, const char *cachedir, int compress, int num_workers);
+#if !_WIN32
+static bool	run_queue(man_pool_t *pool, man_queue_t *queue, size_t *job);
+static void	*run_worker(man_worker_t *worker);
+#endif // !_WIN32
+static bool	serve(const char *name, const mantohtml_options_t *options, int num_workers);
+static bool	serve_client(int infd, int outfd, const mantohtml_options_t *options);
+static size_t	serve_read(man_client_t *client, char *data, size_t len);
+#if !_WIN32
+static void	*serve_worker(man_server_t *server);
+static void	sort_jobs(man_job_t *jobs, size_t num_jobs, int num_workers);
+#endif // !_WIN32
+static bool	stats_write(mantohtml_stats_t *stats, const char *filename);
+#if !_WIN32
+static bool	tree_dir(man_tdir_t *dir);
+static bool	tree_scan(man_job_t *trees, size_t num_trees, man_job_t **jobs, size_t *num_jobs, size_t *alloc_jobs, const char *outdir, const char *cachedir, int num_workers);
+static void	*tree_worker(man_tree_t *tree);
+#endif // !_WIN32
+static int	usage(void);
+static bool	write_fd(int fd, const void *data, size_t len);
 
 
 //
@@ -110,12 +223,32 @@ main(int  argc,				// I - Number of command-line args
      char *argv[])			// I - Command-line arguments
 {
   int		i;			// Looping var
-  man_state_t	state;			// Current man state
+  mantohtml_options_t options;		// Conversion options
+  mantohtml_sink_t *out = NULL;		// Standard output sink
+  mantohtml_t	*doc = NULL;		// Standard output document
   bool		end_of_options = false;	// End of options seen?
-
-
-  // Initialize the current state...
-  memset(&state, 0, sizeof(state));
+  const char	*outdir = NULL,		// Output directory, if any
+		*cachedir = NULL,	// Cache directory, if any
+		*indexname = NULL,	// Index filename, if any
+		*servename = NULL,	// Server socket, if any
+		*statsname = NULL;	// Statistics filename, if any
+  int		compress = MAN_COMPRESS_NONE,
+					// Compressed copies to write
+		num_files = 0,		// Number of files converted
+		num_workers = 1,	// Number of worker threads
+		formats = 0,		// Additional output formats
+		status = 0;		// Exit status
+  man_job_t	*jobs = NULL,		// Batch conversion jobs
+		*trees = NULL;		// Man directory trees
+  size_t	num_jobs = 0,		// Number of jobs
+		alloc_jobs = 0,		// Allocated jobs
+		num_trees = 0,		// Number of trees
+		alloc_trees = 0;	// Allocated trees
+
+
+  // Initialize the options...
+  memset(&options, 0, sizeof(options));
+  options.suffix = ".html";
 
   // Parse command-line...
   for (i = 1; i < argc; i ++)
@@ -130,7 +263,19 @@ main(int  argc,				// I - Number of command-line args
         return (1);
       }
 
-      state.author = argv[i];
+      options.author = argv[i];
+    }
+    else if (!strcmp(argv[i], "--cache"))
+    {
+      // --cache "DIR"
+      i ++;
+      if (i >= argc)
+      {
+        fputs("mantohtml: Missing directory after --cache.\n", stderr);
+        return (1);
+      }
+
+      cachedir = argv[i];
     }
     else if (!strcmp(argv[i], "--chapter"))
     {
@@ -142,7 +287,50 @@ main(int  argc,				// I - Number of command-line args
         return (1);
       }
 
-      state.chapter = argv[i];
+      options.chapter = argv[i];
+    }
+    else if (!strcmp(argv[i], "--compact"))
+    {
+      // --compact
+      options.compact = true;
+    }
+    else if (!strcmp(argv[i], "--compress"))
+    {
+      // --compress FORMAT[,FORMAT]
+      char	*format,		// Current format
+		*next;			// Next format
+
+      i ++;
+      if (i >= argc)
+      {
+        fputs("mantohtml: Missing formats after --compress.\n", stderr);
+        return (1);
+      }
+
+      for (format = argv[i]; format; format = next)
+      {
+        if ((next = strchr(format, ',')) != NULL)
+          *next++ = '\0';
+
+        if (!strcmp(format, "gzip") || !strcmp(format, "gz"))
+        {
+          compress |= MAN_COMPRESS_GZIP;
+        }
+        else if (!strcmp(format, "br") || !strcmp(format, "brotli"))
+        {
+#ifdef HAVE_BROTLI
+          compress |= MAN_COMPRESS_BROTLI;
+#else
+          fputs("mantohtml: Brotli compression is not supported.\n", stderr);
+          return (1);
+#endif // HAVE_BROTLI
+        }
+        else
+        {
+          fprintf(stderr, "mantohtml: Unknown compression format '%s'.\n", format);
+          return (1);
+        }
+      }
     }
     else if (!strcmp(argv[i], "--copyright"))
     {
@@ -154,7 +342,7 @@ main(int  argc,				// I - Number of command-line args
         return (1);
       }
 
-      state.copyright = argv[i];
+      options.copyright = argv[i];
     }
     else if (!strcmp(argv[i], "--css"))
     {
@@ -166,12 +354,175 @@ main(int  argc,				// I - Number of command-line args
         return (1);
       }
 
-      state.css = argv[i];
+      options.css = argv[i];
+    }
+    else if (!strcmp(argv[i], "--css-link"))
+    {
+      // --css-link
+      options.css_link = true;
+    }
+    else if (!strcmp(argv[i], "--format"))
+    {
+      // --format FORMAT[,FORMAT]
+      char	*format,		// Current format
+		*next;			// Next format
+      mantohtml_format_t fvalue;	// Format value
+      bool	first = true;		// First format?
+
+      i ++;
+      if (i >= argc)
+      {
+        fputs("mantohtml: Missing formats after --format.\n", stderr);
+        return (1);
+      }
+
+      // The first format is written to the usual output file, the others to
+      // additional files with the same base name...
+      formats = 0;
+
+      for (format = argv[i]; format; format = next)
+      {
+        if ((next = strchr(format, ',')) != NULL)
+          *next++ = '\0';
+
+        if (!strcmp(format, "html"))
+        {
+          fvalue = MANTOHTML_FORMAT_HTML;
+        }
+        else if (!strcmp(format, "fragment"))
+        {
+          fvalue = MANTOHTML_FORMAT_FRAGMENT;
+        }
+        else if (!strcmp(format, "json"))
+        {
+          fvalue = MANTOHTML_FORMAT_JSON;
+        }
+        else if (!strcmp(format, "text"))
+        {
+          fvalue = MANTOHTML_FORMAT_TEXT;
+        }
+        else
+        {
+          fprintf(stderr, "mantohtml: Unknown output format '%s'.\n", format);
+          return (1);
+        }
+
+        if (first)
+          options.format = fvalue;
+        else if (fvalue != options.format)
+          formats |= 1 << fvalue;
+
+        first = false;
+      }
+
+      if ((options.format == MANTOHTML_FORMAT_HTML && (formats & (1 << MANTOHTML_FORMAT_FRAGMENT))) || (options.format == MANTOHTML_FORMAT_FRAGMENT && (formats & (1 << MANTOHTML_FORMAT_HTML))))
+      {
+        fputs("mantohtml: The 'html' and 'fragment' formats cannot be used together.\n", stderr);
+        return (1);
+      }
     }
     else if (!strcmp(argv[i], "--help"))
     {
       // --help
-      return (usage(NULL));
+      return (usage());
+    }
+    else if (!strcmp(argv[i], "--index"))
+    {
+      // --index "NAME"
+      i ++;
+      if (i >= argc)
+      {
+        fputs("mantohtml: Missing name after --index.\n", stderr);
+        return (1);
+      }
+
+      if (num_files > 0)
+      {
+        fputs("mantohtml: '--index' must precede any MAN-FILE arguments.\n", stderr);
+        return (1);
+      }
+
+      indexname = argv[i];
+    }
+    else if (!strcmp(argv[i], "--jobs") || !strcmp(argv[i], "-j"))
+    {
+      // --jobs N
+      i ++;
+      if (i >= argc || !isdigit(argv[i][0] & 255))
+      {
+        fputs("mantohtml: Missing number of jobs after --jobs.\n", stderr);
+        return (1);
+      }
+
+      if ((num_workers = atoi(argv[i])) == 0)
+      {
+        // Use one job per CPU...
+#if _WIN32
+        num_workers = 1;
+#else
+        long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+					// Number of CPUs
+
+        num_workers = ncpus > 0 ? (int)ncpus : 1;
+#endif // _WIN32
+      }
+    }
+    else if (!strcmp(argv[i], "--output-dir"))
+    {
+      // --output-dir "DIR"
+      i ++;
+      if (i >= argc)
+      {
+        fputs("mantohtml: Missing directory after --output-dir.\n", stderr);
+        return (1);
+      }
+
+      if (doc)
+      {
+        fputs("mantohtml: '--output-dir' must precede any MAN-FILE arguments.\n", stderr);
+        return (1);
+      }
+
+      outdir = argv[i];
+    }
+    else if (!strcmp(argv[i], "--serve"))
+    {
+      // --serve "-" or --serve "SOCKET"
+      i ++;
+      if (i >= argc)
+      {
+        fputs("mantohtml: Missing socket after --serve.\n", stderr);
+        return (1);
+      }
+
+      if (num_files > 0)
+      {
+        fputs("mantohtml: '--serve' cannot be used with MAN-FILE arguments.\n", stderr);
+        return (1);
+      }
+
+      servename = argv[i];
+    }
+    else if (!strcmp(argv[i], "--stats"))
+    {
+      // --stats "FILENAME"
+      i ++;
+      if (i >= argc)
+      {
+        fputs("mantohtml: Missing filename after --stats.\n", stderr);
+        return (1);
+      }
+
+      if (!options.stats && (options.stats = mantohtml_stats_new()) == NULL)
+      {
+        if (errno == ENOTSUP)
+          fputs("mantohtml: '--stats' is not supported by this build of mantohtml.\n", stderr);
+        else
+          perror("mantohtml");
+        return (1);
+      }
+
+      statsname = argv[i];
     }
     else if (!strcmp(argv[i], "--subject"))
     {
@@ -183,7 +534,42 @@ main(int  argc,				// I - Number of command-line args
         return (1);
       }
 
-      state.subject = argv[i];
+      options.subject = argv[i];
+    }
+    else if (!strcmp(argv[i], "--suffix"))
+    {
+      // --suffix ".EXT"
+      i ++;
+      if (i >= argc)
+      {
+        fputs("mantohtml: Missing suffix after --suffix.\n", stderr);
+        return (1);
+      }
+
+      options.suffix = argv[i];
+    }
+    else if (!strcmp(argv[i], "--threads"))
+    {
+      // --threads N
+      i ++;
+      if (i >= argc || !isdigit(argv[i][0] & 255))
+      {
+        fputs("mantohtml: Missing number of threads after --threads.\n", stderr);
+        return (1);
+      }
+
+      if ((options.threads = atoi(argv[i])) == 0)
+      {
+        // Use one thread per CPU...
+#if _WIN32
+        options.threads = 1;
+#else
+        long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+					// Number of CPUs
+
+        options.threads = ncpus > 0 ? (int)ncpus : 1;
+#endif // _WIN32
+      }
     }
     else if (!strcmp(argv[i], "--title"))
     {
@@ -195,7 +581,50 @@ main(int  argc,				// I - Number of command-line args
         return (1);
       }
 
-      state.title = argv[i];
+      options.title = argv[i];
+    }
+    else if (!strcmp(argv[i], "--toc"))
+    {
+      // --toc
+      options.toc = true;
+    }
+    else if (!strcmp(argv[i], "--tree"))
+    {
+      // --tree "MAN-DIR"
+      i ++;
+      if (i >= argc)
+      {
+        fputs("mantohtml: Missing directory after --tree.\n", stderr);
+        return (1);
+      }
+
+#if _WIN32
+      fputs("mantohtml: '--tree' is not supported on Windows.\n", stderr);
+      return (1);
+#else
+      // Trees are scanned once all of the options are known...
+      if (num_trees >= alloc_trees)
+      {
+        man_job_t *temp;		// New trees array
+
+        alloc_trees += 16;
+
+        if ((temp = realloc(trees, alloc_trees * sizeof(man_job_t))) == NULL)
+        {
+          perror("mantohtml");
+          return (1);
+        }
+
+        trees = temp;
+      }
+
+      memset(trees + num_trees, 0, sizeof(man_job_t));
+      trees[num_trees].filename = argv[i];
+      trees[num_trees].formats  = formats;
+      trees[num_trees].options  = options;
+      num_trees ++;
+      num_files ++;
+#endif // _WIN32
     }
     else if (!strcmp(argv[i], "--version"))
     {
@@ -208,1633 +637,2292 @@ main(int  argc,				// I - Number of command-line args
       // -- (end of options)
       end_of_options = true;
     }
-    else if (argv[i][0] == '-' && !end_of_options)
+    else if (argv[i][0] == '-' && argv[i][1] && !end_of_options)
     {
       // Unknown option...
-      return (usage(argv[i]));
+      return (usage());
+    }
+    else if (servename)
+    {
+      fputs("mantohtml: '--serve' cannot be used with MAN-FILE arguments.\n", stderr);
+      return (1);
+    }
+    else if (outdir)
+    {
+      // Queue the named file for conversion to its own output file...
+      if (!strcmp(argv[i], "-"))
+      {
+        fputs("mantohtml: '-' cannot be used with '--output-dir'.\n", stderr);
+        return (1);
+      }
+
+      if (num_jobs >= alloc_jobs)
+      {
+        man_job_t *temp;		// New jobs array
+
+        alloc_jobs += 1024;
+
+        if ((temp = realloc(jobs, alloc_jobs * sizeof(man_job_t))) == NULL)
+        {
+          perror("mantohtml");
+          return (1);
+        }
+
+        jobs = temp;
+      }
+
+      memset(jobs + num_jobs, 0, sizeof(man_job_t));
+      jobs[num_jobs].filename = argv[i];
+      jobs[num_jobs].formats  = formats;
+      jobs[num_jobs].options  = options;
+      num_jobs ++;
+      num_files ++;
     }
     else
     {
-      // Convert the named file...
-      convert_man(&state, argv[i]);
+      // Convert the named file and add it to the standard output document...
+      if (cachedir)
+      {
+        fputs("mantohtml: '--cache' requires '--output-dir'.\n", stderr);
+        return (1);
+      }
+
+      if (!options.cache && (options.cache = mantohtml_cache_new()) == NULL)
+      {
+        perror("mantohtml");
+        return (1);
+      }
+
+      if (!doc)
+      {
+        if ((out = mantohtml_sink_new_fd(1)) == NULL || (doc = mantohtml_new(&options, out)) == NULL)
+        {
+          perror("mantohtml");
+          return (1);
+        }
+      }
+      else
+      {
+        mantohtml_set_options(doc, &options);
+      }
+
+      if (!strcmp(argv[i], "-"))
+      {
+        // Convert the standard input as it is read...
+        if (!mantohtml_add_fd(doc, "(stdin)", 0))
+          status = 1;
+      }
+      else if (!mantohtml_add_file(doc, argv[i]))
+      {
+        status = 1;
+      }
+
+      num_files ++;
     }
   }
 
   // Finish up...
-  if (state.wrote_header)
+  if (cachedir && !outdir)
   {
-    // HTML footer and return...
-    html_footer(&state);
-    return (0);
+    fputs("mantohtml: '--cache' requires '--output-dir'.\n", stderr);
+    return (1);
   }
 
-  // If we get here we didn't have any man pages to convert...
-  usage(NULL);
+  if (num_trees > 0 && !outdir)
+  {
+    fputs("mantohtml: '--tree' requires '--output-dir'.\n", stderr);
+    return (1);
+  }
 
-  return (1);
-}
+  if (formats && !outdir)
+  {
+    fputs("mantohtml: Multiple formats require '--output-dir'.\n", stderr);
+    return (1);
+  }
 
+  if (compress && !outdir)
+  {
+    fputs("mantohtml: '--compress' requires '--output-dir'.\n", stderr);
+    return (1);
+  }
 
-//
-// 'convert_man()' - Convert a man page.
-//
+  if (indexname && !outdir)
+  {
+    fputs("mantohtml: '--index' requires '--output-dir'.\n", stderr);
+    return (1);
+  }
 
-static void
-convert_man(man_state_t *state,		// I - Current man state
-            const char  *filename)	// I - Man filename
-{
-  FILE		*fp;			// Man file
-  char		line[65536],		// Line from file
-		macro[4];		// Macro from line
-  const char	*lineptr;		// Pointer into line
-  int		linenum = 0;		// Current line number
-  bool		th_seen = false,	// Have we seen the TH macro?
-		warning = false;	// Have we displayed a warning?
-  const char	*break_text = "";	// Text to break after next line
+  if (indexname && cachedir)
+  {
+    // Cached man pages are not converted, so their anchors would be missing
+    // from the index and their links would not change with the index...
+    fputs("mantohtml: '--cache' cannot be used with '--index'.\n", stderr);
+    return (1);
+  }
 
+  if (servename && outdir)
+  {
+    fputs("mantohtml: '--serve' cannot be used with '--output-dir'.\n", stderr);
+    return (1);
+  }
 
-  if ((fp = fopen(filename, "r")) == NULL)
+  if (!servename && num_files == 0)
   {
-    perror(filename);
-    return;
+    // If we get here we didn't have any man pages to convert...
+    return (usage());
   }
 
-  if (strchr(filename, '/'))
+  // Create the output and cache directories as needed...
+  if (outdir && mkdir(outdir, 0777) && errno != EEXIST)
   {
-    // Calculate base path for man source...
-    char	*baseptr;		// Pointer into base path
+    perror(outdir);
+    return (1);
+  }
 
-    safe_strcpy(state->basepath, filename, sizeof(state->basepath));
+  if (cachedir && mkdir(cachedir, 0777) && errno != EEXIST)
+  {
+    perror(cachedir);
+    return (1);
+  }
 
-    if ((baseptr = strrchr(state->basepath, '/')) != NULL)
-      *baseptr = '\0';
-    else
-      safe_strcpy(state->basepath, ".", sizeof(state->basepath));
+  // Share a single include cache between all man pages, so that each ".so"
+  // alias page only needs to be converted once...
+  if (!options.cache && (options.cache = mantohtml_cache_new()) == NULL)
+  {
+    perror("mantohtml");
+    return (1);
   }
-  else
+
+  if (indexname && (options.index = mantohtml_index_new()) == NULL)
   {
-    // Assume the man source is in the current directory...
-    safe_strcpy(state->basepath, ".", sizeof(state->basepath));
+    perror("mantohtml");
+    mantohtml_cache_delete(options.cache);
+    return (1);
   }
 
-  while (man_gets(fp, line, sizeof(line), &linenum))
+  for (i = 0; i < (int)num_jobs; i ++)
   {
-//    fprintf(stderr, "%5d: %s\n", linenum, line);
+    jobs[i].options.cache = options.cache;
+    jobs[i].options.index = options.index;
+  }
 
-    if (line[0] == '.')
-    {
-      // Start of a macro
-      lineptr = line;
-      parse_value(macro, &lineptr, sizeof(macro));
+  for (i = 0; i < (int)num_trees; i ++)
+  {
+    trees[i].options.cache = options.cache;
+    trees[i].options.index = options.index;
+  }
 
-      if (!strcmp(macro, "."))
-      {
-        // . (blank line)
-        continue;
-      }
-      else if (!strcmp(macro, ".TH"))
-      {
-        // .TH title section [footer-middle [footer-inside [header-middle]]]
-        char	title[256],		// Man title
-		section[32],		// Man section
-		topic[300];		// title(section)
+  if (servename)
+  {
+    // Convert man pages on request, reusing the include cache and buffers
+    // between requests...
+    if (!serve(servename, &options, num_workers))
+      status = 1;
+  }
 
-        if (!parse_value(title, &lineptr, sizeof(title)) || !title[0])
-        {
-          fprintf(stderr, "mantohtml: Missing title in '.TH' on line %d of '%s'.\n", linenum, filename);
-          exit(1);
-        }
+#if !_WIN32
+  if (num_trees > 0)
+  {
+    // Add the man pages in each tree...
+    if (!tree_scan(trees, num_trees, &jobs, &num_jobs, &alloc_jobs, outdir, cachedir, num_workers))
+      status = 1;
 
-        if (!parse_value(section, &lineptr, sizeof(section)) || !isdigit(section[0] & 255))
-        {
-          fprintf(stderr, "mantohtml: Missing section in '.TH' on line %d of '%s'.\n", linenum, filename);
-          exit(1);
-        }
+    free(trees);
+  }
+#endif // !_WIN32
 
-        snprintf(topic, sizeof(topic), "%s(%s)", title, section);
+  if (num_jobs > 0)
+  {
+    if (!check_outnames(jobs, &num_jobs, outdir))
+    {
+      // Don't write more than one man page to the same file, which parallel
+      // jobs would do at the same time...
+      status = 1;
+    }
+    else
+    {
+      // Convert each man page to a separate file, indexing them first so that
+      // references to any of them can be linked...
+      if (options.index)
+        index_add(options.index, jobs, num_jobs, outdir);
 
-        if (!state->wrote_header)
-        {
-          html_header(state, topic);
-        }
-        else
-        {
-	  if (state->in_link)
-	  {
-	    puts("</a>");
-	    state->in_link = false;
-	  }
-
-	  if (state->in_block)
-	  {
-	    printf("</%s>\n", state->in_block);
-	    state->in_block = NULL;
-	  }
-	}
-
-        html_heading(state, MAN_HEADING_TOPIC, topic);
-
-        th_seen = true;
-      }
-      else if (!th_seen)
+      if (options.css_link && !link_css(jobs, num_jobs, &options, outdir, compress))
+        status = 1;
+
+#if !_WIN32
+      // Convert the largest man pages in the trees first...
+      if (num_trees > 0)
+        sort_jobs(jobs, num_jobs, num_workers);
+#endif // !_WIN32
+
+      if (!run_jobs(jobs, num_jobs, outdir, cachedir, compress, num_workers))
+        status = 1;
+
+      if (options.index && !index_write(options.index, &options, outdir, indexname, compress))
+        status = 1;
+    }
+
+    for (i = 0; i < (int)num_jobs; i ++)
+    {
+      // Jobs from --tree have their own filename and subdirectory...
+      if (jobs[i].subdir)
       {
-        if (!warning)
-        {
-	  fprintf(stderr, "mantohtml: Need '.TH' before '%s' macro on line %d of '%s'.\n", macro, linenum, filename);
-	  warning = true;
-	}
-        continue;
+        free((char *)jobs[i].filename);
+        free(jobs[i].subdir);
       }
-      else if (!strcmp(macro, ".B"))
-      {
-        // .B bold text
-        man_font_t	font = state->font;
-					// Current font
+    }
 
-        if (!*lineptr)
-        {
-          man_gets(fp, line, sizeof(line), &linenum);
-          lineptr = line;
-        }
+    free(jobs);
+  }
 
-        html_font(state, MAN_FONT_BOLD);
-        man_puts(state, lineptr);
-        html_font(state, font);
+  if (doc)
+  {
+    // HTML footer and return...
+    if (!mantohtml_finish(doc))
+    {
+      perror("mantohtml");
+      status = 1;
+    }
 
-        puts(break_text);
-        break_text = "";
-      }
-      else if (!strcmp(macro, ".BI"))
-      {
-        // .BI bold italic ...
-        if (!*lineptr)
-        {
-          man_gets(fp, line, sizeof(line), &linenum);
-          lineptr = line;
-        }
+    mantohtml_delete(doc);
+    mantohtml_sink_delete(out);
+  }
 
-        man_xx(state, MAN_FONT_BOLD, MAN_FONT_ITALIC, lineptr);
-        puts(break_text);
-        break_text = "";
-      }
-      else if (!strcmp(macro, ".BR"))
+  if (statsname && !stats_write(options.stats, statsname))
+    status = 1;
+
+  mantohtml_cache_delete(options.cache);
+  mantohtml_index_delete(options.index);
+  mantohtml_stats_delete(options.stats);
+
+  return (status);
+}
+
+
+//
+// 'cache_check()' - Check whether a cached HTML file is up to date.
+//
+// Cache files contain a header with the mantohtml version, output filename,
+// and a hash of the conversion and output format options, followed by a "file HASH FILENAME"
+// line for the man file and each file it uses (included files and local
+// stylesheet).
+//
+
+static bool				// O - `true` if up to date, `false` otherwise
+cache_check(
+    const char         *cachename,	// I - Cache filename
+    const char         *header,		// I - Expected cache header
+    const char * const *outnames,	// I - Output filenames
+    size_t             num_outnames,	// I - Number of output filenames
+    int                compress)	// I - Compressed copies to check
+{
+  FILE		*fp;			// Cache file
+  char		line[1300],		// Line from cache file
+		*lineptr,		// Pointer into line
+		hash[17],		// Current file hash
+		compname[1100];		// Compressed copy filename
+  size_t	i,			// Looping var
+		hlen;			// Length of current header line
+  int		files = 0;		// Number of files checked
+  bool		ret = true;		// Return value
+  struct stat	outinfo;		// Output file information
+
+
+  for (i = 0; i < num_outnames; i ++)
+  {
+    if (stat(outnames[i], &outinfo))
+      return (false);
+
+    // The compressed copies must also exist...
+    if (compress & MAN_COMPRESS_GZIP)
+    {
+      snprintf(compname, sizeof(compname), "%s.gz", outnames[i]);
+      if (stat(compname, &outinfo))
+        return (false);
+    }
+
+    if (compress & MAN_COMPRESS_BROTLI)
+    {
+      snprintf(compname, sizeof(compname), "%s.br", outnames[i]);
+      if (stat(compname, &outinfo))
+        return (false);
+    }
+  }
+
+  if ((fp = fopen(cachename, "r")) == NULL)
+    return (false);
+
+  // Compare the header...
+  while (*header && ret)
+  {
+    hlen = (size_t)(strchr(header, '\n') + 1 - header);
+
+    if (!fgets(line, sizeof(line), fp) || strlen(line) != hlen || strncmp(line, header, hlen))
+      ret = false;
+
+    header += hlen;
+  }
+
+  // Then compare each file...
+  while (ret && fgets(line, sizeof(line), fp))
+  {
+    if (strncmp(line, "file ", 5) || strlen(line) < 24 || line[21] != ' ' || (lineptr = strchr(line, '\n')) == NULL)
+    {
+      ret = false;
+      break;
+    }
+
+    *lineptr = '\0';
+    line[21] = '\0';
+
+    if (!hash_file(line + 22, hash, sizeof(hash)) || strcmp(hash, line + 5))
+      ret = false;
+
+    files ++;
+  }
+
+  fclose(fp);
+
+  return (ret && files > 0);
+}
+
+
+//
+// 'cache_update()' - Update the cache file for a HTML file.
+//
+
+static bool				// O - `true` on success, `false` on error
+cache_update(const char *cachename,	// I - Cache filename
+             const char *header,	// I - Cache header
+             const char *filename,	// I - Man filename
+             const char *srchash,	// I - Hash of man file
+             const char *css,		// I - Stylesheet or `NULL`
+             const char *includes)	// I - Included files, one per line
+{
+  FILE		*fp;			// Cache file
+  char		tempname[1100],		// Temporary cache filename
+		hash[17];		// Hash of stylesheet/included file
+  const char	*incptr,		// Pointer into included files
+		*incend;		// End of included filename
+  bool		ret = true;		// Return value
+
+
+  // Write to a temporary file and then rename so a cache file is never
+  // incomplete...
+  snprintf(tempname, sizeof(tempname), "%s.tmp", cachename);
+
+  if ((fp = fopen(tempname, "w")) == NULL)
+  {
+    perror(tempname);
+    return (false);
+  }
+
+  fputs(header, fp);
+  fprintf(fp, "file %s %s\n", srchash, filename);
+
+  if (css && strncmp(css, "http://", 7) && strncmp(css, "https://", 8) && hash_file(css, hash, sizeof(hash)))
+    fprintf(fp, "file %s %s\n", hash, css);
+
+  for (incptr = includes; *incptr; incptr = incend + 1)
+  {
+    char	incname[1024];		// Included filename
+
+    incend = strchr(incptr, '\n');
+
+    if ((size_t)(incend - incptr) >= sizeof(incname))
+    {
+      ret = false;
+      break;
+    }
+
+    memcpy(incname, incptr, (size_t)(incend - incptr));
+    incname[incend - incptr] = '\0';
+
+    if (!hash_file(incname, hash, sizeof(hash)))
+    {
+      ret = false;
+      break;
+    }
+
+    fprintf(fp, "file %s %s\n", hash, incname);
+  }
+
+  if (ferror(fp))
+    ret = false;
+
+  if (fclose(fp) || !ret || rename(tempname, cachename))
+  {
+    // Don't leave a cache file that can't be trusted...
+    perror(tempname);
+    unlink(tempname);
+    return (false);
+  }
+
+  return (true);
+}
+
+
+//
+// 'check_outnames()' - Check that each job has its own output file.
+//
+// Man pages with the same name and section, such as "foo.1" and "foo.1.gz",
+// have the same output file.  The first by filename is kept and the others
+// are skipped, so that parallel jobs never write the same file.
+//
+
+static bool				// O - `true` on success, `false` on error
+check_outnames(man_job_t  *jobs,	// I - Jobs
+               size_t     *num_jobs,	// IO - Number of jobs
+               const char *outdir)	// I - Output directory
+{
+  size_t	i, j;			// Looping vars
+  man_job_t	**sorted;		// Jobs sorted by output filename
+  char		iname[1024],		// Output filename of this job
+		jname[1024];		// Output filename of kept job
+
+
+  if (*num_jobs < 2)
+    return (true);
+
+  if ((sorted = calloc(*num_jobs, sizeof(man_job_t *))) == NULL)
+  {
+    perror("mantohtml");
+    return (false);
+  }
+
+  for (i = 0; i < *num_jobs; i ++)
+    sorted[i] = jobs + i;
+
+  qsort(sorted, *num_jobs, sizeof(man_job_t *), (int (*)(const void *, const void *))compare_outnames);
+
+  if (!make_outname(jname, sizeof(jname), outdir, sorted[0]->subdir, sorted[0]->filename, format_suffix(sorted[0]->options.format, sorted[0]->options.suffix)))
+    jname[0] = '\0';
+
+  for (i = 1, j = 0; i < *num_jobs; i ++)
+  {
+    if (!make_outname(iname, sizeof(iname), outdir, sorted[i]->subdir, sorted[i]->filename, format_suffix(sorted[i]->options.format, sorted[i]->options.suffix)))
+      iname[0] = '\0';
+
+    if (!iname[0] || strcmp(iname, jname))
+    {
+      memcpy(jname, iname, sizeof(jname));
+      j = i;
+      continue;
+    }
+
+    fprintf(stderr, "mantohtml: Skipping '%s' with the same output file as '%s'.\n", sorted[i]->filename, sorted[j]->filename);
+
+    // Jobs from --tree have their own filename and subdirectory...
+    if (sorted[i]->subdir)
+    {
+      free((char *)sorted[i]->filename);
+      free(sorted[i]->subdir);
+    }
+
+    sorted[i]->filename = NULL;
+  }
+
+  free(sorted);
+
+  for (i = j = 0; i < *num_jobs; i ++)
+  {
+    if (jobs[i].filename)
+      jobs[j ++] = jobs[i];
+  }
+
+  *num_jobs = j;
+
+  return (true);
+}
+
+
+#if !_WIN32
+//
+// 'compare_jobs()' - Compare two jobs by size, largest first.
+//
+
+static int				// O - Result of comparison
+compare_jobs(const man_job_t *a,	// I - First job
+             const man_job_t *b)	// I - Second job
+{
+  if (a->size > b->size)
+    return (-1);
+  else if (a->size < b->size)
+    return (1);
+  else
+    return (strcmp(a->filename, b->filename));
+}
+#endif // !_WIN32
+
+
+//
+// 'compare_outnames()' - Compare two jobs by output filename and then man
+//                        filename.
+//
+
+static int				// O - Result of comparison
+compare_outnames(man_job_t **a,		// I - First job
+                 man_job_t **b)		// I - Second job
+{
+  int	ret;				// Result of comparison
+  char	aname[1024],			// First output filename
+	bname[1024];			// Second output filename
+
+
+  make_outname(aname, sizeof(aname), "", (*a)->subdir, (*a)->filename, format_suffix((*a)->options.format, (*a)->options.suffix));
+  make_outname(bname, sizeof(bname), "", (*b)->subdir, (*b)->filename, format_suffix((*b)->options.format, (*b)->options.suffix));
+
+  if ((ret = strcmp(aname, bname)) == 0)
+    ret = strcmp((*a)->filename, (*b)->filename);
+
+  return (ret);
+}
+
+
+//
+// 'convert_file()' - Convert a man page to a separate HTML file.
+//
+// The man page is parsed once and written in the main output format and each
+// of the additional formats, using the same base name for each output file.
+//
+
+static bool				// O - `true` on success, `false` on error
+convert_file(
+    const man_job_t *job,		// I - Job
+    const char      *outdir,		// I - Output directory
+    const char      *cachedir,		// I - Cache directory or `NULL`
+    int             compress)		// I - Compressed copies to write
+{
+  const mantohtml_options_t *options = &job->options;
+					// Conversion options
+  const char	*filename = job->filename;
+					// Man filename
+  mantohtml_sink_t *outs[MANTOHTML_FORMAT_TEXT + 1],
+					// Output sinks for this file
+		*includes = NULL;	// Included files for the cache
+  mantohtml_options_t cacheopts;	// Options with include callback
+  mantohtml_t	*doc;			// HTML document
+  mantohtml_format_t formats[MANTOHTML_FORMAT_TEXT + 1],
+					// Output formats
+		format;			// Current format
+  man_output_t	*outputs;		// Output files
+  char		outnames[MANTOHTML_FORMAT_TEXT + 1][1024],
+					// Output filenames
+		*outname = outnames[0],	// Main output filename
+		cachename[1024],	// Cache filename
+		header[1300],		// Cache header
+		srchash[17];		// Hash of man file
+  const char	*outptrs[MANTOHTML_FORMAT_TEXT + 1];
+					// Pointers to output filenames
+  size_t	i,			// Looping var
+		num_outputs = 0;	// Number of output files
+  bool		ret;			// Return value
+
+
+  // The main format comes first, followed by any additional formats...
+  formats[num_outputs ++] = options->format;
+
+  for (format = MANTOHTML_FORMAT_HTML; format <= MANTOHTML_FORMAT_TEXT; format ++)
+  {
+    if (job->formats & (1 << format))
+      formats[num_outputs ++] = format;
+  }
+
+  for (i = 0; i < num_outputs; i ++)
+  {
+    if (!make_outname(outnames[i], sizeof(outnames[i]), outdir, job->subdir, filename, format_suffix(formats[i], options->suffix)))
+    {
+      fprintf(stderr, "mantohtml: Output filename for '%s' is too long.\n", filename);
+      return (false);
+    }
+
+    outptrs[i] = outnames[i];
+  }
+
+  if (cachedir)
+  {
+    // See if the cached output is up to date...
+    const char		*base;		// Base name of output file
+    unsigned long long	hash;		// Hash of options
+
+    if ((base = strrchr(outname, '/')) != NULL)
+      base ++;
+    else
+      base = outname;
+
+    if (snprintf(cachename, sizeof(cachename), "%s/%s%s%s.cache", cachedir, job->subdir ? job->subdir : "", job->subdir ? "/" : "", base) >= (int)sizeof(cachename))
+    {
+      fprintf(stderr, "mantohtml: Cache filename for '%s' is too long.\n", filename);
+      return (false);
+    }
+
+    hash = hash_string(14695981039346656037ULL, options->author);
+    hash = hash_string(hash, options->chapter);
+    hash = hash_string(hash, options->compact ? "compact" : NULL);
+    hash = hash_string(hash, options->copyright);
+    hash = hash_string(hash, options->css);
+    hash = hash_string(hash, options->css_link ? "css-link" : NULL);
+    snprintf(header, sizeof(header), "%d %d", options->format, job->formats);
+    hash = hash_string(hash, header);
+    hash = hash_string(hash, options->subject);
+    hash = hash_string(hash, options->suffix);
+    hash = hash_string(hash, options->title);
+    hash = hash_string(hash, options->toc ? "toc" : NULL);
+
+    snprintf(header, sizeof(header), "mantohtml %s\noutput %s\noptions %016llx\n", VERSION, outname, hash);
+
+    if (cache_check(cachename, header, outptrs, num_outputs, compress))
+      return (true);
+
+    // Remove the old cache file before converting and hash the man file so
+    // that a change during conversion is seen next time...
+    unlink(cachename);
+
+    if (!hash_file(filename, srchash, sizeof(srchash)))
+    {
+      perror(filename);
+      return (false);
+    }
+
+    // Record the files included by the man page...
+    if ((includes = mantohtml_sink_new_memory()) == NULL)
+    {
+      perror(filename);
+      return (false);
+    }
+
+    cacheopts                = *options;
+    cacheopts.include_cb     = (mantohtml_include_cb_t)include_cb;
+    cacheopts.include_cbdata = includes;
+    options                  = &cacheopts;
+  }
+
+  if ((outputs = calloc(num_outputs, sizeof(man_output_t))) == NULL)
+  {
+    perror(filename);
+    mantohtml_sink_delete(includes);
+    return (false);
+  }
+
+  memset(outs, 0, sizeof(outs));
+
+  for (i = 0; i < num_outputs; i ++)
+  {
+    if ((outs[i] = output_open(outputs + i, outnames[i], compress)) == NULL)
+      break;
+  }
+
+  if (i < num_outputs)
+  {
+    while (i > 0)
+    {
+      i --;
+      output_close(outputs + i, outs[i], false);
+    }
+
+    free(outputs);
+    mantohtml_sink_delete(includes);
+    return (false);
+  }
+
+  // Each file gets a fresh document with the specified options...
+  if ((doc = mantohtml_new(options, outs[0])) != NULL)
+  {
+    for (i = 1; i < num_outputs; i ++)
+    {
+      if (!mantohtml_add_output(doc, formats[i], outs[i]))
+        break;
+    }
+
+    ret = i == num_outputs && mantohtml_add_file(doc, filename) && mantohtml_finish(doc);
+
+    mantohtml_delete(doc);
+  }
+  else
+  {
+    ret = false;
+  }
+
+  for (i = 0; i < num_outputs; i ++)
+  {
+    if (!output_close(outputs + i, outs[i], ret))
+      ret = false;
+  }
+
+  free(outputs);
+
+  if (ret && cachedir)
+  {
+    const char *incbuf = mantohtml_sink_get_buffer(includes, NULL);
+					// Included files
+
+    if (incbuf)
+      cache_update(cachename, header, filename, srchash, options->css_link ? NULL : options->css, incbuf);
+  }
+
+  mantohtml_sink_delete(includes);
+
+  return (ret);
+}
+
+
+//
+// 'format_suffix()' - Return the output filename suffix for a format.
+//
+
+static const char *			// O - Filename suffix
+format_suffix(
+    mantohtml_format_t format,		// I - Output format
+    const char         *suffix)		// I - Suffix for HTML output
+{
+  switch (format)
+  {
+    case MANTOHTML_FORMAT_JSON :
+        return (".json");
+
+    case MANTOHTML_FORMAT_TEXT :
+        return (".txt");
+
+    default :
+        return (suffix);
+  }
+}
+
+
+//
+// 'hash_file()' - Compute the hash of a file.
+//
+
+static char *				// O - Hash string or `NULL` on error
+hash_file(const char *filename,		// I - Filename
+          char       *buffer,		// I - Hash string buffer
+          size_t     bufsize)		// I - Size of hash string buffer (17+)
+{
+  int			fd;		// File descriptor
+  unsigned char		data[65536],	// Data from file
+			*dataptr;	// Pointer into data
+  ssize_t		bytes;		// Bytes read
+  unsigned long long	hash = 14695981039346656037ULL;
+					// FNV-1a hash
+
+
+  if ((fd = open(filename, O_RDONLY)) < 0)
+    return (NULL);
+
+  while ((bytes = read(fd, data, sizeof(data))) != 0)
+  {
+    if (bytes < 0)
+    {
+      if (errno == EINTR || errno == EAGAIN)
+        continue;
+
+      close(fd);
+      return (NULL);
+    }
+
+    for (dataptr = data; bytes > 0; bytes --, dataptr ++)
+      hash = (hash ^ *dataptr) * 1099511628211ULL;
+  }
+
+  close(fd);
+
+  snprintf(buffer, bufsize, "%016llx", hash);
+
+  return (buffer);
+}
+
+
+//
+// 'hash_string()' - Add a string to a hash.
+//
+// `NULL` strings hash differently from empty strings.
+//
+
+static unsigned long long		// O - New hash
+hash_string(unsigned long long hash,	// I - Current hash
+            const char         *s)	// I - String or `NULL`
+{
+  if (s)
+  {
+    for (; *s; s ++)
+      hash = (hash ^ (*s & 255)) * 1099511628211ULL;
+
+    hash = (hash ^ 1) * 1099511628211ULL;
+  }
+  else
+  {
+    hash = (hash ^ 2) * 1099511628211ULL;
+  }
+
+  return (hash);
+}
+
+
+//
+// 'include_cb()' - Record a file included by a man page.
+//
+
+static void
+include_cb(mantohtml_sink_t *includes,	// I - Included files
+           const char       *filename)	// I - Included filename
+{
+  mantohtml_sink_printf(includes, "%s\n", filename);
+}
+
+
+//
+// 'index_add()' - Add the man pages being converted to the index.
+//
+// Man files that are not named "name.section" are not indexed.
+//
+
+static void
+index_add(mantohtml_index_t *index,	// I - Cross-reference index
+          man_job_t         *jobs,	// I - Jobs
+          size_t            num_jobs,	// I - Number of jobs
+          const char        *outdir)	// I - Output directory
+{
+  size_t	i;			// Looping var
+  char		outname[1024];		// Output filename
+
+
+  for (i = 0; i < num_jobs; i ++)
+  {
+    // The link to each man page is its output filename relative to the output
+    // directory, e.g. "foo.html" or "man1/foo.html" for --tree...
+    if (make_outname(outname, sizeof(outname), outdir, jobs[i].subdir, jobs[i].filename, format_suffix(jobs[i].options.format, jobs[i].options.suffix)))
+      mantohtml_index_add(index, jobs[i].filename, outname + strlen(outdir) + 1);
+  }
+}
+
+
+//
+// 'index_write()' - Write the JSON and HTML index files.
+//
+// The index files are "NAME.json" and "NAME.html" (or the --suffix) in the
+// output directory.
+//
+
+static bool				// O - `true` on success, `false` on error
+index_write(
+    mantohtml_index_t         *index,	// I - Cross-reference index
+    const mantohtml_options_t *options,	// I - Conversion options
+    const char                *outdir,	// I - Output directory
+    const char                *indexname,// I - Base name of index files
+    int                       compress)	// I - Compressed copies to write
+{
+  int		i;			// Looping var
+  char		outname[1024];		// Output filename
+  man_output_t	output;			// Output file
+  mantohtml_sink_t *out;		// Output sink
+  bool		ret = true;		// Return value
+
+
+  for (i = 0; i < 2; i ++)
+  {
+    if (snprintf(outname, sizeof(outname), "%s/%s%s", outdir, indexname, i ? options->suffix : ".json") >= (int)sizeof(outname))
+    {
+      fprintf(stderr, "mantohtml: Index filename for '%s' is too long.\n", indexname);
+      return (false);
+    }
+
+    if ((out = output_open(&output, outname, compress)) == NULL)
+      return (false);
+
+    if (!output_close(&output, out, i ? mantohtml_index_write_html(index, options, out) : mantohtml_index_write_json(index, out)))
+      ret = false;
+  }
+
+  return (ret);
+}
+
+
+//
+// 'link_css()' - Copy stylesheet files to the output directory for linking.
+//
+// Each local stylesheet is copied once to each output (sub)directory and the
+// jobs then reference the copy by its filename, so the HTML files share a
+// single stylesheet.
+//
+
+static bool				// O - `true` on success, `false` on error
+link_css(man_job_t           *jobs,	// I - Jobs
+         size_t              num_jobs,	// I - Number of jobs
+         mantohtml_options_t *options,	// I - Default conversion options
+         const char          *outdir,	// I - Output directory
+         int                 compress)	// I - Compressed copies to write
+{
+  bool		ret = true;		// Return value
+  size_t	i;			// Looping var
+  const char	*css,			// Current stylesheet
+		*subdir,		// Current output subdirectory
+		*lastcss = NULL,	// Last stylesheet copied
+		*lastsubdir = NULL,	// Output subdirectory of last copy
+		*lastbase = NULL;	// Filename of last copy
+  mantohtml_options_t *jobopts;		// Options for current job
+  char		outname[1024],		// Output filename
+		buffer[65536];		// Copy buffer
+  struct stat	srcinfo,		// Source file information
+		dstinfo;		// Destination file information
+  int		srcfd;			// Source file
+  man_output_t	output;			// Destination file
+  mantohtml_sink_t *out;		// Destination sink
+  ssize_t	bytes;			// Bytes read
+
+
+  for (i = 0; i <= num_jobs; i ++)
+  {
+    // Do the jobs and then the default options (for the index)...
+    jobopts = i < num_jobs ? &jobs[i].options : options;
+    subdir  = i < num_jobs ? jobs[i].subdir : NULL;
+
+    if (!jobopts->css_link || (css = jobopts->css) == NULL || !strncmp(css, "http://", 7) || !strncmp(css, "https://", 8))
+      continue;
+
+    if (!lastcss || strcmp(css, lastcss) || (subdir != lastsubdir && (!subdir || !lastsubdir || strcmp(subdir, lastsubdir))))
+    {
+      // Copy a new stylesheet, linking to the original on error...
+      lastcss    = css;
+      lastsubdir = subdir;
+
+      if ((lastbase = strrchr(css, '/')) != NULL)
+        lastbase ++;
+      else
+        lastbase = css;
+
+      if (snprintf(outname, sizeof(outname), "%s/%s%s%s", outdir, subdir ? subdir : "", subdir ? "/" : "", lastbase) >= (int)sizeof(outname))
       {
-        // .BR bold regular ...
-        if (!*lineptr)
-        {
-          man_gets(fp, line, sizeof(line), &linenum);
-          lineptr = line;
-        }
+        fprintf(stderr, "mantohtml: Output filename for '%s' is too long.\n", css);
+        ret      = false;
+        lastbase = NULL;
+        continue;
+      }
 
-        man_xx(state, MAN_FONT_BOLD, MAN_FONT_REGULAR, lineptr);
-        puts(break_text);
-        break_text = "";
+      if ((srcfd = open(css, O_RDONLY)) < 0 || fstat(srcfd, &srcinfo))
+      {
+        perror(css);
+        if (srcfd >= 0)
+          close(srcfd);
+        ret      = false;
+        lastbase = NULL;
+        continue;
       }
-      else if (!strcmp(macro, ".EE") || !strcmp(macro, ".fi"))
+
+      if (!stat(outname, &dstinfo) && srcinfo.st_dev == dstinfo.st_dev && srcinfo.st_ino == dstinfo.st_ino)
       {
-        // .EE (end example)
-        // .fi (resume fill)
-        if (!state->in_block || strcmp(state->in_block, "pre"))
-        {
-          fprintf(stderr, "mantohtml: '%s' with no '.EX' or '.nf' on line %d of '%s'.\n", macro, linenum, filename);
-        }
-        else
-        {
-          puts("</pre>");
-          state->in_block = NULL;
-        }
+        // Already in the output directory...
+        close(srcfd);
       }
-      else if (!strcmp(macro, ".EX") || !strcmp(macro, ".nf"))
+      else if ((out = output_open(&output, outname, compress)) == NULL)
       {
-        // .EX (start example)
-        // .nf (no fill)
-	if (state->in_link)
-	{
-	  puts("</a>");
-	  state->in_link = false;
-	}
-
-        if (state->in_block)
-          printf("</%s>\n", state->in_block);
-
-        fputs("    <pre>", stdout);
-        state->in_block = "pre";
+        close(srcfd);
+        ret      = false;
+        lastbase = NULL;
+        continue;
       }
-      else if (!strcmp(macro, ".HP"))
+      else
       {
-        // .HP indent (hanging paragraph)
-        char	indent[256];		// Indentation
+        while ((bytes = read(srcfd, buffer, sizeof(buffer))) > 0)
+          mantohtml_sink_write(out, buffer, (size_t)bytes);
 
-        if (!parse_measurement(indent, &lineptr, sizeof(indent), 'n'))
-          safe_strcpy(indent, "2.5em", sizeof(indent));
+        if (bytes < 0)
+          perror(css);
 
-	if (state->in_link)
-	{
-	  puts("</a>");
-	  state->in_link = false;
-	}
+        if (!output_close(&output, out, bytes == 0))
+          ret = false;
 
-        if (state->in_block)
-          printf("</%s>\n", state->in_block);
-
-        printf("    <p style=\"margin-left: %s; text-indent: -%s;\">", indent, indent);
-        state->in_block = "p";
+        close(srcfd);
       }
-      else if (!strcmp(macro, ".I"))
-      {
-        // .I italic
-        man_font_t	font = state->font;
-					// Current font
+    }
 
-        if (!*lineptr)
-        {
-          man_gets(fp, line, sizeof(line), &linenum);
-          lineptr = line;
-        }
+    if (lastbase)
+      jobopts->css = lastbase;
+  }
 
-        html_font(state, MAN_FONT_ITALIC);
-        man_puts(state, lineptr);
-        html_font(state, font);
+  return (ret);
+}
 
-        puts(break_text);
-        break_text = "";
-      }
-      else if (!strcmp(macro, ".IB"))
-      {
-        // .IB italic bold
-        if (!*lineptr)
-        {
-          man_gets(fp, line, sizeof(line), &linenum);
-          lineptr = line;
-        }
 
-        man_xx(state, MAN_FONT_ITALIC, MAN_FONT_BOLD, lineptr);
-        puts(break_text);
-        break_text = "";
-      }
-      else if (!strcmp(macro, ".IP"))
-      {
-        // .IP [tag] [indent] (indented paragraph)
-        char 	tag[256],		// Tag text
-		indent[256] = "";	// Indentation
-        const char *list = "";		// List style
-
-        if (parse_value(tag, &lineptr, sizeof(tag)))
-          parse_measurement(indent, &lineptr, sizeof(indent), 'n');
-        if (!indent[0])
-	  safe_strcpy(indent, "2.5em", sizeof(indent));
-
-	if (state->in_link)
-	{
-	  puts("</a>");
-	  state->in_link = false;
-	}
-
-        if (state->in_block && strcmp(state->in_block, "ul"))
-        {
-          printf("</%s>\n", state->in_block);
-          state->in_block = NULL;
-        }
+//
+// 'make_outname()' - Make an output filename for a man page.
+//
+// The output filename is the man page's base name without any compression
+// extension, e.g. "/path/to/foo.1.gz" becomes "OUTDIR/foo.1.html", or
+// "OUTDIR/SUBDIR/foo.1.html" for --tree.  Keeping the section means that
+// "printf.1" and "printf.3" have different output files, and matches the
+// hyperlinks generated for ".BR name (section)".
+//
+
+static char *				// O - Output filename or `NULL` if too long
+make_outname(char       *buffer,	// I - Output filename buffer
+             size_t     bufsize,	// I - Size of output filename buffer
+             const char *outdir,	// I - Output directory
+             const char *subdir,	// I - Output subdirectory or `NULL`
+             const char *filename,	// I - Man filename
+             const char *suffix)	// I - Output filename suffix
+{
+  const char	*base,			// Base name of man file
+		*ext;			// Section extension
+  int		baselen;		// Length of base name
+
 
-        if (!state->in_block)
-          puts("    <ul>");
+  if ((base = strrchr(filename, '/')) != NULL)
+    base ++;
+  else
+    base = filename;
 
-        if (strcmp(tag, "\\(bu") && strcmp(tag, "-") && strcmp(tag, "*"))
-          list = "list-style-type: none; ";
+  baselen = (int)strlen(base);
 
-        html_printf("    <li style=\"%smargin-left: %s;\">", list, indent);
-        state->in_block = "ul";
+  if ((ext = strrchr(base, '.')) != NULL && ext > base && (!strcmp(ext, ".bz2") || !strcmp(ext, ".gz") || !strcmp(ext, ".xz") || !strcmp(ext, ".zst")))
+    baselen = (int)(ext - base);
 
-        break_text = "";
-      }
-      else if (!strcmp(macro, ".IR"))
-      {
-        // .IR italic regular
-        if (!*lineptr)
-        {
-          man_gets(fp, line, sizeof(line), &linenum);
-          lineptr = line;
-        }
+  if (snprintf(buffer, bufsize, "%s/%s%s%.*s%s", outdir, subdir ? subdir : "", subdir ? "/" : "", baselen, base, suffix) >= (int)bufsize)
+    return (NULL);
 
-        man_xx(state, MAN_FONT_ITALIC, MAN_FONT_REGULAR, lineptr);
-        puts(break_text);
-        break_text = "";
-      }
-      else if (!strcmp(macro, ".LP") || !strcmp(macro, ".P") || !strcmp(macro, ".PP"))
-      {
-        // .LP/.P/.PP (paragraph)
-	if (state->in_link)
-	{
-	  puts("</a>");
-	  state->in_link = false;
-	}
-
-        if (state->in_block)
-          printf("</%s>\n", state->in_block);
-
-        fputs("    <p>", stdout);
-        state->in_block = "p";
-      }
-      else if (!strcmp(macro, ".ME") || !strcmp(macro, ".UE"))
-      {
-        // .ME (end mailto link)
-        // .UE (end of URL)
-        if (state->in_link)
-          puts("</a>");
-      }
-      else if (!strcmp(macro, ".MT"))
-      {
-        // .MT email-address
-        char	email[1024];		// Email address
+  return (buffer);
+}
 
-        if (parse_value(email, &lineptr, sizeof(email)) && email[0])
-        {
-          html_printf("<a href=\"mailto:%s\">", email);
-          state->in_link = true;
-        }
-      }
-      else if (!strcmp(macro, ".RB"))
-      {
-        // .RB regular bold
-        if (!*lineptr)
-        {
-          man_gets(fp, line, sizeof(line), &linenum);
-          lineptr = line;
-        }
 
-        man_xx(state, MAN_FONT_REGULAR, MAN_FONT_BOLD, lineptr);
-        puts(break_text);
-        break_text = "";
-      }
-      else if (!strcmp(macro, ".RE"))
-      {
-        // .RE (relative inset end)
-        if (state->indent)
-        {
-          puts("    </div>");
-          state->indent --;
-        }
-        else
-        {
-          fprintf(stderr, "mantohtml: Unbalanced '.RE' on line %d of '%s'.\n", linenum, filename);
-        }
-      }
-      else if (!strcmp(macro, ".RS"))
-      {
-        // .RS (relative inset start)
-        char 	indent[256];		// Indentation
+//
+// 'output_close()' - Finish the compressed copies and close an output file.
+//
+// The output file and its compressed copies are removed on error, or when
+// "ret" is `false` because the output could not be generated.
+//
 
-        if (!parse_measurement(indent, &lineptr, sizeof(indent), 'n'))
-          safe_strcpy(indent, "0.5in", sizeof(indent));
+static bool				// O - `true` on success, `false` on error
+output_close(man_output_t     *output,	// I - Output file
+             mantohtml_sink_t *sink,	// I - Output sink or `NULL`
+             bool             ret)	// I - `true` if the output was generated
+{
+  if (sink)
+  {
+    if (!mantohtml_sink_flush(sink))
+      ret = false;
 
-        printf("    <div style=\"margin-left: %s;\">\n", indent);
-        state->indent ++;
-      }
-      else if (!strcmp(macro, ".SB"))
-      {
-        // .SB small-bold
-        man_font_t	font = state->font;
-					// Current font
+    mantohtml_sink_delete(sink);
+  }
 
-        if (!*lineptr)
-        {
-          man_gets(fp, line, sizeof(line), &linenum);
-          lineptr = line;
-        }
+  if (ret && !output_compress(output, NULL, 0, true))
+    ret = false;
 
-        html_font(state, MAN_FONT_SMALL_BOLD);
-        man_puts(state, lineptr);
-        html_font(state, font);
+  if (output->fd >= 0 && close(output->fd) && ret)
+  {
+    perror(output->outname);
+    ret = false;
+  }
 
-        puts(break_text);
-        break_text = "";
-      }
-      else if (!strcmp(macro, ".SH"))
-      {
-        // .SH section-heading
-	if (state->in_link)
-	{
-	  puts("</a>");
-	  state->in_link = false;
-	}
-
-        if (state->in_block)
-        {
-          printf("</%s>\n", state->in_block);
-          state->in_block = NULL;
-        }
+  if (output->gzfd >= 0 && close(output->gzfd) && ret)
+  {
+    perror(output->gzname);
+    ret = false;
+  }
 
-        html_heading(state, MAN_HEADING_SECTION, lineptr);
-      }
-      else if (!strcmp(macro, ".SM"))
-      {
-        // .SM small
-        man_font_t	font = state->font;
-					// Current font
+  deflateEnd(&output->gzstream);
 
-        if (!*lineptr)
-        {
-          man_gets(fp, line, sizeof(line), &linenum);
-          lineptr = line;
-        }
+#ifdef HAVE_BROTLI
+  if (output->brfd >= 0 && close(output->brfd) && ret)
+  {
+    perror(output->brname);
+    ret = false;
+  }
 
-        html_font(state, MAN_FONT_SMALL);
-        man_puts(state, lineptr);
-        html_font(state, font);
+  if (output->brstate)
+    BrotliEncoderDestroyInstance(output->brstate);
+#endif // HAVE_BROTLI
 
-        puts(break_text);
-        break_text = "";
-      }
-      else if (!strcmp(macro, ".SS"))
-      {
-        // .SS subsection-heading
-	if (state->in_link)
-	{
-	  puts("</a>");
-	  state->in_link = false;
-	}
-
-        if (state->in_block)
-        {
-          printf("</%s>\n", state->in_block);
-          state->in_block = NULL;
-        }
+  if (!ret)
+  {
+    unlink(output->outname);
 
-        html_heading(state, MAN_HEADING_SUBSECTION, lineptr);
-      }
-      else if (!strcmp(macro, ".SY"))
-      {
-        // .SY (start of synopsis)
-        if (state->in_block)
-          printf("</%s>\n", state->in_block);
+    if (output->gzfd >= 0)
+      unlink(output->gzname);
 
-        fputs("    <p style=\"font-family: monospace;\">", stdout);
-        state->in_block = "p";
-      }
-      else if (!strcmp(macro, ".TP"))
-      {
-        // .TP [indent]
-        char	indent[256];		// Indentation
+#ifdef HAVE_BROTLI
+    if (output->brfd >= 0)
+      unlink(output->brname);
+#endif // HAVE_BROTLI
+  }
 
-        if (!parse_measurement(indent, &lineptr, sizeof(indent), 'n'))
-          safe_strcpy(indent, "2.5em", sizeof(indent));
+  return (ret);
+}
 
-	if (state->in_link)
-	{
-	  puts("</a>");
-	  state->in_link = false;
-	}
 
-        if (state->in_block)
-          printf("</%s>\n", state->in_block);
+//
+// 'output_compress()' - Compress output data for the compressed copies.
+//
+// The compressed data is written as it is produced, so the output is never
+// read back.  Set "finish" to `true` to write the end of each compressed
+// stream.
+//
 
-        printf("    <p style=\"margin-left: %s; text-indent: -%s;\">", indent, indent);
-        state->in_block = "p";
-        break_text      = "<br>";
-      }
-      else if (!strcmp(macro, ".UR"))
-      {
-        // .UR url
-        char	url[1024];		// URL value
+static bool				// O - `true` on success, `false` on error
+output_compress(man_output_t *output,	// I - Output file
+                const char   *data,	// I - Data to compress or `NULL`
+                size_t       len,	// I - Length of data
+                bool         finish)	// I - Finish the compressed streams?
+{
+  if (output->gzfd >= 0)
+  {
+    // Compress with zlib, writing each full buffer...
+    output->gzstream.next_in  = (Bytef *)data;
+    output->gzstream.avail_in = (uInt)len;
 
-        if (parse_value(url, &lineptr, sizeof(url)) && url[0])
-        {
-          html_printf("<a href=\"%s\">", url);
-          state->in_link = true;
-        }
-      }
-      else if (!strcmp(macro, ".YS"))
+    do
+    {
+      output->gzstream.next_out  = output->buffer;
+      output->gzstream.avail_out = (uInt)sizeof(output->buffer);
+
+      if (deflate(&output->gzstream, finish ? Z_FINISH : Z_NO_FLUSH) == Z_STREAM_ERROR)
       {
-        // .YS (end of synopsis)
-        if (!state->in_block || strcmp(state->in_block, "p"))
-        {
-          fprintf(stderr, "mantohtml: '.YS' seen without prior '.SY' on line %d of '%s'.\n", linenum, filename);
-        }
-        else
-        {
-          puts("</p>");
-          state->in_block = NULL;
-        }
+        fprintf(stderr, "mantohtml: Unable to compress '%s'.\n", output->gzname);
+        return (false);
       }
-      else if (!strcmp(macro, ".br"))
+
+      if (!write_fd(output->gzfd, output->buffer, sizeof(output->buffer) - output->gzstream.avail_out))
       {
-        // .br
-        puts("<br>");
+        perror(output->gzname);
+        return (false);
       }
-      else if (!strcmp(macro, ".in"))
-      {
-        // .in indent
-        char	indent[256];		// Indentation value
+    }
+    while (output->gzstream.avail_out == 0);
+  }
 
-        if (parse_measurement(indent, &lineptr, sizeof(indent), 'm'))
-        {
-          // Indent...
-          printf("    <div style=\"margin-left: %s;\">\n", indent);
-          state->indent ++;
-        }
-        else if (state->indent > 0)
-        {
-          // Unindent...
-          puts("    </div>");
-          state->indent --;
-        }
-        else
-        {
-          fprintf(stderr, "mantohtml: '.in' seen without prior '.in INDENT' on line %d of '%s'.\n", linenum, filename);
-        }
-      }
-      else if (!strcmp(macro, ".sp"))
+#ifdef HAVE_BROTLI
+  if (output->brstate)
+  {
+    // Compress with Brotli, writing each full buffer...
+    const uint8_t *next_in = (const uint8_t *)data;
+					// Next input byte
+    size_t	avail_in = len,		// Available input bytes
+		avail_out;		// Available output bytes
+    uint8_t	*next_out;		// Next output byte
+
+    do
+    {
+      next_out  = output->buffer;
+      avail_out = sizeof(output->buffer);
+
+      if (!BrotliEncoderCompressStream(output->brstate, finish ? BROTLI_OPERATION_FINISH : BROTLI_OPERATION_PROCESS, &avail_in, &next_in, &avail_out, &next_out, NULL))
       {
-        // .sp [N] (vertical space)
-        puts("<br>&nbsp;<br>");
+        fprintf(stderr, "mantohtml: Unable to compress '%s'.\n", output->brname);
+        return (false);
       }
-      else
+
+      if (!write_fd(output->brfd, output->buffer, sizeof(output->buffer) - avail_out))
       {
-        // Something else we don't recognize.
-        fprintf(stderr, "mantohtml: Unsupported command/macro '%s' on line %d of '%s'.\n", macro, linenum, filename);
+        perror(output->brname);
+        return (false);
       }
     }
-    else if (th_seen)
+    while (avail_in > 0 || BrotliEncoderHasMoreOutput(output->brstate) || (finish && !BrotliEncoderIsFinished(output->brstate)));
+  }
+#endif // HAVE_BROTLI
+
+  return (true);
+}
+
+
+//
+// 'output_open()' - Open an output file and its compressed copies.
+//
+// The compressed copies are the output filename plus ".gz" and ".br", and
+// any copies that are not requested are removed so they cannot go stale.
+// The returned sink writes to the output file and the compressors and must be
+// closed using @link output_close@.
+//
+
+static mantohtml_sink_t *		// O - Output sink or `NULL` on error
+output_open(man_output_t *output,	// I - Output file
+            const char   *outname,	// I - Output filename
+            int          compress)	// I - Compressed copies to write
+{
+  mantohtml_sink_t *sink;		// Output sink
+
+
+  output->outname = outname;
+  output->gzfd    = -1;
+
+  memset(&output->gzstream, 0, sizeof(output->gzstream));
+  snprintf(output->gzname, sizeof(output->gzname), "%s.gz", outname);
+  snprintf(output->brname, sizeof(output->brname), "%s.br", outname);
+
+#ifdef HAVE_BROTLI
+  output->brfd    = -1;
+  output->brstate = NULL;
+#endif // HAVE_BROTLI
+
+  if ((output->fd = open(outname, O_WRONLY | O_CREAT | O_TRUNC, 0666)) < 0)
+  {
+    perror(outname);
+    return (NULL);
+  }
+
+  if (compress & MAN_COMPRESS_GZIP)
+  {
+    // gzip uses the best compression since the copies are written once and
+    // served many times...
+    if ((output->gzfd = open(output->gzname, O_WRONLY | O_CREAT | O_TRUNC, 0666)) < 0)
     {
-      // Text that needs to be written...
-      if (!state->in_block)
-      {
-        fputs("<p>", stdout);
-        state->in_block = "p";
-      }
+      perror(output->gzname);
+      output_close(output, NULL, false);
+      return (NULL);
+    }
 
-      man_puts(state, line);
+    if (deflateInit2(&output->gzstream, Z_BEST_COMPRESSION, Z_DEFLATED, 31, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+      fprintf(stderr, "mantohtml: Unable to compress '%s'.\n", output->gzname);
+      output_close(output, NULL, false);
+      return (NULL);
+    }
+  }
+  else
+  {
+    unlink(output->gzname);
+  }
 
-      puts(break_text);
-      break_text = "";
+#ifdef HAVE_BROTLI
+  if (compress & MAN_COMPRESS_BROTLI)
+  {
+    if ((output->brfd = open(output->brname, O_WRONLY | O_CREAT | O_TRUNC, 0666)) < 0)
+    {
+      perror(output->brname);
+      output_close(output, NULL, false);
+      return (NULL);
     }
-    else if (line[0] && !warning)
+
+    if ((output->brstate = BrotliEncoderCreateInstance(NULL, NULL, NULL)) == NULL)
     {
-      fprintf(stderr, "mantohtml: Ignoring text before '.TH' on line %d of '%s'.\n", linenum, filename);
-      warning = true;
+      fprintf(stderr, "mantohtml: Unable to compress '%s'.\n", output->brname);
+      output_close(output, NULL, false);
+      return (NULL);
     }
+
+    BrotliEncoderSetParameter(output->brstate, BROTLI_PARAM_MODE, BROTLI_MODE_TEXT);
+    BrotliEncoderSetParameter(output->brstate, BROTLI_PARAM_QUALITY, BROTLI_MAX_QUALITY);
+  }
+  else
+#endif // HAVE_BROTLI
+  {
+    unlink(output->brname);
   }
 
-  fclose(fp);
+  if ((sink = mantohtml_sink_new_cb((mantohtml_sink_cb_t)output_write, output)) == NULL)
+  {
+    perror(outname);
+    output_close(output, NULL, false);
+    return (NULL);
+  }
+
+  return (sink);
 }
 
 
 //
-// 'html_anchor()' - Convert a string to a HTML anchor.
+// 'output_write()' - Write data to an output file and its compressed copies.
 //
 
-static char *				// O - Anchor
-html_anchor(char       *anchor,		// I - Anchor buffer
-            const char *s,		// I - String
-            size_t     anchorsize)	// I - Size of anchor buffer
+static bool				// O - `true` on success, `false` on error
+output_write(man_output_t *output,	// I - Output file
+             const char   *data,	// I - Data to write
+             size_t       len)		// I - Length of data
 {
-  char	*ptr,				// Pointer into anchor buffer
-	*end;				// Pointer to end of anchor buffer
-
-  for (ptr = anchor, end = anchor + anchorsize - 1; *s && ptr < end; s ++)
+  if (!write_fd(output->fd, data, len))
   {
-    if (isalnum(*s & 255) || *s == '.' || *s == '-')
-      *ptr++ = tolower(*s);
-    else if (strchr("( \t", *s) != NULL && s[1] && ptr > anchor && ptr[-1] != '-')
-      *ptr++ = '-';
+    perror(output->outname);
+    return (false);
   }
 
-  *ptr = '\0';
-
-  return (anchor);
+  return (output_compress(output, data, len, false));
 }
 
 
 //
-// 'html_font()' - Change the current font.
+// 'run_jobs()' - Convert man pages to separate files using a pool of workers.
+//
+// Each worker starts with an equal share of the jobs in its own queue and
+// takes jobs from the head of that queue.  When a worker's queue is empty it
+// steals the second half of the largest remaining queue, so a few large man
+// pages do not hold up the rest of the batch.
 //
 
-static void
-html_font(man_state_t *state,		// I - Current man state
-          man_font_t  font)		// I - New font
+static bool				// O - `true` on success, `false` on error
+run_jobs(man_job_t  *jobs,		// I - Jobs
+         size_t     num_jobs,		// I - Number of jobs
+         const char *outdir,		// I - Output directory
+         const char *cachedir,		// I - Cache directory or `NULL`
+         int        compress,		// I - Compressed copies to write
+         int        num_workers)	// I - Number of worker threads
 {
-  static const char * const fonts[] =	// Font tags/elements
+  bool		ret = true;		// Return value
+  size_t	i;			// Looping var
+#if !_WIN32
+  man_pool_t	pool;			// Worker pool
+  man_worker_t	*workers;		// Workers
+  pthread_t	*threads;		// Worker threads
+  size_t	num_threads;		// Number of threads started
+#endif // !_WIN32
+
+
+#if !_WIN32
+  if (num_workers > 1 && num_jobs > 1)
   {
-    NULL,
-    "strong",
-    "em",
-    "small",
-    "small",
-    "pre"
-  };
+    // Convert using worker threads...
+    if ((size_t)num_workers > num_jobs)
+      num_workers = (int)num_jobs;
+
+    pool.outdir     = outdir;
+    pool.cachedir   = cachedir;
+    pool.compress   = compress;
+    pool.jobs       = jobs;
+    pool.num_queues = (size_t)num_workers;
+    pool.queues     = calloc(pool.num_queues, sizeof(man_queue_t));
+    workers         = calloc(pool.num_queues, sizeof(man_worker_t));
+    threads         = calloc(pool.num_queues, sizeof(pthread_t));
+
+    if (!pool.queues || !workers || !threads)
+    {
+      perror("mantohtml");
+      free(pool.queues);
+      free(workers);
+      free(threads);
+      return (false);
+    }
 
+    for (i = 0; i < pool.num_queues; i ++)
+    {
+      pthread_mutex_init(&pool.queues[i].mutex, NULL);
+      pool.queues[i].head = i * num_jobs / pool.num_queues;
+      pool.queues[i].tail = (i + 1) * num_jobs / pool.num_queues;
 
-  // No-op if the fonts are the same...
-  if (state->font == font && state->in_block)
-    return;
+      workers[i].pool   = &pool;
+      workers[i].queue  = i;
+      workers[i].status = true;
+    }
 
-  // Close prior font as needed, open new font as needed.
-  if (state->font)
-    printf("</%s>", fonts[state->font]);
+    // Start the worker threads, running the first queue on this thread...
+    for (num_threads = 1; num_threads < pool.num_queues; num_threads ++)
+    {
+      if (pthread_create(threads + num_threads, NULL, (void *(*)(void *))run_worker, workers + num_threads))
+        break;
+    }
 
-  if (!state->in_block)
-  {
-    fputs("<p>", stdout);
-    state->in_block = "p";
-  }
+    run_worker(workers);
 
-  if (font == MAN_FONT_SMALL_BOLD)
-    fputs("<small style=\"font-weight: bold;\">", stdout);
-  else if (font)
-    printf("<%s>", fonts[font]);
+    for (i = 1; i < num_threads; i ++)
+      pthread_join(threads[i], NULL);
 
-  // Save the new font...
-  state->font = font;
-}
+    // Any queues without a thread were emptied by the other workers...
+    for (i = 0; i < pool.num_queues; i ++)
+    {
+      if (!workers[i].status)
+        ret = false;
 
+      pthread_mutex_destroy(&pool.queues[i].mutex);
+    }
 
-//
-// 'html_footer()' - Write the HTML footer.
-//
+    free(pool.queues);
+    free(workers);
+    free(threads);
 
-static void
-html_footer(man_state_t *state)		// I - Current man state
-{
-  if (state->wrote_header)
-  {
-    puts("  </body>");
-    puts("</html>");
+    return (ret);
+  }
+#else
+  (void)num_workers;
+#endif // !_WIN32
 
-    state->wrote_header = false;
+  // Convert each file in turn...
+  for (i = 0; i < num_jobs; i ++)
+  {
+    if (!convert_file(jobs + i, outdir, cachedir, compress))
+      ret = false;
   }
+
+  return (ret);
 }
 
 
+#if !_WIN32
+
+
 //
-// 'html_header()' - Write the HTML header.
+// 'run_queue()' - Get the next job from a worker's queue, stealing as needed.
 //
 
-static void
-html_header(man_state_t *state,		// I - Current man state
-            const char  *title)		// I - Title
+static bool				// O - `true` if there is a job, `false` if all queues are empty
+run_queue(man_pool_t  *pool,		// I - Worker pool
+          man_queue_t *queue,		// I - Worker's queue
+          size_t      *job)		// O - Job number
 {
-  if (state->wrote_header)
-    return;
+  size_t	i,			// Looping var
+		count,			// Jobs in current queue
+		best_count;		// Jobs in best victim queue
+  man_queue_t	*victim;		// Queue to steal from
 
-  state->wrote_header = true;
 
-  puts("<!DOCTYPE html>");
-  puts("<html>");
-  puts("  <head>");
-  if (state->css)
+  for (;;)
   {
-    if (!strncmp(state->css, "http://", 7) || !strncmp(state->css, "https://", 8))
+    // Take the next job from our own queue...
+    pthread_mutex_lock(&queue->mutex);
+    if (queue->head < queue->tail)
     {
-      // Reference the stylesheet...
-      html_printf("    <link rel=\"stylesheet\" type=\"text/css\" href=\"%s\">\n", state->css);
+      *job = queue->head ++;
+      pthread_mutex_unlock(&queue->mutex);
+      return (true);
     }
-    else
+    pthread_mutex_unlock(&queue->mutex);
+
+    // Find the queue with the most remaining jobs...
+    for (i = 0, victim = NULL, best_count = 0; i < pool->num_queues; i ++)
     {
-      // Embed the stylesheet...
-      FILE	*fp;			// CSS file
-      char	line[1024];		// Line from file
+      if (pool->queues + i == queue)
+        continue;
 
-      puts("    <style><!--");
+      pthread_mutex_lock(&pool->queues[i].mutex);
+      count = pool->queues[i].tail - pool->queues[i].head;
+      pthread_mutex_unlock(&pool->queues[i].mutex);
 
-      if ((fp = fopen(state->css, "r")) == NULL)
+      if (count > best_count)
       {
-        perror(state->css);
-        exit(1);
+        victim     = pool->queues + i;
+        best_count = count;
       }
+    }
 
-      while (fgets(line, sizeof(line), fp))
-        fputs(line, stdout);
+    // No new jobs are ever added, so we are done if all queues are empty...
+    if (!victim)
+      return (false);
+
+    // Steal the second half of the victim's queue, or its last job...
+    pthread_mutex_lock(&victim->mutex);
+    if (victim->head < victim->tail)
+    {
+      size_t	tail = victim->tail,	// Original tail
+		mid = victim->head + (tail - victim->head) / 2;
+					// Start of stolen jobs
 
-      fclose(fp);
+      victim->tail = mid;
+      pthread_mutex_unlock(&victim->mutex);
 
-      puts("--></style>");
+      pthread_mutex_lock(&queue->mutex);
+      queue->head = mid;
+      queue->tail = tail;
+      pthread_mutex_unlock(&queue->mutex);
+    }
+    else
+    {
+      // Someone else got there first, try again...
+      pthread_mutex_unlock(&victim->mutex);
     }
   }
+}
+
+
+//
+// 'run_worker()' - Convert man pages until there are no more jobs.
+//
+// Each worker uses its own man state, line buffer, and output file.
+//
+
+static void *				// O - Thread exit value (unused)
+run_worker(man_worker_t *worker)	// I - Worker
+{
+  man_pool_t	*pool = worker->pool;	// Worker pool
+  man_queue_t	*queue = pool->queues + worker->queue;
+					// Worker's queue
+  size_t	job;			// Current job
 
-  if (state->author)
-    html_printf("    <meta name=\"author\" content=\"%s\">\n", state->author);
-  if (state->copyright)
-    html_printf("    <meta name=\"copyright\" content=\"%s\">\n", state->copyright);
-  puts("    <meta name=\"creator\" content=\"mantohtml v" VERSION "\">");
-  if (state->subject)
-    html_printf("    <meta name=\"subject\" content=\"%s\">\n", state->subject);
-  html_printf("    <title>%s</title>\n", state->title ? state->title : title ? title : "Documentation");
-  puts("  </head>");
-  puts("  <body>");
-  if (state->chapter)
-  {
-    char	anchor[256];		// Anchor for chapter
 
-    html_printf("    <h1 id=\"%s\">%s</h1>\n", html_anchor(anchor, state->chapter, sizeof(anchor)), state->chapter);
+  while (run_queue(pool, queue, &job))
+  {
+    if (!convert_file(pool->jobs + job, pool->outdir, pool->cachedir, pool->compress))
+      worker->status = false;
   }
+
+  return (NULL);
 }
+#endif // !_WIN32
 
 
 //
-// 'html_heading()' - Write a heading.
+// 'serve()' - Convert man pages on request.
+//
+// Requests are read from the standard input or from connections to a UNIX
+// domain socket, with one thread accepting connections for each job.  Each
+// request starts with its length in bytes on a line by itself, followed by
+// "NAME VALUE" option lines, a blank line, and the man page source:
+//
+//     LENGTH
+//     author AUTHOR
+//     chapter CHAPTER
+//     compact [no]
+//     copyright COPYRIGHT
+//     css CSS-FILE-OR-URL
+//     css-link [no]
+//     file MAN-FILE
+//     name MAN-NAME
+//     subject SUBJECT
+//     suffix .EXT
+//     title TITLE
+//     toc [no]
+//
+//     MAN-SOURCE
+//
+// The "file" option converts the named man page file instead of the source
+// in the request, while "name" sets the filename used for messages and `.so`
+// includes in the source.  Options that are not supplied use the values from
+// the command-line.  Each response is either "ok LENGTH" or "error LENGTH" on
+// a line by itself, followed by LENGTH bytes of HTML or error message.
 //
 
-static void
-html_heading(man_state_t   *state,	// I - Current man state
-             man_heading_t heading,	// I - Heading level
-             const char    *s)		// I - Heading text
+static bool				// O - `true` on success, `false` on error
+serve(const char                *name,	// I - Socket filename or "-" for stdin/stdout
+      const mantohtml_options_t *options,// I - Default conversion options
+      int                       num_workers)
+					// I - Number of worker threads
 {
-  int	hlevel;				// HTML heading level
-  char	subsection[256],		// Sub-section anchor
-	title[256],			// Heading title string
-	*titleptr;			// Pointer into heading title
+#if _WIN32
+  (void)num_workers;
 
+  if (strcmp(name, "-"))
+  {
+    fputs("mantohtml: '--serve' only supports '-' on this platform.\n", stderr);
+    return (false);
+  }
+
+  return (serve_client(0, 1, options));
+
+#else
+  man_server_t	server;			// Socket server
+  struct sockaddr_un addr;		// Socket address
+  pthread_t	*threads;		// Worker threads
+  int		i,			// Looping var
+		num_threads;		// Number of threads started
 
-  // Convert heading level enum to HTML
-  if (state->chapter)
-    hlevel = heading + 2;
-  else
-    hlevel = heading + 1;
 
-  safe_strcpy(title, s, sizeof(title));
+  // Write errors are reported instead of terminating the server...
+  signal(SIGPIPE, SIG_IGN);
 
-  if (heading > MAN_HEADING_TOPIC)
+  if (!strcmp(name, "-"))
+    return (serve_client(0, 1, options));
+
+  // Listen for connections on a UNIX domain socket...
+  if (strlen(name) >= sizeof(addr.sun_path))
   {
-    // Rewrite the heading text to be capitalized...
-    for (titleptr = title; *titleptr; titleptr ++)
-    {
-      if (isalpha(*titleptr & 255))
-      {
-	// Start of a word, see if we need to capitalize it
-	if (titleptr == title || (strncmp(titleptr, "a ", 2) && strncmp(titleptr, "and ", 4) && strncmp(titleptr, "or ", 3) && strncmp(titleptr, "the ", 4)))
-	  *titleptr = toupper(*titleptr);
-
-	while (isalpha(titleptr[1] & 255))
-	{
-	  titleptr ++;
-	  *titleptr = tolower(*titleptr);
-	}
-      }
-    }
+    fprintf(stderr, "mantohtml: Socket filename '%s' is too long.\n", name);
+    return (false);
   }
 
-  // Close current elements...
-  if (state->in_link)
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, name, sizeof(addr.sun_path) - 1);
+
+  if ((server.fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
   {
-    puts("</a>");
-    state->in_link = false;
+    perror("mantohtml");
+    return (false);
   }
 
-  if (state->in_block)
+  unlink(name);
+
+  if (bind(server.fd, (struct sockaddr *)&addr, sizeof(addr)) || listen(server.fd, 128))
   {
-    // Close the current paragraph...
-    printf("</%s>\n", state->in_block);
-    state->in_block = NULL;
+    fprintf(stderr, "mantohtml: Unable to listen on '%s': %s\n", name, strerror(errno));
+    close(server.fd);
+    return (false);
   }
 
-  switch (heading)
-  {
-    case MAN_HEADING_TOPIC :
-        html_printf("    <h%d id=\"%s\">", hlevel, html_anchor(state->atopic, s, sizeof(state->atopic)));
-        break;
+  server.options = options;
 
-    case MAN_HEADING_SECTION :
-        html_printf("    <h%d id=\"%s.%s\">", hlevel, state->atopic, html_anchor(state->asection, s, sizeof(state->asection)));
-        break;
+  // Start the worker threads, accepting connections on this thread as well...
+  if (num_workers < 1)
+    num_workers = 1;
 
-    case MAN_HEADING_SUBSECTION :
-        html_printf("    <h%d id=\"%s.%s.%s\">", hlevel, state->atopic, state->asection, html_anchor(subsection, s, sizeof(subsection)));
-        break;
+  if ((threads = calloc((size_t)num_workers, sizeof(pthread_t))) == NULL)
+  {
+    perror("mantohtml");
+    close(server.fd);
+    unlink(name);
+    return (false);
+  }
+
+  for (num_threads = 1; num_threads < num_workers; num_threads ++)
+  {
+    if (pthread_create(threads + num_threads, NULL, (void *(*)(void *))serve_worker, &server))
+      break;
   }
 
-  man_puts(state, title);
-  html_printf("</h%d>\n", hlevel);
+  serve_worker(&server);
+
+  for (i = 1; i < num_threads; i ++)
+    pthread_join(threads[i], NULL);
+
+  free(threads);
+  close(server.fd);
+  unlink(name);
+
+  return (false);
+#endif // _WIN32
 }
 
 
 //
-// 'html_printf()' - Output a formatted string, quoting HTML entities as needed.
+// 'serve_client()' - Convert requests from a client.
 //
-// Note: Currently only supports "%d", "%s", and "%%" format sequences.
+// The HTML document, output buffer, and request buffer are reused for every
+// request so that a warm server does not allocate memory for typical man
+// pages.
 //
 
-static void
-html_printf(const char *format,		// I - Format string
-            ...)			// I - Additional arguments as needed
+static bool				// O - `true` on success, `false` on error
+serve_client(
+    int                       infd,	// I - Input file descriptor
+    int                       outfd,	// I - Output file descriptor
+    const mantohtml_options_t *options)	// I - Default conversion options
 {
-  const char	*start = format;	// Start of current fragment
-  va_list	ap;			// Pointer into arguments
-  int		ivalue;			// Integer value
-  const char	*svalue;		// String value
-
+  bool		ret = true;		// Return value
+  man_client_t	*client;		// Client connection
+  mantohtml_sink_t *html,		// HTML output
+		*response;		// Response output
+  mantohtml_t	*doc;			// HTML document
+  mantohtml_options_t reqoptions;	// Options for request
+  char		ch,			// Character from request length
+		*request = NULL,	// Request buffer
+		*line,			// Current line in request
+		*next,			// Next line in request
+		*value,			// Option value
+		*src;			// Man page source in request
+  size_t	bytes,			// Bytes read
+		digits,			// Number of digits in request length
+		reqlen,			// Length of request
+		reqsize = 0;		// Size of request buffer
+  const char	*filename,		// Man file to convert
+		*name,			// Name for man page source
+		*error,			// Error message, if any
+		*data;			// HTML data
+  size_t	datalen;		// Length of HTML data
+
+
+  client   = calloc(1, sizeof(man_client_t));
+  html     = mantohtml_sink_new_memory();
+  response = mantohtml_sink_new_fd(outfd);
+  doc      = html ? mantohtml_new(options, html) : NULL;
+
+  if (!client || !html || !response || !doc)
+  {
+    perror("mantohtml");
+    ret = false;
+    goto done;
+  }
 
-  // Prep additional arguments...
-  va_start(ap, format);
+  client->fd     = infd;
+  client->bufptr = client->bufend = client->buffer;
 
-  // Loop through the format string, escaping as needed...
-  while (*format)
+  for (;;)
   {
-    if (*format == '%')
-    {
-      // Format character
-      if (format > start)
-        fwrite(start, 1, format - start, stdout);
-
-      format ++;
-      if (*format == 'd')
-      {
-        // Insert integer
-        format ++;
-	start = format;
+    // Read the request length...
+    for (digits = 0, reqlen = 0; (bytes = serve_read(client, &ch, 1)) == 1 && isdigit(ch & 255) && digits < 12; digits ++)
+      reqlen = reqlen * 10 + (size_t)(ch - '0');
 
-        ivalue = va_arg(ap, int);
+    if (bytes == 0 && digits == 0)
+      break;				// No more requests
 
-        printf("%d", ivalue);
-      }
-      else if (*format == 's')
-      {
-        // Insert string
-        format ++;
-	start = format;
+    if (bytes == 0 || ch != '\n' || digits == 0)
+    {
+      fputs("mantohtml: Bad request length.\n", stderr);
+      ret = false;
+      break;
+    }
 
-        svalue = va_arg(ap, const char *);
+    // Read the request...
+    if (reqlen >= reqsize)
+    {
+      char	*temp;			// New request buffer
 
-        if (svalue)
-          html_puts(svalue);
-      }
-      else if (*format == '%')
+      if ((temp = realloc(request, reqlen + 1)) == NULL)
       {
-        // Insert literal %
-        start = format;
-        format ++;
-      }
-      else
-      {
-        // Something else we don't understand...
-        fprintf(stderr, "mantohtml: Fatal error - unsupported format sequence '%%%c' used.\n", *format);
-        abort();
+        perror("mantohtml");
+        ret = false;
+        break;
       }
+
+      request = temp;
+      reqsize = reqlen + 1;
     }
-    else
+
+    if (serve_read(client, request, reqlen) < reqlen)
     {
-      // Literal character...
-      format ++;
+      fputs("mantohtml: Short request.\n", stderr);
+      ret = false;
+      break;
     }
-  }
 
-  // Done with additional arguments...
-  va_end(ap);
+    request[reqlen] = '\0';
 
-  // Finish off the rest...
-  if (format > start)
-    fwrite(start, 1, format - start, stdout);
-}
+    // Parse the request options...
+    reqoptions = *options;
+    filename   = NULL;
+    name       = NULL;
+    error      = NULL;
+    src        = NULL;
+
+    for (line = request; line < (request + reqlen); line = next)
+    {
+      if ((next = memchr(line, '\n', (size_t)(request + reqlen - line))) != NULL)
+        *next++ = '\0';
+      else
+        next = request + reqlen;
+
+      if (!*line)
+      {
+        // Blank line, the rest is the man page source...
+        src = next;
+        break;
+      }
 
+      if ((value = strchr(line, ' ')) != NULL)
+        *value++ = '\0';
+      else
+        value = line + strlen(line);
+
+      if (!strcmp(line, "author"))
+        reqoptions.author = value;
+      else if (!strcmp(line, "chapter"))
+        reqoptions.chapter = value;
+      else if (!strcmp(line, "compact"))
+        reqoptions.compact = strcmp(value, "no") != 0;
+      else if (!strcmp(line, "copyright"))
+        reqoptions.copyright = value;
+      else if (!strcmp(line, "css"))
+        reqoptions.css = value;
+      else if (!strcmp(line, "css-link"))
+        reqoptions.css_link = strcmp(value, "no") != 0;
+      else if (!strcmp(line, "file"))
+        filename = value;
+      else if (!strcmp(line, "name"))
+        name = value;
+      else if (!strcmp(line, "subject"))
+        reqoptions.subject = value;
+      else if (!strcmp(line, "suffix"))
+        reqoptions.suffix = value;
+      else if (!strcmp(line, "title"))
+        reqoptions.title = value;
+      else if (!strcmp(line, "toc"))
+        reqoptions.toc = strcmp(value, "no") != 0;
+      else
+        error = "Unknown request option.";
 
-//
-// 'html_putc()' - Put a single character, using entities as needed.
-//
+      if (error)
+        break;
+    }
 
-static void
-html_putc(int ch)			// I - Character
-{
-  if (ch == '&')
-    fputs("&amp;", stdout);
-  else if (ch == '<')
-    fputs("&lt;", stdout);
-  else if (ch == '\"')
-    fputs("&quot;", stdout);
-  else
-    putchar(ch);
-}
+    if (!error && !filename && !src)
+      error = "Missing man page source or file.";
 
+    // Convert the man page...
+    if (!error)
+    {
+      bool	converted;		// Converted man page?
 
-//
-// 'html_puts()' - Output a literal string, quoting HTML entities as needed.
-//
+      mantohtml_sink_reset(html);
+      mantohtml_set_options(doc, &reqoptions);
 
-static void
-html_puts(const char *s)		// I - String
-{
-  const char	*start = s;		// Start of current fragment
+      if (filename)
+        converted = mantohtml_add_file(doc, filename);
+      else
+        converted = mantohtml_add_buffer(doc, name, src, (size_t)(request + reqlen - src));
 
+      // Always finish the document so it can be reused...
+      if (!mantohtml_finish(doc) || !converted)
+        error = "Unable to convert man page.";
+    }
 
-  // Loop through the string, escaping as needed...
-  while (*s)
-  {
-    if (strchr("&<\"", *s))
+    // Send the response...
+    if (error)
     {
-      // Character that needs quoting...
-      if (s > start)
-        fwrite(start, 1, s - start, stdout);
-
-      html_putc(*s ++);
-      start = s;
+      mantohtml_sink_printf(response, "error %lu\n%s", (unsigned long)strlen(error), error);
     }
     else
     {
-      // Literal character...
-      s ++;
+      data = mantohtml_sink_get_buffer(html, &datalen);
+
+      mantohtml_sink_printf(response, "ok %lu\n", (unsigned long)datalen);
+      mantohtml_sink_write(response, data, datalen);
+    }
+
+    if (!mantohtml_sink_flush(response))
+    {
+      // Client went away...
+      ret = false;
+      break;
     }
   }
 
-  // Finish off the rest...
-  if (s > start)
-    fwrite(start, 1, s - start, stdout);
+  done:
+
+  free(request);
+  free(client);
+  mantohtml_delete(doc);
+  mantohtml_sink_delete(html);
+  mantohtml_sink_delete(response);
+
+  return (ret);
 }
 
 
 //
-// 'man_gets()' - Get a line from a man page file.
+// 'serve_read()' - Read bytes from a client.
 //
 
-static char *				// O  - Line or `NULL` on EOF
-man_gets(FILE   *fp,			// I  - File to read from
-         char   *buffer,		// I  - Line buffer
-         size_t bufsize,		// I  - Size of line buffer
-         int    *linenum)		// IO - Line number
+static size_t				// O - Number of bytes read, less than `len` on end-of-file or error
+serve_read(man_client_t *client,	// I - Client connection
+           char         *data,		// I - Buffer
+           size_t       len)		// I - Number of bytes to read
 {
-  int	ch;				// Current character
-  char	*bufptr,			// Pointer into line
-	*bufend;			// End of line buffer
-
+  size_t	total = 0,		// Total bytes read
+		count;			// Bytes to copy
+  ssize_t	bytes;			// Bytes from file
 
-  // Loop until we get the end of the line...
-  bufptr = buffer;
-  bufend = buffer + bufsize - 1;
 
-  while ((ch = getc(fp)) != EOF)
+  while (total < len)
   {
-    if (ch == '\n')
+    if (client->bufptr >= client->bufend)
     {
-      // End of line
-      *linenum += 1;
-      break;
-    }
-    else if (ch == '\\')
-    {
-      // Check for \" (comment) or \LF (continuation)
-      if ((ch = getc(fp)) == EOF)
+      // Read more data, directly into the destination for large requests...
+      if ((len - total) >= sizeof(client->buffer))
+        bytes = read(client->fd, data + total, len - total);
+      else
+        bytes = read(client->fd, client->buffer, sizeof(client->buffer));
+
+      if (bytes < 0 && (errno == EINTR || errno == EAGAIN))
+        continue;
+      else if (bytes <= 0)
         break;
 
-      if (ch == '\n')
+      if ((len - total) >= sizeof(client->buffer))
       {
-        // Continuation
-	*linenum += 1;
+        total += (size_t)bytes;
         continue;
       }
-      else if (ch == '\"')
-      {
-      	// Comment
-      	while ((ch = getc(fp)) != EOF)
-      	{
-      	  if (ch == '\n')
-      	  {
-	    *linenum += 1;
-      	    break;
-      	  }
-      	}
-      	break;
-      }
-      else
-      {
-        // Something else we'll interpret at a higher level...
-        if (bufptr < bufend)
-          *bufptr++ = '\\';
-        if (bufptr < bufend)
-          *bufptr++ = (char)ch;
-      }
-    }
-    else if (bufptr < bufend)
-    {
-      // Save current character...
-      *bufptr++ = (char)ch;
+
+      client->bufptr = client->buffer;
+      client->bufend = client->buffer + bytes;
     }
-  }
 
-  *bufptr = '\0';
+    if ((count = (size_t)(client->bufend - client->bufptr)) > (len - total))
+      count = len - total;
 
-  // Return the line or NULL on EOF...
-  if (ch == EOF)
-    return (NULL);
-  else
-    return (buffer);
-}
+    memcpy(data + total, client->bufptr, count);
+    client->bufptr += count;
+    total          += count;
+  }
 
+  return (total);
+}
 
 
+#if !_WIN32
 //
-// 'man_puts()' - Output a man string, quoting with HTML entities as needed.
+// 'serve_worker()' - Accept and serve client connections.
 //
 
-static void
-man_puts(man_state_t *state,		// I - Current man state
-         const char  *s)		// I - String
+static void *				// O - Thread exit value (unused)
+serve_worker(man_server_t *server)	// I - Socket server
 {
-  const char	*start = s;		// Start of current string fragment
+  int	fd;				// Client connection
 
 
-  // Scan the string for special characters and write things out...
-  while (*s)
+  for (;;)
   {
-    if (*s == '\\' && s[1])
+    if ((fd = accept(server->fd, NULL, NULL)) < 0)
     {
-      // Escaped sequence
-      if (s > start)
-      {
-        // Write current fragment...
-        fwrite(start, 1, s - start, stdout);
-        start = s;
-      }
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
 
-      s ++;
+      perror("mantohtml");
+      break;
+    }
 
-      if (*s == 'f' && s[1])
-      {
-        s ++;
+    serve_client(fd, fd, server->options);
+    close(fd);
+  }
 
-        switch (*s)
-        {
-          case 'R' :
-          case 'P' :
-              html_font(state, MAN_FONT_REGULAR);
-              break;
-
-          case 'b' :
-          case 'B' :
-              html_font(state, MAN_FONT_BOLD);
-              break;
-
-          case 'i' :
-          case 'I' :
-              html_font(state, MAN_FONT_ITALIC);
-              break;
-
-          default :
-              fprintf(stderr, "mantohtml: Unknown font '\\f%c' ignored.\n", *s);
-              break;
-        }
+  return (NULL);
+}
 
-	s ++;
-        start = s;
-      }
-      else if (*s == '*' && s[1])
-      {
-        // Substitute macro...
-        s ++;
 
-        switch (*s++)
-        {
-          case 'R' :
-              fputs("&reg;", stdout);
-              break;
-
-          case '(' :
-	      if (!strncmp(s, "aq", 2))
-	      {
-		putchar('\'');
-		s += 2;
-	      }
-	      else if (!strncmp(s, "dq", 2))
-	      {
-		fputs("&quot;", stdout);
-		s += 2;
-	      }
-	      else if (!strncmp(s, "lq", 2))
-	      {
-		fputs("&ldquo;", stdout);
-		s += 2;
-	      }
-	      else if (!strncmp(s, "rq", 2))
-	      {
-		fputs("&rdquo;", stdout);
-		s += 2;
-	      }
-              else if (!strncmp(s, "Tm", 2))
-              {
-                fputs("<sup>TM</sup>", stdout);
-		s += 2;
-	      }
-              else
-              {
-                fprintf(stderr, "mantohtml: Unknown macro '\\*(%c%c' ignored.\n", s[0], s[1]);
-                if (*s && s[1])
-                  s += 2;
-              }
-              break;
-
-          default :
-              fprintf(stderr, "mantohtml: Unknown macro '\\*%c' ignored.\n", *s);
-              if (*s)
-	        s ++;
-              break;
-        }
+//
+// 'sort_jobs()' - Sort jobs so that the largest man pages are converted first.
+//
+// The jobs are sorted by size and then dealt out in turn to the ranges of jobs
+// that run_jobs() gives each worker, so every worker starts with its largest
+// man page and the smallest are left for the end (and for stealing).
+//
 
-	start = s;
-      }
-      else if (*s == '(')
-      {
-	if (!strncmp(s, "(bu", 3))
-	{
-	  // Bullet
-	  fputs("&middot;", stdout);
-	  s += 3;
-	  start = s;
-	}
-        else if (!strncmp(s, "(em", 3))
-        {
-          fputs("&mdash;", stdout);
-          s += 3;
-          start = s;
-        }
-        else if (!strncmp(s, "(en", 3))
-        {
-          fputs("&ndash;", stdout);
-          s += 3;
-          start = s;
-        }
-        else if (!strncmp(s, "(ga", 3))
-        {
-          putchar('`');
-          s += 3;
-          start = s;
-        }
-        else if (!strncmp(s, "(ha", 3))
-        {
-          putchar('^');
-          s += 3;
-          start = s;
-        }
-        else if (!strncmp(s, "(ti", 3))
-        {
-          putchar('~');
-          s += 3;
-          start = s;
-        }
-      }
-      else if (*s == '[')
-      {
-        // Substitute escaped character...
-        s ++;
-
-	if (!strncmp(s, "aq]", 3))
-	{
-	  putchar('\'');
-	  s += 3;
-	  start = s;
-	}
-	else if (!strncmp(s, "co]", 3))
-	{
-	  fputs("&copy;", stdout);
-	  s += 3;
-	  start = s;
-	}
-	else if (!strncmp(s, "cq]", 3))
-	{
-	  fputs("&rsquo;", stdout);
-	  s += 3;
-	  start = s;
-	}
-	else if (!strncmp(s, "de]", 3))
-	{
-	  fputs("&deg;", stdout);
-	  s += 3;
-	  start = s;
-	}
-	else if (!strncmp(s, "dq]", 3))
-	{
-	  fputs("&quot;", stdout);
-	  s += 3;
-	  start = s;
-	}
-	else if (!strncmp(s, "lq]", 3))
-	{
-	  fputs("&ldquo;", stdout);
-	  s += 3;
-	  start = s;
-	}
-	else if (!strncmp(s, "mc]", 3))
-	{
-	  fputs("&mu;", stdout);
-	  s += 3;
-	  start = s;
-	}
-	else if (!strncmp(s, "oq]", 3))
-	{
-	  fputs("&lsquo;", stdout);
-	  s += 3;
-	  start = s;
-	}
-        else if (!strncmp(s, "rg]", 3))
-	{
-	  fputs("&reg;", stdout);
-	  s += 3;
-	  start = s;
-	}
-	else if (!strncmp(s, "rq]", 3))
-	{
-	  fputs("&rdquo;", stdout);
-	  s += 3;
-	  start = s;
-	}
-	else if (!strncmp(s, "tm]", 3))
-	{
-	  fputs("<sup>TM</sup>", stdout);
-	  s += 3;
-	  start = s;
-	}
-      }
-      else if (isdigit(s[0] & 255) && isdigit(s[1] & 255) && isdigit(s[2] & 255))
-      {
-	printf("&#%d;", ((s[0] - '0') * 8 + s[1] - '0') * 8 + s[2] - '0');
-	s += 3;
-	start = s;
-      }
-      else
-      {
-        if (*s != '\\' && *s != '\"' && *s != '\'' && *s != '-' && *s != 'e' && *s != ' ')
-        {
-          fprintf(stderr, "mantohtml: Unrecognized escape '\\%c' ignored.\n", *s);
-          putchar('\\');
-        }
+static void
+sort_jobs(man_job_t *jobs,		// I - Jobs
+          size_t    num_jobs,		// I - Number of jobs
+          int       num_workers)	// I - Number of worker threads
+{
+  size_t	i,			// Looping var
+		worker,			// Current worker
+		num_queues,		// Number of job ranges
+		*counts;		// Jobs dealt to each range
+  man_job_t	*dealt;			// Dealt jobs
 
-        if (*s == 'e')
-        {
-          // Escape sequence for backslash...
-          s ++;
-          putchar('\\');
-        }
-        else
-        {
-          // Something else that is written as-is...
-          html_putc(*s++);
-        }
 
-        start = s;
-      }
-    }
-    else if (!strncmp(s, "http://", 7) || !strncmp(s, "https://", 8))
-    {
-      // Embed URL...
-      char	url[1024],		// URL string
-		*urlptr;		// Pointer into URL string
+  qsort(jobs, num_jobs, sizeof(man_job_t), (int (*)(const void *, const void *))compare_jobs);
 
-      if (s > start)
-      {
-        // Write current fragment...
-        fwrite(start, 1, s - start, stdout);
-      }
+  if (num_workers <= 1 || num_jobs <= 1)
+    return;
 
-      for (urlptr = url; *s && !isspace(*s & 255) && urlptr < (url + sizeof(url) - 1); s ++)
-      {
-        if (strchr(",.)", *s) && strchr(",. \n\r\t", s[1]))
-        {
-          // End of URL
-          break;
-        }
-        else if (*s == '\\' && s[1])
-        {
-          // Escaped character
-          s ++;
-          *urlptr++ = *s;
-        }
-        else
-        {
-          // Regular character...
-          *urlptr++ = *s;
-        }
-      }
+  // This must match the job ranges in run_jobs()...
+  num_queues = (size_t)num_workers > num_jobs ? num_jobs : (size_t)num_workers;
+  counts     = calloc(num_queues, sizeof(size_t));
+  dealt      = calloc(num_jobs, sizeof(man_job_t));
 
-      *urlptr = '\0';
-      html_printf("<a href=\"%s\">%s</a>", url, url);
-      start = s;
-    }
-    else if (strchr("<\"&", *s))
+  if (counts && dealt)
+  {
+    for (i = 0, worker = 0; i < num_jobs; i ++, worker = (worker + 1) % num_queues)
     {
-      // Quoted HTML character...
-      if (s > start)
-      {
-	// Write current fragment...
-	fwrite(start, 1, s - start, stdout);
-      }
+      // Skip ranges that are already full...
+      while (worker * num_jobs / num_queues + counts[worker] >= (worker + 1) * num_jobs / num_queues)
+        worker = (worker + 1) % num_queues;
 
-      html_putc(*s++);
-      start = s;
-    }
-    else
-    {
-      // Literal character...
-      s ++;
+      dealt[worker * num_jobs / num_queues + counts[worker]] = jobs[i];
+      counts[worker] ++;
     }
-  }
 
-  if (s > start)
-  {
-    // Write current fragment...
-    fwrite(start, 1, s - start, stdout);
+    memcpy(jobs, dealt, num_jobs * sizeof(man_job_t));
   }
+
+  // Otherwise just convert them largest first...
+  free(counts);
+  free(dealt);
 }
+#endif // !_WIN32
 
 
 //
-// 'man_xx()' - Parse font macro.
+// 'stats_write()' - Write the conversion statistics to a JSON file.
 //
 
-static void
-man_xx(man_state_t *state,		// I - Current man state
-       man_font_t  a,			// I - First font
-       man_font_t  b,			// I - Second font
-       const char  *line)		// I - Line
+static bool				// O - `true` on success, `false` on error
+stats_write(mantohtml_stats_t *stats,	// I - Conversion statistics
+            const char        *filename)// I - JSON filename
 {
-  char		word[256];		// Word from line
-  man_font_t	font = state->font;	// Current font
-  bool		use_a = true;		// Use the first font?
+  int		fd;			// Output file
+  mantohtml_sink_t *out;		// Output sink
+  bool		ret = true;		// Return value
 
 
-  // Loop until all words are written
-  while (parse_value(word, &line, sizeof(word)))
+  if ((fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666)) < 0)
   {
-    bool	have_link = false;	// Have a link?
-
-    if (a == MAN_FONT_BOLD && b == MAN_FONT_REGULAR && use_a)
-    {
-      char	section[256],		// Section (regular portion)
-		*secptr;		// Pointer into section
-      const char *saveline = line;	// Saved line pointer
-
-      if (parse_value(section, &saveline, sizeof(section)) && section[0] == '(' && isdigit(section[1] & 255) && (secptr = strchr(section, ')')) != NULL)
-      {
-        // Possibly convert ".BR name (section)" to hyperlink...
-        char	filename[1024];		// Man source file
-
-        *secptr = '\0';
-        snprintf(filename, sizeof(filename), "%s/%s.%s", state->basepath, word, section + 1);
-        if (!access(filename, 0))
-        {
-          // Have a "name.section" source file...
-          html_printf("<a href=\"%s.html\">", word);
-          have_link = true;
-        }
-      }
-    }
+    perror(filename);
+    return (false);
+  }
 
-    html_font(state, use_a ? a : b);
-    man_puts(state, word);
+  if ((out = mantohtml_sink_new_fd(fd)) == NULL)
+  {
+    perror(filename);
+    close(fd);
+    return (false);
+  }
 
-    if (have_link && parse_value(word, &line, sizeof(word)))
-    {
-      // Show man page section and close the link...
-      html_font(state, b);
-      man_puts(state, word);
-      html_printf("</a>");
-    }
-    else
-    {
-      // Alternate fonts...
-      use_a = !use_a;
-    }
+  if (!mantohtml_stats_write_json(stats, out) || close(fd))
+  {
+    perror(filename);
+    ret = false;
   }
 
-  // Restore the original font...
-  html_font(state, font);
-  putchar('\n');
+  mantohtml_sink_delete(out);
+
+  return (ret);
 }
 
 
+#if !_WIN32
+//
+// 'tree_dir()' - Add the man pages in a man directory to its jobs.
 //
-// 'parse_measurement()' - Parse a measurement value from the line.
+// Hidden files and files without a section extension are skipped.
 //
 
-static char *				// O  - String value
-parse_measurement(
-    char       *buffer,			// I  - String buffer
-    const char **line,			// IO - Pointer into line
-    size_t     bufsize,			// I  - Size of string buffer
-    char       defunit)			// I  - Default units
+static bool				// O - `true` on success, `false` on error
+tree_dir(man_tdir_t *dir)		// I - Man directory
 {
-  char	*bufptr,			// Pointer into buffer
-	*bufend,			// End of buffer
-	unit;				// Unit
+  DIR		*d;			// Directory
+  struct dirent	*ent;			// Directory entry
+  struct stat	info;			// File information
+  char		filename[1024];		// Man filename
+  man_job_t	*job;			// New job
+  bool		ret = true;		// Return value
 
 
-  // First get a value...
-  if (!parse_value(buffer, line, bufsize))
-    return (NULL);
+  if ((d = opendir(dir->path)) == NULL)
+  {
+    perror(dir->path);
+    return (false);
+  }
 
-  // Then convert the value to a CSS measurement
-  //
-  //    ##c -> ##cm (centimeters)
-  //    ##f -> ##% (1/65536 of font size - divide by 655.36)
-  //    ##i -> ##in (inches)
-  //    ##m -> ##em (em's)
-  //    ##M -> ##em (1/100th em)
-  //    ##n -> ##en (en's)
-  //    ##P -> ##pi (picas)
-  //    ##p -> ##pt (points)
-  //    ##s -> ##% (multiple of font size - multiply by 100)
-  //    ##u -> ##px (pixel)
-  //    ##v -> ## (multiple of line height)
-  if ((bufptr = buffer + strlen(buffer) - 1) < buffer)
-    return (NULL);
+  while ((ent = readdir(d)) != NULL)
+  {
+    if (ent->d_name[0] == '.' || !strchr(ent->d_name + 1, '.'))
+      continue;
 
-  bufend = buffer + bufsize - 1;
+    if (snprintf(filename, sizeof(filename), "%s/%s", dir->path, ent->d_name) >= (int)sizeof(filename))
+    {
+      fprintf(stderr, "mantohtml: Man filename for '%s' is too long.\n", ent->d_name);
+      ret = false;
+      continue;
+    }
 
-  if (isalpha(*bufptr & 255))
-    unit = *bufptr;
-  else
-    unit = defunit;
+    // Follow symbolic links, but only convert regular files...
+    if (stat(filename, &info) || !S_ISREG(info.st_mode))
+      continue;
 
-  switch (unit)
-  {
-    case 'c' : // Centimaters
-        if ((bufptr + 1) >= bufend)
-          return (NULL);
+    if (dir->num_jobs >= dir->alloc_jobs)
+    {
+      man_job_t *temp;			// New jobs array
 
-	// Convert to ##cm
-	bufptr[1] = 'm';
-	bufptr[2] = '\0';
-        break;
+      dir->alloc_jobs += 1024;
 
-    case 'f' : // 1/65536 of font size
-	// Convert to ##%
-	snprintf(buffer, bufsize, "%.1f%%", 100.0 * atof(buffer) / 65536.0);
+      if ((temp = realloc(dir->jobs, dir->alloc_jobs * sizeof(man_job_t))) == NULL)
+      {
+        perror("mantohtml");
+        ret = false;
         break;
+      }
 
-    case 'i' : // Inches
-        if ((bufptr + 1) >= bufend)
-          return (NULL);
+      dir->jobs = temp;
+    }
 
-	// Convert to ##in
-	bufptr[1] = 'n';
-	bufptr[2] = '\0';
-        break;
+    job = dir->jobs + dir->num_jobs;
 
-    case 'm' : // Ems
-        if ((bufptr + 1) >= bufend)
-          return (NULL);
+    if ((job->filename = strdup(filename)) == NULL || (job->subdir = strdup(dir->subdir)) == NULL)
+    {
+      perror("mantohtml");
+      free((char *)job->filename);
+      ret = false;
+      break;
+    }
 
-	// Convert to ##em
-	bufptr[0] = 'e';
-	bufptr[1] = 'm';
-	bufptr[2] = '\0';
-        break;
+    // Hyperlinks from the index go to the sibling directories...
+    job->size                 = (size_t)info.st_size;
+    job->formats              = dir->tree->formats;
+    job->options              = dir->tree->options;
+    job->options.index_prefix = "../";
 
-    case 'M' : // 1/100th ems
-	// Convert to ##em
-	snprintf(buffer, bufsize, "%.2fem", 0.01 * atof(buffer));
-        break;
+    dir->num_jobs ++;
+  }
 
-    case 'n' : // Ens (1/2 em)
-	// Convert to ##em
-	snprintf(buffer, bufsize, "%gem", 0.5 * atof(buffer));
-        break;
+  closedir(d);
 
-    case 'P' : // Picas
-        if ((bufptr + 1) >= bufend)
-          return (NULL);
+  return (ret);
+}
 
-	// Convert to ##pc
-	bufptr[0] = 'p';
-	bufptr[1] = 'c';
-	bufptr[2] = '\0';
-        break;
 
-    case 'p' : // Points
-        if ((bufptr + 1) >= bufend)
-          return (NULL);
+//
+// 'tree_scan()' - Add the man pages in the man directories of each tree.
+//
+// Each "manN" directory of a tree is converted to the same subdirectory of the
+// output directory.  The man directories are scanned by up to "num_workers"
+// threads.
+//
 
-	// Convert to ##pt
-	bufptr[1] = 't';
-	bufptr[2] = '\0';
-        break;
+static bool				// O - `true` on success, `false` on error
+tree_scan(man_job_t  *trees,		// I - Trees
+          size_t     num_trees,		// I - Number of trees
+          man_job_t  **jobs,		// IO - Jobs
+          size_t     *num_jobs,		// IO - Number of jobs
+          size_t     *alloc_jobs,	// IO - Allocated jobs
+          const char *outdir,		// I - Output directory
+          const char *cachedir,		// I - Cache directory or `NULL`
+          int        num_workers)	// I - Number of worker threads
+{
+  bool		ret = true;		// Return value
+  size_t	i, j,			// Looping vars
+		alloc_dirs = 0;		// Allocated man directories
+  man_tree_t	tree;			// Man directories
+  man_tdir_t	*dir;			// Current man directory
+  DIR		*d;			// Tree directory
+  struct dirent	*ent;			// Directory entry
+  struct stat	info;			// File information
+  char		path[1024],		// Man directory path
+		subpath[1024];		// Output/cache subdirectory path
+  pthread_t	*threads;		// Scanning threads
+  size_t	num_threads;		// Number of threads started
+
+
+  memset(&tree, 0, sizeof(tree));
+  pthread_mutex_init(&tree.mutex, NULL);
+
+  // Find the man directories in each tree and create the corresponding output
+  // (and cache) subdirectories...
+  for (i = 0; i < num_trees; i ++)
+  {
+    if ((d = opendir(trees[i].filename)) == NULL)
+    {
+      perror(trees[i].filename);
+      ret = false;
+      continue;
+    }
 
-    case 's' : // Multiple of font size
-	// Convert to ##%
-	snprintf(buffer, bufsize, "%.1f%%", 100.0 * atof(buffer));
-        break;
+    while ((ent = readdir(d)) != NULL)
+    {
+      if (strncmp(ent->d_name, "man", 3) || ent->d_name[3] < '1' || ent->d_name[3] > '9')
+        continue;
 
-    case 'u' : // Device unit (pixel)
-        if ((bufptr + 1) >= bufend)
-          return (NULL);
+      if (snprintf(path, sizeof(path), "%s/%s", trees[i].filename, ent->d_name) >= (int)sizeof(path) || stat(path, &info) || !S_ISDIR(info.st_mode))
+        continue;
 
-	// Convert to ##px
-	bufptr[0] = 'p';
-	bufptr[1] = 'x';
-	bufptr[2] = '\0';
-        break;
+      if (snprintf(subpath, sizeof(subpath), "%s/%s", outdir, ent->d_name) >= (int)sizeof(subpath) || (mkdir(subpath, 0777) && errno != EEXIST))
+      {
+        perror(subpath);
+        ret = false;
+        continue;
+      }
 
-    case 'v' : // Multiple of line height
-	// Convert to ##
-	*bufptr = '\0';
-        break;
+      if (cachedir && (snprintf(subpath, sizeof(subpath), "%s/%s", cachedir, ent->d_name) >= (int)sizeof(subpath) || (mkdir(subpath, 0777) && errno != EEXIST)))
+      {
+        perror(subpath);
+        ret = false;
+        continue;
+      }
 
-    default :
-        return (NULL);
-  }
+      if (tree.num_dirs >= alloc_dirs)
+      {
+        man_tdir_t *temp;		// New man directories array
 
-  return (buffer);
-}
+        alloc_dirs += 16;
 
+        if ((temp = realloc(tree.dirs, alloc_dirs * sizeof(man_tdir_t))) == NULL)
+        {
+          perror("mantohtml");
+          ret = false;
+          break;
+        }
 
-//
-// 'parse_value()' - Parse a value from the line.
-//
+        tree.dirs = temp;
+      }
 
-static char *				// O  - String value
-parse_value(char       *buffer,		// I  - String buffer
-            const char **line,		// IO - Pointer into line
-            size_t     bufsize)		// I  - Size of string buffer
-{
-  char		*bufptr,		// Pointer into buffer
-		*bufend;		// End of buffer
-  const char	*lineptr;		// Pointer into line
+      dir = tree.dirs + tree.num_dirs;
 
+      memset(dir, 0, sizeof(man_tdir_t));
 
-  // Save pointers...
-  lineptr = *line;
-  bufptr  = buffer;
-  bufend  = buffer + bufsize - 1;
+      if ((dir->path = strdup(path)) == NULL || (dir->subdir = strdup(ent->d_name)) == NULL)
+      {
+        perror("mantohtml");
+        free(dir->path);
+        ret = false;
+        break;
+      }
 
-  // Skip leading whitespace...
-  while (*lineptr && isspace(*lineptr & 255))
-    lineptr ++;
+      dir->tree = trees + i;
+      tree.num_dirs ++;
+    }
 
-  if (!*lineptr)
-  {
-    *bufptr = '\0';
-    return (NULL);
+    closedir(d);
   }
 
-  // Parse the value...
-  if (*lineptr == '\"')
+  // Scan the man directories, using this thread as the first scanning thread...
+  if ((size_t)num_workers > tree.num_dirs)
+    num_workers = (int)tree.num_dirs;
+
+  if (num_workers > 1 && (threads = calloc((size_t)num_workers, sizeof(pthread_t))) != NULL)
   {
-    // Quoted value
-    lineptr ++;
-    while (*lineptr && *lineptr != '\"')
+    for (num_threads = 1; num_threads < (size_t)num_workers; num_threads ++)
     {
-      if (bufptr < bufend)
-        *bufptr++ = *lineptr;
-
-      if (*lineptr == '\\' && lineptr[1])
-      {
-        lineptr ++;
+      if (pthread_create(threads + num_threads, NULL, (void *(*)(void *))tree_worker, &tree))
+        break;
+    }
 
-	if (bufptr < bufend)
-	  *bufptr++ = *lineptr;
-      }
+    tree_worker(&tree);
 
-      lineptr ++;
-    }
+    for (i = 1; i < num_threads; i ++)
+      pthread_join(threads[i], NULL);
 
-    if (*lineptr)
-      lineptr ++;
+    free(threads);
   }
   else
   {
-    // Unquoted value
-    while (*lineptr && !isspace(*lineptr & 255))
+    tree_worker(&tree);
+  }
+
+  pthread_mutex_destroy(&tree.mutex);
+
+  // Add the jobs in directory order...
+  for (i = 0, dir = tree.dirs; i < tree.num_dirs; i ++, dir ++)
+  {
+    if (!dir->status)
+      ret = false;
+
+    if (*num_jobs + dir->num_jobs > *alloc_jobs)
     {
-      if (bufptr < bufend)
-        *bufptr++ = *lineptr;
+      man_job_t *temp;			// New jobs array
 
-      if (*lineptr == '\\' && lineptr[1])
+      if ((temp = realloc(*jobs, (*num_jobs + dir->num_jobs) * sizeof(man_job_t))) == NULL)
       {
-        // Make sure we don't lose an escaped value...
-        lineptr ++;
-
-	if (bufptr < bufend)
-	  *bufptr++ = *lineptr;
+        perror("mantohtml");
+        ret = false;
       }
+      else
+      {
+        *jobs       = temp;
+        *alloc_jobs = *num_jobs + dir->num_jobs;
+      }
+    }
 
-      lineptr ++;
+    if (dir->num_jobs > 0 && *num_jobs + dir->num_jobs <= *alloc_jobs)
+    {
+      memcpy(*jobs + *num_jobs, dir->jobs, dir->num_jobs * sizeof(man_job_t));
+      *num_jobs += dir->num_jobs;
+    }
+    else
+    {
+      for (j = 0; j < dir->num_jobs; j ++)
+      {
+        free((char *)dir->jobs[j].filename);
+        free(dir->jobs[j].subdir);
+      }
     }
-  }
 
-  // Skip trailing whitespace...
-  while (*lineptr && isspace(*lineptr & 255))
-    lineptr ++;
+    free(dir->jobs);
+    free(dir->path);
+    free(dir->subdir);
+  }
 
-  // Store where we ended up...
-  *line   = lineptr;
-  *bufptr = '\0';
+  free(tree.dirs);
 
-  return (buffer);
+  return (ret);
 }
 
 
 //
-// 'safe_strcpy()' - Safely copy a string.
+// 'tree_worker()' - Scan man directories.
 //
 
-static void
-safe_strcpy(char       *dst,		// I - Destination string buffer
-            const char *src,		// I - Source string
-            size_t     dstsize)		// I - Destination buffer size
+static void *				// O - Thread exit value (unused)
+tree_worker(man_tree_t *tree)		// I - Man directories
 {
-  size_t	srclen;			// Length of source string
+  man_tdir_t	*dir;			// Current man directory
+
+
+  for (;;)
+  {
+    pthread_mutex_lock(&tree->mutex);
+    dir = tree->next_dir < tree->num_dirs ? tree->dirs + tree->next_dir ++ : NULL;
+    pthread_mutex_unlock(&tree->mutex);
 
+    if (!dir)
+      break;
 
-  if ((srclen = strlen(src)) >= dstsize)
-    srclen = dstsize - 1;
+    dir->status = tree_dir(dir);
+  }
 
-  memcpy(dst, src, srclen);
-  dst[srclen] = '\0';
+  return (NULL);
 }
+#endif // !_WIN32
 
 
 //
@@ -1842,18 +2930,69 @@ safe_strcpy(char       *dst,		// I - Destination string buffer
 //
 
 static int				// O - Exit status
-usage(const char *opt)			// I - Unknown option
+usage(void)
 {
   puts("Usage: mantohtml [OPTIONS] MAN-FILE [... MAN-FILE] >HTML-FILE");
+  puts("       mantohtml [OPTIONS] --output-dir DIR MAN-FILE [... MAN-FILE]");
+  puts("       mantohtml [OPTIONS] --output-dir DIR --tree MAN-DIR [... --tree MAN-DIR]");
+  puts("       mantohtml [OPTIONS] --serve -");
+  puts("       mantohtml [OPTIONS] [--jobs N] --serve SOCKET");
   puts("Options:");
   puts("   --author 'AUTHOR'        Set author metadata");
+  puts("   --cache DIR              Skip unchanged man pages with --output-dir");
   puts("   --chapter 'CHAPTER'      Set chapter (H1 heading)");
+  puts("   --compact                Write compact HTML");
+  puts("   --compress gzip,br       Write compressed copies with --output-dir");
   puts("   --copyright 'COPYRIGHT'  Set copyright metadata");
   puts("   --css CSS-FILE-OR-URL    Use named stylesheet");
+  puts("   --css-link               Link to the stylesheet file instead of embedding it");
+  puts("   --format html,json,text  Set output formats (html, fragment, json, text)");
   puts("   --help                   Show help");
+  puts("   --index NAME             Write NAME.json and NAME.html index files with --output-dir");
+  puts("   --jobs N                 Convert N files at a time with --output-dir");
+  puts("   --output-dir DIR         Write each man page to a separate file in DIR");
+  puts("   --serve -                Convert requests from stdin to stdout");
+  puts("   --serve SOCKET           Convert requests from a UNIX domain socket");
+  puts("   --stats FILENAME         Write conversion statistics to a JSON file");
   puts("   --subject 'SUBJECT'      Set subject metadata");
+  puts("   --suffix '.EXT'          Set filename suffix for --output-dir (.html)");
+  puts("   --threads N              Convert the sections of large man pages using N threads");
   puts("   --title 'TITLE'          Set output title");
+  puts("   --toc                    Include a table of contents");
+  puts("   --tree MAN-DIR           Convert the man1 to man9 directories of MAN-DIR with --output-dir");
   puts("   --version                Show version");
 
   return (1);
 }
+
+
+//
+// 'write_fd()' - Write data to a file descriptor.
+//
+
+static bool				// O - `true` on success, `false` on error
+write_fd(int        fd,			// I - File descriptor
+         const void *data,		// I - Data to write
+         size_t     len)		// I - Length of data
+{
+  const char	*ptr = (const char *)data;
+					// Pointer into data
+  ssize_t	bytes;			// Bytes written
+
+
+  while (len > 0)
+  {
+    if ((bytes = write(fd, ptr, len)) < 0)
+    {
+      if (errno == EINTR || errno == EAGAIN)
+        continue;
+
+      return (false);
+    }
+
+    ptr += bytes;
+    len -= (size_t)bytes;
+  }
+
+  return (true);
+}
@@ -0,0 +1,121 @@
+//
+// Public header file for the man page to HTML conversion library.
+//
+// Copyright © 2022-2023 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.
+// <https://opensource.org/licenses/Apache-2.0>
+//
+
+#ifndef MANTOHTML_H
+#  define MANTOHTML_H
+#  include <stdbool.h>
+#  include <stddef.h>
+#  ifdef __cplusplus
+extern "C" {
+#  endif // __cplusplus
+#  if !defined(__has_extension) && !defined(__GNUC__)
+#    define __attribute__(...)
+#  endif // !__has_extension && !__GNUC__
+
+
+//
+// Types...
+//
+
+typedef struct mantohtml_s mantohtml_t;	// HTML document
+
+typedef struct mantohtml_cache_s mantohtml_cache_t;
+					// Include cache
+
+typedef struct mantohtml_index_s mantohtml_index_t;
+					// Cross-reference index
+
+typedef struct mantohtml_stats_s mantohtml_stats_t;
+					// Conversion statistics
+
+typedef enum mantohtml_format_e		// Output formats
+{
+  MANTOHTML_FORMAT_HTML,		// HTML document
+  MANTOHTML_FORMAT_FRAGMENT,		// HTML without the header and footer
+  MANTOHTML_FORMAT_JSON,		// JSON document tree
+  MANTOHTML_FORMAT_TEXT			// Plain text
+} mantohtml_format_t;
+
+typedef void (*mantohtml_include_cb_t)(void *cbdata, const char *filename);
+					// Include callback
+
+typedef struct mantohtml_options_s	// Conversion options
+{
+  const char	*author;		// Author metadata or `NULL`
+  mantohtml_cache_t *cache;		// Include cache or `NULL`
+  const char	*chapter;		// Chapter title (H1 heading) or `NULL`
+  bool		compact;		// Write compact HTML with minimal markup?
+  const char	*copyright;		// Copyright metadata or `NULL`
+  const char	*css;			// Stylesheet filename/URL or `NULL`
+  bool		css_link;		// Reference the stylesheet file instead of embedding it?
+  mantohtml_format_t format;		// Output format
+  mantohtml_include_cb_t include_cb;	// Callback for each `.so` file used or `NULL`
+  void		*include_cbdata;	// Include callback data
+  mantohtml_index_t *index;		// Cross-reference index or `NULL`
+  const char	*index_prefix;		// Prefix for cross-reference index hyperlinks or `NULL`
+  mantohtml_stats_t *stats;		// Conversion statistics or `NULL`
+  const char	*subject;		// Subject metadata or `NULL`
+  const char	*suffix;		// Filename suffix for hyperlinks or `NULL` for ".html"
+  int		threads;		// Number of threads for converting the sections of large man pages or `0` for one
+  const char	*title;			// Document title or `NULL` for "NAME(SECTION)"
+  bool		toc;			// Include a table of contents for each man page?
+} mantohtml_options_t;
+
+typedef struct mantohtml_sink_s mantohtml_sink_t;
+					// Output sink
+
+typedef bool (*mantohtml_sink_cb_t)(void *cbdata, const char *data, size_t len);
+					// Output sink write callback
+
+
+//
+// Functions...
+//
+
+extern bool		mantohtml_add_buffer(mantohtml_t *doc, const char *name, const char *src, size_t len);
+extern bool		mantohtml_add_fd(mantohtml_t *doc, const char *name, int fd);
+extern bool		mantohtml_add_file(mantohtml_t *doc, const char *filename);
+extern bool		mantohtml_add_output(mantohtml_t *doc, mantohtml_format_t format, mantohtml_sink_t *sink);
+extern bool		mantohtml_convert_buffer(const char *src, size_t len, const mantohtml_options_t *options, mantohtml_sink_t *sink);
+extern bool		mantohtml_convert_file(const char *filename, const mantohtml_options_t *options, mantohtml_sink_t *sink);
+extern void		mantohtml_delete(mantohtml_t *doc);
+extern bool		mantohtml_finish(mantohtml_t *doc);
+extern mantohtml_t	*mantohtml_new(const mantohtml_options_t *options, mantohtml_sink_t *sink);
+extern void		mantohtml_set_options(mantohtml_t *doc, const mantohtml_options_t *options);
+
+extern void		mantohtml_cache_delete(mantohtml_cache_t *cache);
+extern mantohtml_cache_t *mantohtml_cache_new(void);
+
+extern bool		mantohtml_index_add(mantohtml_index_t *index, const char *filename, const char *href);
+extern void		mantohtml_index_delete(mantohtml_index_t *index);
+extern mantohtml_index_t *mantohtml_index_new(void);
+extern bool		mantohtml_index_write_html(mantohtml_index_t *index, const mantohtml_options_t *options, mantohtml_sink_t *sink);
+extern bool		mantohtml_index_write_json(mantohtml_index_t *index, mantohtml_sink_t *sink);
+
+extern void		mantohtml_sink_delete(mantohtml_sink_t *sink);
+extern bool		mantohtml_sink_flush(mantohtml_sink_t *sink);
+extern const char	*mantohtml_sink_get_buffer(mantohtml_sink_t *sink, size_t *len);
+extern mantohtml_sink_t	*mantohtml_sink_new_cb(mantohtml_sink_cb_t cb, void *cbdata);
+extern mantohtml_sink_t	*mantohtml_sink_new_fd(int fd);
+extern mantohtml_sink_t	*mantohtml_sink_new_memory(void);
+extern void		mantohtml_sink_printf(mantohtml_sink_t *sink, const char *format, ...) __attribute__((__format__(__printf__, 2, 3)));
+extern void		mantohtml_sink_putc(mantohtml_sink_t *sink, int ch);
+extern void		mantohtml_sink_puts(mantohtml_sink_t *sink, const char *s);
+extern void		mantohtml_sink_reset(mantohtml_sink_t *sink);
+extern void		mantohtml_sink_write(mantohtml_sink_t *sink, const char *data, size_t len);
+
+extern void		mantohtml_stats_delete(mantohtml_stats_t *stats);
+extern mantohtml_stats_t *mantohtml_stats_new(void);
+extern bool		mantohtml_stats_write_json(mantohtml_stats_t *stats, mantohtml_sink_t *sink);
+
+
+#  ifdef __cplusplus
+}
+#  endif // __cplusplus
+#endif // !MANTOHTML_H